@@ -0,0 +1,116 @@
+// Measures heap memory held per 10,000 TestResults, comparing the shared
+// fixture / output-excerpt representation with full per-result copies.
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "utils/TestRunner.h"
+
+namespace {
+    std::atomic<long long> liveBytes{0};
+
+    // Allocation header keeps the size so deletes can be accounted for
+    constexpr size_t headerSize = alignof(std::max_align_t);
+}
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size + headerSize);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    liveBytes += static_cast<long long>(size);
+    return static_cast<char*>(block) + headerSize;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - headerSize;
+    liveBytes -= static_cast<long long>(*static_cast<size_t*>(block));
+    std::free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+namespace {
+    // Layout before shared fixtures: every result owns full copies
+    struct CopiedResult {
+        std::string testName;
+        TestStatus status;
+        std::string input;
+        std::string expectedOutput;
+        std::string actualOutput;
+        std::string errorMessage;
+        double executionTime;
+    };
+
+    const size_t resultCount = 10000;
+    const size_t testsPerSuite = 20;
+
+    void report(const char* label, long long bytes) {
+        std::cout << std::left << std::setw(34) << label
+                  << std::right << std::setw(12) << bytes / 1024 << " KiB per 10k results" << std::endl;
+    }
+
+    void runScenario(const char* name, size_t fixtureBytes, double failureRate) {
+        std::cout << "\n" << name << " (fixtures " << fixtureBytes << " bytes, "
+                  << static_cast<int>(failureRate * 100) << "% failing)" << std::endl;
+
+        std::vector<TestCase> testCases;
+        for (size_t i = 0; i < testsPerSuite; ++i) {
+            testCases.emplace_back(std::string(fixtureBytes, 'i'), std::string(fixtureBytes, 'o'));
+        }
+
+        std::vector<ExecutionResult> executions(testsPerSuite);
+        for (size_t i = 0; i < testsPerSuite; ++i) {
+            executions[i].success = true;
+            executions[i].exitCode = 0;
+            bool failing = i < static_cast<size_t>(failureRate * testsPerSuite);
+            executions[i].output = std::string(fixtureBytes, failing ? 'x' : 'o');
+        }
+
+        TestRunner runner;
+        long long before = liveBytes.load();
+        {
+            std::vector<TestResult> results;
+            results.reserve(resultCount);
+            for (size_t i = 0; i < resultCount; ++i) {
+                size_t test = i % testsPerSuite;
+                results.push_back(runner.buildTestResult("Test " + std::to_string(test + 1),
+                                                         testCases[test], executions[test]));
+            }
+            report("shared fixtures + excerpts:", liveBytes.load() - before);
+        }
+
+        before = liveBytes.load();
+        {
+            std::vector<CopiedResult> results;
+            results.reserve(resultCount);
+            for (size_t i = 0; i < resultCount; ++i) {
+                size_t test = i % testsPerSuite;
+                results.push_back(CopiedResult{"Test " + std::to_string(test + 1), TestStatus::PASSED,
+                                               testCases[test].input, testCases[test].expectedOutput,
+                                               executions[test].output, "", 0.0});
+            }
+            report("full copies:", liveBytes.load() - before);
+        }
+    }
+}
+
+int main() {
+    std::cout << "TestResult memory benchmark" << std::endl;
+    std::cout << "===========================" << std::endl;
+
+    runScenario("Small I/O", 64, 0.25);
+    runScenario("Medium I/O", 16 * 1024, 0.25);
+    runScenario("Large I/O", 64 * 1024, 0.10);
+
+    return 0;
+}
@@ -1,20 +1,45 @@
 #include "Exercise.h"
+#include "ProgressTracker.h"
+#include "../utils/ContentHash.h"
+#include "../utils/GradingService.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <algorithm>
 #include <numeric>
+#include <sstream>
 
 // TestCase implementation
-TestCase::TestCase(const std::string& input, const std::string& expectedOutput, 
-                  const std::string& description)
-    : input(input), expectedOutput(expectedOutput), description(description) {}
+TestCase::TestCase(const SharedText& input, const SharedText& expectedOutput, 
+                  const std::string& description, const ComparisonOptions& comparison)
+    : input(input), expectedOutput(expectedOutput), description(description), 
+      comparison(comparison), expectedFromReference(false), timeLimitSeconds(0.0) {}
+
+TestCase TestCase::fromReference(const SharedText& input, const std::string& description,
+                                 const ComparisonOptions& comparison) {
+    TestCase testCase(input, "", description, comparison);
+    testCase.expectedFromReference = true;
+    return testCase;
+}
+
+uint64_t TestCase::fingerprint() const {
+    std::ostringstream rule;
+    rule << static_cast<int>(comparison.mode) << ' ' << comparison.absoluteTolerance << ' '
+         << comparison.relativeTolerance << ' ' << input.size() << ' ' << expectedFromReference
+         << ' ' << timeLimitSeconds;
+    return contentHash(expectedOutput, contentHash(input, contentHash(rule.str())));
+}
 
 // Exercise implementation
 Exercise::Exercise(const std::string& id, const std::string& title, 
                   const std::string& description, ExerciseType type, 
                   DifficultyLevel difficulty)
     : exerciseId(id), title(title), description(description), type(type), 
-      difficulty(difficulty), maxAttempts(3), currentAttempts(0), 
-      completed(false), score(0.0) {}
+      difficulty(difficulty), nextTestCaseNumber(1), sanitizersRequired(false), maxAttempts(3), 
+      currentAttempts(0), completed(false), score(0.0), gradingService(nullptr), 
+      progressTracker(nullptr) {
+    rebuildFeatureMatcher();
+}
 
 void Exercise::setInstructions(const std::string& instructions) {
     this->instructions = instructions;
@@ -30,12 +55,98 @@ void Exercise::setSolutionCode(const std::string& code) {
 
 void Exercise::addTestCase(const TestCase& testCase) {
     testCases.push_back(testCase);
+    if (testCases.back().id.empty()) {
+        std::string id;
+        do {
+            id = "test-" + std::to_string(nextTestCaseNumber++);
+        } while (std::any_of(testCases.begin(), testCases.end(),
+                             [&id](const TestCase& existing) { return existing.id == id; }));
+        testCases.back().id = id;
+    }
+}
+
+bool Exercise::replaceTestCase(const std::string& testCaseId, const TestCase& testCase) {
+    auto it = std::find_if(testCases.begin(), testCases.end(),
+        [&testCaseId](const TestCase& existing) { return existing.id == testCaseId; });
+    if (it == testCases.end()) {
+        return false;
+    }
+    *it = testCase;
+    it->id = testCaseId;
+    return true;
+}
+
+bool Exercise::removeTestCase(const std::string& testCaseId) {
+    auto it = std::find_if(testCases.begin(), testCases.end(),
+        [&testCaseId](const TestCase& existing) { return existing.id == testCaseId; });
+    if (it == testCases.end()) {
+        return false;
+    }
+    testCases.erase(it);
+    return true;
+}
+
+void Exercise::addRequiredFeature(const std::string& feature) {
+    requiredFeatures.push_back(feature);
+    rebuildFeatureMatcher();
+}
+
+void Exercise::addForbiddenFeature(const std::string& feature) {
+    forbiddenFeatures.push_back(feature);
+    rebuildFeatureMatcher();
+}
+
+bool Exercise::hasReferenceTestCases() const {
+    return std::any_of(testCases.begin(), testCases.end(), 
+        [](const TestCase& testCase) { return testCase.expectedFromReference; });
 }
 
 void Exercise::setMaxAttempts(int attempts) {
     this->maxAttempts = attempts;
 }
 
+void Exercise::setPerformanceSpec(const PerformanceSpec& spec) {
+    this->performanceSpec = spec;
+}
+
+void Exercise::addPerformanceInput(const SharedText& input) {
+    performanceSpec.inputs.push_back(input);
+    performanceSpec.enabled = true;
+}
+
+void Exercise::setRandomTestSpec(const RandomTestSpec& spec) {
+    this->randomTestSpec = spec;
+}
+
+void Exercise::setSanitizersRequired(bool required) {
+    this->sanitizersRequired = required;
+}
+
+void Exercise::setAllocationLimits(const AllocationLimits& limits) {
+    this->allocationLimits = limits;
+}
+
+void Exercise::setInteractiveSpec(const InteractiveSpec& spec) {
+    this->interactiveSpec = spec;
+}
+
+void Exercise::setCheckerSpec(const CheckerSpec& spec) {
+    this->checkerSpec = spec;
+}
+
+void Exercise::setProgressListener(ProgressListener listener) {
+    this->progressListener = std::move(listener);
+}
+
+void Exercise::setGradingService(GradingService* service) {
+    this->gradingService = service;
+}
+
+void Exercise::setProgressTracker(ProgressTracker* tracker, const std::string& moduleId) {
+    this->progressTracker = tracker;
+    this->progressModuleId = moduleId;
+}
+
 void Exercise::displayExercise() const {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "Exercise: " << title << std::endl;
@@ -83,22 +194,64 @@ void Exercise::displayExercise() const {
 }
 
 bool Exercise::submitSolution(const std::string& code) {
+    if (!submitSolutionAsync(code)) {
+        return false;
+    }
+    SubmissionResult result = pendingGrading.get();
+    pendingGrading = std::shared_future<SubmissionResult>();
+    return applyGrading(result);
+}
+
+bool Exercise::submitSolutionAsync(const std::string& code) {
     if (currentAttempts >= maxAttempts) {
         std::cout << "Maximum attempts exceeded for this exercise." << std::endl;
         return false;
     }
     
-    currentAttempts++;
+    auto promise = std::make_shared<std::promise<SubmissionResult>>();
+    std::shared_future<SubmissionResult> grading = promise->get_future().share();
     
-    if (validateSolution(code)) {
-        completed = true;
-        std::cout << "✓ Exercise completed successfully!" << std::endl;
-        std::cout << "Score: " << score << "/100" << std::endl;
-        return true;
+    if (code.empty() || type == ExerciseType::MULTIPLE_CHOICE || type == ExerciseType::FILL_IN_BLANK) {
+        // Nothing to compile: an empty submission fails, answers are compared
+        // with the expected outputs right away
+        if (isGradingPending()) {
+            getGradingService().cancel(getSubmissionKey());
+        }
+        SubmissionResult result;
+        result.compiled = !code.empty();
+        if (result.compiled) {
+            for (const auto& testCase : testCases) {
+                result.testsPassed.push_back(
+                    OutputComparator::matches(testCase.expectedOutput, code, testCase.comparison));
+            }
+        }
+        promise->set_value(std::move(result));
     } else {
-        std::cout << "✗ Solution incorrect. Attempts remaining: " << getRemainingAttempts() << std::endl;
+        getGradingService().submit(getSubmissionKey(), code, *this, 
+            [promise](const TestSuite& suite) {
+                SubmissionResult result;
+                result.cancelled = suite.cancelledCount > 0;
+                result.compiled = suite.compiled;
+                for (const TestResult& test : suite.results) {
+                    result.testsPassed.push_back(test.status == TestStatus::PASSED);
+                }
+                promise->set_value(std::move(result));
+            });
+    }
+    
+    pendingGrading = grading;
+    return true;
+}
+
+bool Exercise::pollGrading() {
+    if (!isGradingPending() || 
+        pendingGrading.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
         return false;
     }
+    SubmissionResult result = pendingGrading.get();
+    pendingGrading = std::shared_future<SubmissionResult>();
+    applyGrading(result);
+    return true;
 }
 
 void Exercise::provideFeedback(const std::string& feedback) const {
@@ -106,28 +259,97 @@ void Exercise::provideFeedback(const std::string& feedback) const {
 }
 
 void Exercise::reset() {
+    if (isGradingPending()) {
+        getGradingService().cancel(getSubmissionKey());
+        pendingGrading = std::shared_future<SubmissionResult>();
+    }
+    bool wasCompleted = completed;
+    double previousScore = score;
     currentAttempts = 0;
     completed = false;
     score = 0.0;
+    notifyProgress(wasCompleted, previousScore);
+}
+
+void Exercise::notifyProgress(bool wasCompleted, double previousScore) const {
+    if (completed == wasCompleted && score == previousScore) {
+        return;
+    }
+    if (catalogEntry.manager) {
+        catalogEntry.manager->updateProgress(catalogEntry.position, wasCompleted, previousScore);
+    }
+    if (progressListener) {
+        progressListener(*this, wasCompleted, previousScore);
+    }
+}
+
+GradingService& Exercise::getGradingService() const {
+    return gradingService ? *gradingService : GradingService::shared();
+}
+
+uint64_t Exercise::SubmitterId::next() {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
-bool Exercise::validateSolution(const std::string& code) {
-    // Basic validation - in a real implementation, this would compile and test the code
-    if (code.empty()) {
-        score = 0.0;
+std::string Exercise::getSubmissionKey() const {
+    // A newer submission from this exercise supersedes its pending one, but
+    // not those of its copies, which share the id and the grading service
+    return exerciseId + "#" + std::to_string(submitterId.serial);
+}
+
+Exercise Exercise::gradingSnapshot() const {
+    Exercise snapshot(exerciseId, title, std::string(), type, difficulty);
+    snapshot.testCases = testCases;
+    snapshot.nextTestCaseNumber = nextTestCaseNumber;
+    snapshot.requiredFeatures = requiredFeatures;
+    snapshot.forbiddenFeatures = forbiddenFeatures;
+    snapshot.featureMatcher = featureMatcher;
+    snapshot.solutionCode = solutionCode;
+    snapshot.performanceSpec = performanceSpec;
+    snapshot.randomTestSpec = randomTestSpec;
+    snapshot.sanitizersRequired = sanitizersRequired;
+    snapshot.allocationLimits = allocationLimits;
+    snapshot.interactiveSpec = interactiveSpec;
+    snapshot.checkerSpec = checkerSpec;
+    return snapshot;
+}
+
+bool Exercise::applyGrading(const SubmissionResult& result) {
+    if (result.cancelled) {
+        std::cout << "Submission was cancelled; no attempt used." << std::endl;
         return false;
     }
     
-    // Simulate test case validation
-    std::vector<bool> testResults;
-    for (const auto& testCase : testCases) {
-        // For now, just simulate passing tests
-        // In real implementation, this would compile and run the code
-        testResults.push_back(true);
+    currentAttempts++;
+    
+    bool wasCompleted = completed;
+    double previousScore = score;
+    score = calculateScore(result.testsPassed);
+    bool passed = score >= 70.0; // Pass threshold
+    if (passed) {
+        completed = true;
     }
+    notifyProgress(wasCompleted, previousScore);
     
-    score = calculateScore(testResults);
-    return score >= 70.0; // Pass threshold
+    if (passed) {
+        if (progressTracker && !wasCompleted) {
+            progressTracker->completeExercise(progressModuleId, exerciseId, score);
+        }
+        std::cout << "✓ Exercise completed successfully!" << std::endl;
+        std::cout << "Score: " << score << "/100" << std::endl;
+        return true;
+    } else {
+        if (!result.compiled) {
+            std::cout << "✗ Solution did not compile." << std::endl;
+        }
+        std::cout << "✗ Solution incorrect. Attempts remaining: " << getRemainingAttempts() << std::endl;
+        return false;
+    }
+}
+
+void Exercise::rebuildFeatureMatcher() {
+    featureMatcher = std::make_shared<const FeatureMatcher>(requiredFeatures, forbiddenFeatures);
 }
 
 double Exercise::calculateScore(const std::vector<bool>& testResults) {
@@ -142,39 +364,94 @@ double Exercise::calculateScore(const std::vector<bool>& testResults) {
 }
 
 // ExerciseManager implementation
+ExerciseManager::ExerciseManager() : completedCount(0), completedScoreTotal(0.0) {}
+
 void ExerciseManager::addExercise(std::unique_ptr<Exercise> exercise) {
+    size_t position = exercises.size();
+    positions.emplace(exercise->getId(), position);
+    
+    for (Bitmap& bitmap : byDifficulty) {
+        bitmap.resize(position + 1);
+    }
+    for (Bitmap& bitmap : byType) {
+        bitmap.resize(position + 1);
+    }
+    completed.resize(position + 1);
+    byDifficulty[static_cast<size_t>(exercise->getDifficulty())].set(position);
+    byType[static_cast<size_t>(exercise->getType())].set(position);
+    
+    // Separate from the exercise's own listener, which stays the caller's
+    exercise->catalogEntry.manager = this;
+    exercise->catalogEntry.position = position;
     exercises.push_back(std::move(exercise));
+    updateProgress(position, false, 0.0);
 }
 
 Exercise* ExerciseManager::getExercise(const std::string& id) {
-    auto it = std::find_if(exercises.begin(), exercises.end(),
-        [&id](const std::unique_ptr<Exercise>& ex) {
-            return ex->getId() == id;
-        });
-    
-    return (it != exercises.end()) ? it->get() : nullptr;
+    auto it = positions.find(id);
+    return it != positions.end() ? exercises[it->second].get() : nullptr;
 }
 
 std::vector<Exercise*> ExerciseManager::getExercisesByDifficulty(DifficultyLevel difficulty) {
-    std::vector<Exercise*> result;
-    for (const auto& exercise : exercises) {
-        if (exercise->getDifficulty() == difficulty) {
-            result.push_back(exercise.get());
-        }
-    }
-    return result;
+    return find(ExerciseFilter().withDifficulty(difficulty));
 }
 
 std::vector<Exercise*> ExerciseManager::getExercisesByType(ExerciseType type) {
-    std::vector<Exercise*> result;
-    for (const auto& exercise : exercises) {
-        if (exercise->getType() == type) {
-            result.push_back(exercise.get());
-        }
+    return find(ExerciseFilter().withType(type));
+}
+
+size_t ExerciseManager::count(const ExerciseFilter& filter) const {
+    if (!filter.byDifficulty && !filter.byType && !filter.byCompletion) {
+        return exercises.size();
     }
+    size_t total = 0;
+    for (size_t index = 0; index < completed.wordCount(); ++index) {
+        total += Bitmap::popcount(matchingWord(filter, index));
+    }
+    return total;
+}
+
+std::vector<Exercise*> ExerciseManager::find(const ExerciseFilter& filter) {
+    std::vector<Exercise*> result;
+    result.reserve(count(filter));
+    forEach(filter, [&result](Exercise& exercise) { result.push_back(&exercise); });
     return result;
 }
 
+uint64_t ExerciseManager::matchingWord(const ExerciseFilter& filter, size_t index) const {
+    uint64_t bits = ~uint64_t(0);
+    size_t remaining = exercises.size() - index * Bitmap::WORD_BITS;
+    if (remaining < Bitmap::WORD_BITS) {
+        bits = (uint64_t(1) << remaining) - 1;
+    }
+    if (filter.byDifficulty) {
+        bits &= byDifficulty[static_cast<size_t>(filter.difficulty)].word(index);
+    }
+    if (filter.byType) {
+        bits &= byType[static_cast<size_t>(filter.type)].word(index);
+    }
+    if (filter.byCompletion) {
+        bits &= filter.completed ? completed.word(index) : ~completed.word(index);
+    }
+    return bits;
+}
+
+void ExerciseManager::updateProgress(size_t position, bool wasCompleted, double previousScore) {
+    const Exercise& exercise = *exercises[position];
+    if (wasCompleted) {
+        completedCount--;
+        completedScoreTotal -= previousScore;
+    }
+    if (exercise.isCompleted()) {
+        completedCount++;
+        completedScoreTotal += exercise.getScore();
+    }
+    if (completedCount == 0) {
+        completedScoreTotal = 0.0; // no rounding residue once nothing is counted
+    }
+    completed.set(position, exercise.isCompleted());
+}
+
 bool ExerciseManager::startExercise(const std::string& id) {
     Exercise* exercise = getExercise(id);
     if (exercise) {
@@ -200,30 +477,19 @@ Exercise* ExerciseManager::getCurrentExercise() {
 }
 
 int ExerciseManager::getCompletedCount() const {
-    return std::count_if(exercises.begin(), exercises.end(),
-        [](const std::unique_ptr<Exercise>& ex) {
-            return ex->isCompleted();
-        });
+    return completedCount;
 }
 
 double ExerciseManager::getAverageScore() const {
-    std::vector<double> scores;
-    for (const auto& exercise : exercises) {
-        if (exercise->isCompleted()) {
-            scores.push_back(exercise->getScore());
-        }
-    }
-    
-    if (scores.empty()) return 0.0;
-    
-    return std::accumulate(scores.begin(), scores.end(), 0.0) / scores.size();
+    return completedCount > 0 ? completedScoreTotal / completedCount : 0.0;
 }
 
 std::vector<std::string> ExerciseManager::getCompletedExerciseIds() const {
     std::vector<std::string> result;
-    for (const auto& exercise : exercises) {
-        if (exercise->isCompleted()) {
-            result.push_back(exercise->getId());
+    result.reserve(completedCount);
+    for (size_t index = 0; index < completed.wordCount(); ++index) {
+        for (uint64_t bits = completed.word(index); bits != 0; bits &= bits - 1) {
+            result.push_back(exercises[index * Bitmap::WORD_BITS + Bitmap::lowestBit(bits)]->getId());
         }
     }
     return result;
@@ -1,7 +1,21 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include "Lesson.h"
+#include "../utils/OutputComparator.h"
+#include "../utils/FeatureMatcher.h"
+#include "../utils/SharedText.h"
+#include "../utils/Bitmap.h"
+
+class GradingService;
+class ProgressTracker;
+class ExerciseManager;
 
 enum class ExerciseType {
     CODING,
@@ -11,15 +25,121 @@ enum class ExerciseType {
 };
 
 struct TestCase {
-    std::string input;
-    std::string expectedOutput;
+    std::string id;            // stable across edits; assigned by Exercise::addTestCase if empty
+    SharedText input;          // shared with every TestResult produced from this case
+    SharedText expectedOutput;
     std::string description;
+    ComparisonOptions comparison;
+    bool expectedFromReference; // expected output generated by the reference solution
+    double timeLimitSeconds;    // wall-time limit, 0 = the runner's timeout; set by calibration
+    
+    // Either side may be a mapped fixture (see FixtureStore)
+    TestCase(const SharedText& input, const SharedText& expectedOutput, 
+             const std::string& description = "",
+             const ComparisonOptions& comparison = ComparisonOptions());
+    
+    // Test case whose expected output comes from running Exercise::solutionCode
+    static TestCase fromReference(const SharedText& input, const std::string& description = "",
+                                  const ComparisonOptions& comparison = ComparisonOptions());
+    
+    // Hash of everything that decides a submission's result on this test
+    // (input, expected output, comparison rule, time limit), but not the
+    // description
+    uint64_t fingerprint() const;
+};
+
+// Benchmarking settings for efficiency exercises. The submission is timed
+// on each performance input and judged by its slowdown relative to the
+// reference solution, measured on the same host in the same session.
+struct PerformanceSpec {
+    bool enabled;
+    std::vector<SharedText> inputs;
+    int warmupRuns;         // discarded before measuring
+    int measuredRuns;
+    double maxSlowdown;     // allowed submission / reference median CPU time
+    double maxMemoryRatio;  // allowed peak memory ratio, 0 = not checked
     
-    TestCase(const std::string& input, const std::string& expectedOutput, 
-             const std::string& description = "");
+    PerformanceSpec() 
+        : enabled(false), warmupRuns(1), measuredRuns(7), maxSlowdown(2.0), 
+          maxMemoryRatio(0.0) {}
+};
+
+// Randomized testing against the reference solution. Inputs come from an
+// in-process generator or from a generator program that reads "<seed> <size>"
+// on stdin and prints one input; the same seed and size must always produce
+// the same input. Sizes grow over the run, and a counterexample is shrunk by
+// looking for failures at smaller sizes.
+struct RandomTestSpec {
+    using Generator = std::function<std::string(uint64_t seed, size_t size)>;
+    
+    bool enabled;
+    Generator generator;        // preferred: no process per input
+    std::string generatorCode;  // used when no in-process generator is set
+    size_t iterations;
+    size_t maxSize;
+    uint64_t seed;
+    size_t shrinkAttempts;      // generator runs spent on shrinking
+    ComparisonOptions comparison;
+    
+    RandomTestSpec() 
+        : enabled(false), iterations(1000), maxSize(100), seed(1), shrinkAttempts(200) {}
+};
+
+// Interactive exercises (guessing games, menus): an instructor-written
+// interactor converses with the submission over its stdin/stdout. It gets
+// each test case's input as a file named by argv[1] and gives the verdict
+// by exit code (0 accepted, 1 wrong answer), explaining it on stderr.
+struct InteractiveSpec {
+    bool enabled;
+    std::string interactorCode;
+    double totalSeconds;    // per test
+    double idleSeconds;     // longest wait for either side's next message
+    
+    InteractiveSpec() : enabled(false), totalSeconds(10.0), idleSeconds(2.0) {}
+};
+
+// Exercises with many valid outputs (any ordering, floating-point answers)
+// are judged by an instructor-written checker instead of exact comparison.
+// It gets the input, expected output and program output as files named by
+// argv[1..3], exits 0 to accept or 1 to reject, and may print a score in
+// [0, 1]. Outputs identical to the expected output are accepted unchecked.
+struct CheckerSpec {
+    bool enabled;
+    std::string checkerCode;
+    double timeoutSeconds;  // per checked output
+    
+    CheckerSpec() : enabled(false), timeoutSeconds(5.0) {}
+};
+
+// Heap-usage requirements for memory-management exercises, checked on every
+// test with the allocation shim. Negative limits are not checked.
+struct AllocationLimits {
+    bool enabled;
+    long long maxAllocations;   // heap allocations per run, including operator new and
+                                // the standard streams' buffers
+    long long maxPeakBytes;     // live heap bytes at any point
+    bool forbidLeaks;           // every allocation freed by exit
+    
+    AllocationLimits() : enabled(false), maxAllocations(-1), maxPeakBytes(-1), forbidLeaks(false) {}
+};
+
+// What grading decided about one submission; applied to the exercise by
+// the thread that owns it
+struct SubmissionResult {
+    bool cancelled;     // superseded by a newer submission, or the exercise was reset
+    bool compiled;
+    std::vector<bool> testsPassed;
+    
+    SubmissionResult() : cancelled(false), compiled(false) {}
 };
 
 class Exercise {
+public:
+    // Called after an attempt or reset changed completion or score, with
+    // the values from before (e.g. to refresh a progress display)
+    using ProgressListener = std::function<void(const Exercise& exercise, bool wasCompleted, 
+                                                double previousScore)>;
+
 private:
     std::string exerciseId;
     std::string title;
@@ -28,12 +148,54 @@ private:
     ExerciseType type;
     DifficultyLevel difficulty;
     std::vector<TestCase> testCases;
+    int nextTestCaseNumber; // for ids of added test cases; never reused
+    std::vector<std::string> requiredFeatures;
+    std::vector<std::string> forbiddenFeatures;
+    std::shared_ptr<const FeatureMatcher> featureMatcher; // rebuilt when features change
     std::string starterCode;
     std::string solutionCode;
+    PerformanceSpec performanceSpec;
+    RandomTestSpec randomTestSpec;
+    bool sanitizersRequired; // memory-safety exercises: always run the sanitized tier
+    AllocationLimits allocationLimits;
+    InteractiveSpec interactiveSpec;
+    CheckerSpec checkerSpec;
     int maxAttempts;
     int currentAttempts;
     bool completed;
     double score;
+    ProgressListener progressListener;
+    // The ExerciseManager holding this exercise, told about progress before
+    // the listener. Copies of the exercise start outside any catalog.
+    struct CatalogEntry {
+        ExerciseManager* manager;
+        size_t position;
+
+        CatalogEntry() : manager(nullptr), position(0) {}
+        CatalogEntry(const CatalogEntry&) : CatalogEntry() {}
+        CatalogEntry& operator=(const CatalogEntry&) { return *this; }
+    } catalogEntry;
+    // Keys this exercise's submissions in the grading service, apart from
+    // those of its copies (e.g. one per student). A move takes it along with
+    // the pending grading, so that can still be superseded or cancelled.
+    struct SubmitterId {
+        uint64_t serial;
+
+        SubmitterId() : serial(next()) {}
+        SubmitterId(const SubmitterId&) : SubmitterId() {}
+        SubmitterId(SubmitterId&& other) noexcept : serial(other.serial) { other.serial = next(); }
+        SubmitterId& operator=(const SubmitterId&) { return *this; }
+        SubmitterId& operator=(SubmitterId&& other) noexcept {
+            std::swap(serial, other.serial);
+            return *this;
+        }
+
+        static uint64_t next();
+    } submitterId;
+    GradingService* gradingService;     // nullptr = GradingService::shared()
+    ProgressTracker* progressTracker;   // told about completions; may be null
+    std::string progressModuleId;
+    std::shared_future<SubmissionResult> pendingGrading;
 
 public:
     Exercise(const std::string& id, const std::string& title, 
@@ -44,8 +206,26 @@ public:
     void setInstructions(const std::string& instructions);
     void setStarterCode(const std::string& code);
     void setSolutionCode(const std::string& code);
+    // Keeps the test case's id, or assigns the next unused "test-<n>"
     void addTestCase(const TestCase& testCase);
+    // Edits keep the id, so results for the other tests stay reusable
+    bool replaceTestCase(const std::string& testCaseId, const TestCase& testCase);
+    bool removeTestCase(const std::string& testCaseId);
+    void addRequiredFeature(const std::string& feature);
+    void addForbiddenFeature(const std::string& feature);
     void setMaxAttempts(int attempts);
+    void setPerformanceSpec(const PerformanceSpec& spec);
+    void addPerformanceInput(const SharedText& input);
+    void setRandomTestSpec(const RandomTestSpec& spec);
+    void setSanitizersRequired(bool required);
+    void setAllocationLimits(const AllocationLimits& limits);
+    void setInteractiveSpec(const InteractiveSpec& spec);
+    void setCheckerSpec(const CheckerSpec& spec);
+    void setProgressListener(ProgressListener listener);
+    void setGradingService(GradingService* service); // nullptr = the shared service
+    // Completions are recorded in tracker under moduleId; the tracker must
+    // outlive the exercise's pending grading
+    void setProgressTracker(ProgressTracker* tracker, const std::string& moduleId);
     
     // Getters
     const std::string& getId() const { return exerciseId; }
@@ -55,33 +235,122 @@ public:
     ExerciseType getType() const { return type; }
     DifficultyLevel getDifficulty() const { return difficulty; }
     const std::string& getStarterCode() const { return starterCode; }
+    const std::string& getSolutionCode() const { return solutionCode; }
+    const PerformanceSpec& getPerformanceSpec() const { return performanceSpec; }
+    const RandomTestSpec& getRandomTestSpec() const { return randomTestSpec; }
+    bool areSanitizersRequired() const { return sanitizersRequired; }
+    const AllocationLimits& getAllocationLimits() const { return allocationLimits; }
+    const InteractiveSpec& getInteractiveSpec() const { return interactiveSpec; }
+    const CheckerSpec& getCheckerSpec() const { return checkerSpec; }
     const std::vector<TestCase>& getTestCases() const { return testCases; }
+    bool hasReferenceTestCases() const;
+    const std::vector<std::string>& getRequiredFeatures() const { return requiredFeatures; }
+    const std::vector<std::string>& getForbiddenFeatures() const { return forbiddenFeatures; }
+    const FeatureMatcher& getFeatureMatcher() const { return *featureMatcher; }
     bool isCompleted() const { return completed; }
     double getScore() const { return score; }
     int getRemainingAttempts() const { return maxAttempts - currentAttempts; }
+    // What grading reads: tests, solution, features and judging rules, but
+    // no progress, listener, tracker or pending grading
+    Exercise gradingSnapshot() const;
     
     // Exercise execution
     void displayExercise() const;
+    // Compiles and tests the code through the grading service and waits
     bool submitSolution(const std::string& code);
+    // Queues the code for grading; false when no attempts are left. A newer
+    // submission cancels a pending one, which then doesn't cost an attempt.
+    bool submitSolutionAsync(const std::string& code);
+    bool isGradingPending() const { return pendingGrading.valid(); }
+    // Applies a finished grading (attempts, score, completion, progress) on
+    // the calling thread; false while nothing has finished
+    bool pollGrading();
     void provideFeedback(const std::string& feedback) const;
     void reset();
     
 private:
-    bool validateSolution(const std::string& code);
+    GradingService& getGradingService() const;
+    std::string getSubmissionKey() const;
+    bool applyGrading(const SubmissionResult& result);
+    void notifyProgress(bool wasCompleted, double previousScore) const;
+    void rebuildFeatureMatcher();
     double calculateScore(const std::vector<bool>& testResults);
+
+    friend class ExerciseManager;
+};
+
+// Conditions for ExerciseManager queries; conditions left unset match everything
+struct ExerciseFilter {
+    bool byDifficulty;
+    DifficultyLevel difficulty;
+    bool byType;
+    ExerciseType type;
+    bool byCompletion;
+    bool completed;
+    
+    ExerciseFilter() 
+        : byDifficulty(false), difficulty(DifficultyLevel::BEGINNER), byType(false), 
+          type(ExerciseType::CODING), byCompletion(false), completed(false) {}
+    
+    ExerciseFilter& withDifficulty(DifficultyLevel level) {
+        byDifficulty = true;
+        difficulty = level;
+        return *this;
+    }
+    ExerciseFilter& withType(ExerciseType exerciseType) {
+        byType = true;
+        type = exerciseType;
+        return *this;
+    }
+    ExerciseFilter& withCompleted(bool isCompleted) {
+        byCompletion = true;
+        completed = isCompleted;
+        return *this;
+    }
 };
 
+// Owns a catalog's exercises. Ids are looked up through a hash index;
+// difficulty, type and completion each have one bitmap per value over the
+// insertion order, so combined filters are a few word-wide ANDs. Completion
+// count and score total are kept up to date by the exercises themselves.
 class ExerciseManager {
 private:
+    static constexpr size_t DIFFICULTY_LEVELS = 3;
+    static constexpr size_t EXERCISE_TYPES = 4;
+    
     std::vector<std::unique_ptr<Exercise>> exercises;
+    std::unordered_map<std::string, size_t> positions; // id -> index in exercises (first one wins)
+    Bitmap byDifficulty[DIFFICULTY_LEVELS];
+    Bitmap byType[EXERCISE_TYPES];
+    Bitmap completed;
+    int completedCount;
+    double completedScoreTotal;
     std::string currentExerciseId;
 
 public:
+    ExerciseManager();
+    // The exercises report progress to this manager, so it can't be copied
+    ExerciseManager(const ExerciseManager&) = delete;
+    ExerciseManager& operator=(const ExerciseManager&) = delete;
+    
     void addExercise(std::unique_ptr<Exercise> exercise);
     Exercise* getExercise(const std::string& id);
+    size_t getExerciseCount() const { return exercises.size(); }
     std::vector<Exercise*> getExercisesByDifficulty(DifficultyLevel difficulty);
     std::vector<Exercise*> getExercisesByType(ExerciseType type);
     
+    // Queries; forEach visits matches in insertion order without allocating
+    template <typename Visitor>
+    void forEach(const ExerciseFilter& filter, Visitor&& visit) {
+        for (size_t index = 0; index < completed.wordCount(); ++index) {
+            for (uint64_t bits = matchingWord(filter, index); bits != 0; bits &= bits - 1) {
+                visit(*exercises[index * Bitmap::WORD_BITS + Bitmap::lowestBit(bits)]);
+            }
+        }
+    }
+    size_t count(const ExerciseFilter& filter) const;
+    std::vector<Exercise*> find(const ExerciseFilter& filter);
+    
     bool startExercise(const std::string& id);
     void completeCurrentExercise();
     Exercise* getCurrentExercise();
@@ -90,4 +359,11 @@ public:
     int getCompletedCount() const;
     double getAverageScore() const;
     std::vector<std::string> getCompletedExerciseIds() const;
+
+private:
+    // The 64 positions from index * 64 that match filter, one bit each
+    uint64_t matchingWord(const ExerciseFilter& filter, size_t index) const;
+    void updateProgress(size_t position, bool wasCompleted, double previousScore);
+
+    friend class Exercise;
 };
@@ -68,7 +68,7 @@ void Lesson::addPrerequisite(const std::string& prerequisite) {
     prerequisites.push_back(prerequisite);
 }
 
-void Lesson::startLesson() {
+void Lesson::startLesson() const {
     std::cout << "\n" << std::string(50, '=') << std::endl;
     std::cout << "Starting Lesson: " << title << std::endl;
     std::cout << std::string(50, '=') << std::endl;
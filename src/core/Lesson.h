@@ -83,7 +83,7 @@ public:
     bool isCompleted() const { return completed; }
     
     // Learning methods
-    void startLesson();
+    void startLesson() const;
     void completeLesson();
     bool checkPrerequisites(const std::vector<std::string>& completedLessons) const;
     void displayContent() const;
@@ -13,7 +13,7 @@ ProgressTracker::ProgressTracker(const std::string& studentId)
 
 void ProgressTracker::startModule(const std::string& moduleId, const std::string& moduleName) {
     if (moduleProgress.find(moduleId) == moduleProgress.end()) {
-        moduleProgress[moduleId] = ModuleProgress(moduleId, moduleName);
+        moduleProgress.emplace(moduleId, ModuleProgress(moduleId, moduleName));
         std::cout << "Started module: " << moduleName << std::endl;
     }
 }
@@ -69,7 +69,7 @@ void ProgressTracker::completeModule(const std::string& moduleId) {
 void ProgressTracker::updateConceptMastery(const std::string& conceptId, double performanceScore) {
     auto it = conceptMastery.find(conceptId);
     if (it == conceptMastery.end()) {
-        conceptMastery[conceptId] = ConceptMastery(conceptId);
+        conceptMastery.emplace(conceptId, ConceptMastery(conceptId));
         it = conceptMastery.find(conceptId);
     }
     
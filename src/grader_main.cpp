@@ -0,0 +1,131 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "utils/BatchGrader.h"
+#include "utils/ReferenceOutputCache.h"
+#include "utils/GradingMemo.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program
+                  << " --manifest <file> --exercises <dir> --output <file> [--jobs <n>]"
+                  << " [--format csv|jsonl|junit] [--reference-cache <dir>]"
+                  << " [--memo <dir>] [--instruction-limit <n>]"
+                  << " [--time-multiplier <x> [--time-floor <seconds>]]" << std::endl;
+        std::cerr << "  manifest:  one '<submissionId> <exerciseId> <sourcePath>' per line" << std::endl;
+        std::cerr << "  exercises: <dir>/<exerciseId>/<name>.in + <name>.out test pairs;" << std::endl;
+        std::cerr << "             with <dir>/<exerciseId>/solution.cpp, missing .out files" << std::endl;
+        std::cerr << "             are generated by running the reference solution" << std::endl;
+        std::cerr << "  jobs:      worker threads (default: one per hardware thread)" << std::endl;
+        std::cerr << "  reference-cache: directory persisting generated outputs across runs" << std::endl;
+        std::cerr << "  memo:      directory persisting results of token-identical submissions" << std::endl;
+        std::cerr << "  instruction-limit: judge time limits by instructions retired instead of" << std::endl;
+        std::cerr << "             wall time (needs hardware counters; falls back otherwise)" << std::endl;
+        std::cerr << "  time-multiplier: limit each test to x times the reference solution's" << std::endl;
+        std::cerr << "             time on this host, at least time-floor (default 0.5s)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string manifestFile;
+    std::string exercisesDirectory;
+    std::string outputFile;
+    std::string referenceCacheDirectory;
+    std::string memoDirectory;
+    unsigned int jobs = 0;
+    uint64_t instructionLimit = 0;
+    TimeLimitCalibration calibration;
+    ReportFormat format = ReportFormat::CSV;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 2;
+        }
+
+        if (arg == "--manifest") {
+            manifestFile = argv[++i];
+        } else if (arg == "--exercises") {
+            exercisesDirectory = argv[++i];
+        } else if (arg == "--output") {
+            outputFile = argv[++i];
+        } else if (arg == "--reference-cache") {
+            referenceCacheDirectory = argv[++i];
+        } else if (arg == "--memo") {
+            memoDirectory = argv[++i];
+        } else if (arg == "--instruction-limit") {
+            instructionLimit = std::stoull(argv[++i]);
+        } else if (arg == "--time-multiplier") {
+            calibration.enabled = true;
+            calibration.multiplier = std::stod(argv[++i]);
+        } else if (arg == "--time-floor") {
+            calibration.floorSeconds = std::stod(argv[++i]);
+        } else if (arg == "--jobs") {
+            jobs = static_cast<unsigned int>(std::stoul(argv[++i]));
+        } else if (arg == "--format") {
+            std::string name = argv[++i];
+            if (name == "csv") {
+                format = ReportFormat::CSV;
+            } else if (name == "jsonl") {
+                format = ReportFormat::JSON_LINES;
+            } else if (name == "junit") {
+                format = ReportFormat::JUNIT_XML;
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (manifestFile.empty() || exercisesDirectory.empty() || outputFile.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Submission> submissions;
+    if (!BatchGrader::loadManifest(manifestFile, submissions)) {
+        std::cerr << "✗ Cannot read manifest: " << manifestFile << std::endl;
+        return 1;
+    }
+
+    BatchGrader grader(jobs);
+    grader.setReportFormat(format);
+    if (!referenceCacheDirectory.empty() || calibration.enabled) {
+        auto cache = std::make_shared<ReferenceOutputCache>(nullptr, referenceCacheDirectory);
+        cache->setTimeLimitCalibration(calibration);
+        grader.setReferenceCache(std::move(cache));
+    }
+    if (!memoDirectory.empty()) {
+        grader.setGradingMemo(std::make_shared<GradingMemo>(memoDirectory));
+    }
+    if (instructionLimit != 0) {
+        if (!CodeCompiler::areCountersAvailable()) {
+            std::cerr << "⚠ Hardware counters unavailable; using wall-time limits" << std::endl;
+        }
+        grader.setInstructionLimit(instructionLimit);
+    }
+    size_t exerciseCount = grader.loadExerciseDirectory(exercisesDirectory);
+    if (exerciseCount == 0) {
+        std::cerr << "✗ No exercises found in: " << exercisesDirectory << std::endl;
+        return 1;
+    }
+
+    std::ofstream output(outputFile);
+    if (!output.is_open()) {
+        std::cerr << "✗ Cannot open output file: " << outputFile << std::endl;
+        return 1;
+    }
+
+    std::cout << "Grading " << submissions.size() << " submissions against "
+              << exerciseCount << " exercises..." << std::endl;
+
+    BatchSummary summary = grader.gradeAll(submissions, output);
+    std::cout << BatchGrader::formatSummary(summary);
+
+    return 0;
+}
@@ -4,7 +4,7 @@
 #include "core/Exercise.h"
 #include "core/ProgressTracker.h"
 #include "utils/CodeCompiler.h"
-#include "utils/TestRunner.h"
+#include "utils/GradingService.h"
 
 int main() {
     std::cout << "C++ Learning Curriculum System" << std::endl;
@@ -12,8 +12,8 @@ int main() {
     
     // Initialize core components
     auto progressTracker = std::make_unique<ProgressTracker>("student_001");
-    auto compiler = std::make_unique<CodeCompiler>(CompilerType::GCC);
-    auto testRunner = std::make_unique<TestRunner>();
+    // Exercises grade through the shared service; its runner owns the compiler
+    CodeCompiler* compiler = GradingService::shared().getRunner().getCompiler();
     
     // Test basic functionality
     std::cout << "\nTesting system components..." << std::endl;
@@ -52,6 +52,7 @@ int main() {
     
     TestCase testCase("", "25", "Variable should be initialized to 25");
     exercise->addTestCase(testCase);
+    exercise->setProgressTracker(progressTracker.get(), "module-1");
     
     std::cout << "✓ Sample exercise created: " << exercise->getTitle() << std::endl;
     
@@ -0,0 +1,498 @@
+#include "BatchGrader.h"
+#include "ReportWriter.h"
+#include "ReferenceOutputCache.h"
+#include "GradingMemo.h"
+#include "FixtureStore.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace {
+    struct SubmissionState {
+        const Submission* submission;
+        const std::vector<TestCase>* testCases;
+        std::string checkerPath;
+        TestSuite suite;
+        std::string executablePath;
+        std::string errorMessage;
+        std::string memoKey;
+        std::string submissionKey;  // for per-test results
+        std::vector<bool> reused;
+        bool memoHit;
+        std::atomic<size_t> remainingTests;
+        std::chrono::steady_clock::time_point startTime;
+
+        SubmissionState(const Submission& submission)
+            : submission(&submission), testCases(nullptr),
+              suite(submission.submissionId), memoHit(false), remainingTests(0) {}
+    };
+
+    std::string csvField(const std::string& value) {
+        if (value.find_first_of(",\"\n") == std::string::npos) {
+            return value;
+        }
+
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+BatchGrader::BatchGrader(unsigned int workers) 
+    : workerCount(workers), reportFormat(ReportFormat::CSV) {}
+
+void BatchGrader::setCompiler(std::unique_ptr<CodeCompiler> compiler) {
+    runner.setCompiler(std::move(compiler));
+}
+
+void BatchGrader::setReferenceCache(std::shared_ptr<ReferenceOutputCache> cache) {
+    runner.setReferenceCache(std::move(cache));
+}
+
+void BatchGrader::setGradingMemo(std::shared_ptr<GradingMemo> memo) {
+    runner.setGradingMemo(std::move(memo));
+}
+
+void BatchGrader::setInstructionLimit(uint64_t instructions) {
+    runner.setInstructionLimit(instructions);
+}
+
+void BatchGrader::setReportFormat(ReportFormat format) {
+    reportFormat = format;
+}
+
+void BatchGrader::addExercise(const Exercise& exercise) {
+    addExercises({&exercise});
+}
+
+void BatchGrader::addExercise(const std::string& exerciseId, const std::vector<TestCase>& testCases) {
+    exercises[exerciseId] = BatchExercise{testCases, CheckerSpec(), AllocationLimits()};
+}
+
+size_t BatchGrader::addExercises(const std::vector<const Exercise*>& candidates) {
+    // Their tests are conversations with an interactor, not input and output
+    std::vector<const Exercise*> gradable;
+    for (const Exercise* exercise : candidates) {
+        if (exercise->getInteractiveSpec().enabled) {
+            std::cerr << "✗ Skipping exercise " << exercise->getId() 
+                      << ": interactive exercises can't be batch graded" << std::endl;
+        } else {
+            gradable.push_back(exercise);
+        }
+    }
+
+    ReferenceOutputCache& cache = runner.getReferenceCache();
+    cache.warmUp(gradable, workerCount);
+
+    size_t added = 0;
+    for (const Exercise* exercise : gradable) {
+        std::vector<TestCase> testCases;
+        std::string errorMessage;
+        if (!cache.resolveTestCases(*exercise, testCases, errorMessage)) {
+            std::cerr << "✗ Skipping exercise " << exercise->getId() << ": " 
+                      << errorMessage << std::endl;
+            continue;
+        }
+        exercises[exercise->getId()] = BatchExercise{std::move(testCases), exercise->getCheckerSpec(),
+                                                     exercise->getAllocationLimits()};
+        added++;
+    }
+    return added;
+}
+
+bool BatchGrader::hasExercise(const std::string& exerciseId) const {
+    return exercises.find(exerciseId) != exercises.end();
+}
+
+BatchSummary BatchGrader::gradeAll(const std::vector<Submission>& submissions, std::ostream& output) {
+    BatchSummary summary;
+    summary.submissionCount = submissions.size();
+
+    CodeCompiler* compiler = runner.getCompiler();
+    GradingMemo* memo = runner.getGradingMemo();
+    std::mutex outputMutex;
+    std::vector<double> latencies;
+    latencies.reserve(submissions.size());
+    std::atomic<size_t> compiledCount{0};
+    std::atomic<size_t> fullyPassedCount{0};
+    std::atomic<size_t> testsRun{0};
+    std::atomic<size_t> testsReused{0};
+    std::atomic<size_t> memoLookups{0};
+    std::atomic<size_t> memoHits{0};
+
+    std::unique_ptr<ReportWriter> writer;
+    if (reportFormat == ReportFormat::JSON_LINES) {
+        writer = std::make_unique<JsonLinesReportWriter>(output);
+    } else if (reportFormat == ReportFormat::JUNIT_XML) {
+        writer = std::make_unique<JUnitReportWriter>(output);
+    } else {
+        output << "submission,exercise,status,passed,failed,errors,total,wall_seconds,cpu_seconds\n";
+    }
+
+    std::vector<std::unique_ptr<SubmissionState>> states;
+    states.reserve(submissions.size());
+    for (const Submission& submission : submissions) {
+        states.push_back(std::make_unique<SubmissionState>(submission));
+    }
+
+    auto finish = [&](SubmissionState& state) {
+        auto endTime = std::chrono::steady_clock::now();
+        double latency = std::chrono::duration<double>(endTime - state.startTime).count();
+        runner.updateSuiteStatistics(state.suite, latency);
+
+        bool hasTimeout = std::any_of(state.suite.results.begin(), state.suite.results.end(),
+            [](const TestResult& result) { return result.status == TestStatus::TIMEOUT; });
+        if (memo && !state.memoKey.empty() && !state.memoHit && !hasTimeout) {
+            memo->store(state.memoKey, state.suite);
+        }
+        if (memo && !state.submissionKey.empty()) {
+            memo->storeTests(state.submissionKey, *state.testCases, state.suite);
+        }
+
+        if (!state.executablePath.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(state.executablePath, ec);
+        }
+
+        std::string status = !state.errorMessage.empty() ? "error" :
+            (state.suite.passedCount == static_cast<int>(state.suite.results.size()) ? "passed" : "failed");
+        if (status == "passed") {
+            fullyPassedCount.fetch_add(1);
+        }
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        latencies.push_back(latency);
+        if (writer) {
+            writer->writeSuite(state.suite, state.submission->exerciseId);
+        } else {
+            std::ostringstream line;
+            line << csvField(state.submission->submissionId) << ','
+                 << csvField(state.submission->exerciseId) << ','
+                 << status << ','
+                 << state.suite.passedCount << ','
+                 << state.suite.failedCount << ','
+                 << state.suite.errorCount << ','
+                 << state.suite.results.size() << ','
+                 << std::fixed << std::setprecision(3) << latency << ','
+                 << state.suite.cpuTime << '\n';
+            output << line.str();
+            output.flush();
+        }
+        // The state is no longer needed; release its results right away
+        state.suite.results.clear();
+        state.suite.results.shrink_to_fit();
+    };
+
+    auto startTime = std::chrono::steady_clock::now();
+    WorkStealingPool pool(workerCount);
+
+    for (const auto& owned : states) {
+        SubmissionState* state = owned.get();
+
+        pool.submit([&, state]() {
+            state->startTime = std::chrono::steady_clock::now();
+
+            auto exercise = exercises.find(state->submission->exerciseId);
+            std::string source;
+            if (exercise == exercises.end()) {
+                state->errorMessage = "Unknown exercise";
+            } else if (!compiler) {
+                state->errorMessage = "No compiler available";
+            } else if (!readFile(state->submission->sourcePath, source)) {
+                state->errorMessage = "Cannot read source file";
+            }
+            if (!state->errorMessage.empty()) {
+                finish(*state);
+                return;
+            }
+
+            const BatchExercise* rules = &exercise->second;
+            state->testCases = &rules->testCases;
+            if (memo) {
+                std::string gradingProfile = runner.getGradingProfile(rules->allocationLimits, rules->checker);
+                memoLookups.fetch_add(1);
+                state->memoKey = GradingMemo::makeKey(source, rules->testCases, gradingProfile);
+                if (memo->lookup(state->memoKey, rules->testCases, state->suite)) {
+                    state->memoHit = true;
+                    memoHits.fetch_add(1);
+                    testsReused.fetch_add(state->suite.results.size());
+                    if (state->suite.compiled) {
+                        compiledCount.fetch_add(1);
+                    } else {
+                        state->errorMessage = "Compilation failed";
+                    }
+                    finish(*state);
+                    return;
+                }
+                state->submissionKey = GradingMemo::makeSubmissionKey(source, gradingProfile);
+            }
+
+            const std::vector<TestCase>& testCases = *state->testCases;
+            state->suite.results.reserve(testCases.size());
+            for (size_t i = 0; i < testCases.size(); ++i) {
+                state->suite.results.emplace_back(testCases[i].description.empty() ?
+                    ("Test " + std::to_string(i + 1)) : testCases[i].description);
+            }
+
+            // Tests unchanged since the last grading of this source are not run again
+            state->reused.assign(testCases.size(), false);
+            if (!state->submissionKey.empty()) {
+                state->reused = memo->reuseTests(state->submissionKey, testCases, state->suite);
+                state->suite.reusedCount = static_cast<int>(
+                    std::count(state->reused.begin(), state->reused.end(), true));
+                testsReused.fetch_add(static_cast<size_t>(state->suite.reusedCount));
+            }
+            size_t pending = testCases.size() - static_cast<size_t>(state->suite.reusedCount);
+            if (!testCases.empty() && pending == 0) {
+                compiledCount.fetch_add(1);
+                finish(*state);
+                return;
+            }
+
+            // Unique per build: other batches may share the temp directory
+            CompilationResult build = compiler->compileScratch(source, "batch");
+            std::error_code ec;
+
+            CompilationResult checkerBuild;
+            if (build.success && rules->checker.enabled) {
+                checkerBuild = runner.getCheckerBuild(rules->checker);
+            }
+            if (!build.success || (rules->checker.enabled && !checkerBuild.success)) {
+                std::string message = build.success ? "Checker failed to compile" : 
+                    build.rejected ? "Compilation failed" : "Build error: " + build.errorOutput;
+                for (TestResult& result : state->suite.results) {
+                    result = TestResult(result.testName);
+                    result.status = TestStatus::ERROR;
+                    result.errorMessage = message;
+                }
+                if (build.success) {
+                    compiledCount.fetch_add(1);
+                    std::filesystem::remove(build.executablePath, ec);
+                }
+                // Only the verdict on the code is remembered; a broken checker
+                // or toolchain is retried next time
+                if (!build.rejected) {
+                    state->memoKey.clear();
+                    state->submissionKey.clear();
+                }
+                state->errorMessage = message;
+                state->suite.compiled = build.success;
+                state->suite.reusedCount = 0;
+                finish(*state);
+                return;
+            }
+
+            compiledCount.fetch_add(1);
+            state->executablePath = build.executablePath;
+            state->checkerPath = checkerBuild.executablePath;
+            if (testCases.empty()) {
+                finish(*state);
+                return;
+            }
+
+            // Fan out: tests land on this worker's deque and get stolen by idle workers
+            state->remainingTests.store(pending);
+            for (size_t i = 0; i < testCases.size(); ++i) {
+                if (state->reused[i]) {
+                    continue;
+                }
+                pool.submit([&, state, i, rules]() {
+                    state->suite.results[i] = runner.runCompiledTest(
+                        state->executablePath, state->suite.results[i].testName,
+                        (*state->testCases)[i], rules->checker, state->checkerPath,
+                        rules->allocationLimits);
+                    testsRun.fetch_add(1);
+
+                    if (state->remainingTests.fetch_sub(1) == 1) {
+                        finish(*state);
+                    }
+                });
+            }
+        });
+    }
+
+    pool.wait();
+    if (writer) {
+        writer->finish();
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    summary.wallTime = std::chrono::duration<double>(endTime - startTime).count();
+    summary.throughput = summary.wallTime > 0.0 ? submissions.size() / summary.wallTime : 0.0;
+    summary.compiledCount = compiledCount.load();
+    summary.fullyPassedCount = fullyPassedCount.load();
+    summary.testsRun = testsRun.load();
+    summary.testsReused = testsReused.load();
+    summary.steals = pool.getStealCount();
+    summary.memoLookups = memoLookups.load();
+    summary.memoHits = memoHits.load();
+
+    std::sort(latencies.begin(), latencies.end());
+    summary.p50Latency = percentile(latencies, 0.50);
+    summary.p95Latency = percentile(latencies, 0.95);
+    summary.p99Latency = percentile(latencies, 0.99);
+    summary.maxLatency = latencies.empty() ? 0.0 : latencies.back();
+
+    return summary;
+}
+
+bool BatchGrader::loadManifest(const std::string& filename, std::vector<Submission>& submissions) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        Submission submission;
+        if (!(fields >> submission.submissionId >> submission.exerciseId)) {
+            return false;
+        }
+        // The path is the rest of the line so it may contain spaces
+        std::getline(fields >> std::ws, submission.sourcePath);
+        submission.sourcePath.erase(submission.sourcePath.find_last_not_of(" \t\r") + 1);
+        if (submission.sourcePath.empty()) {
+            return false;
+        }
+        submissions.push_back(submission);
+    }
+
+    return true;
+}
+
+size_t BatchGrader::loadExerciseDirectory(const std::string& directory) {
+    namespace fs = std::filesystem;
+    size_t loaded = 0;
+
+    std::vector<std::unique_ptr<Exercise>> referenceExercises;
+    // The directory's files may change while grading runs; copies kept in a
+    // fixture store next to the builds are mapped instead
+    CodeCompiler* compiler = runner.getCompiler();
+    FixtureStore fixtures((compiler ? compiler->getTempDirectory() : std::string("temp")) + "/fixtures");
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (!entry.is_directory()) {
+            continue;
+        }
+
+        // A solution.cpp makes the reference produce any missing .out files
+        std::string solutionCode;
+        bool hasSolution = readFile((entry.path() / "solution.cpp").string(), solutionCode);
+        std::string exerciseId = entry.path().filename().string();
+
+        std::vector<fs::path> inputs;
+        for (const auto& file : fs::directory_iterator(entry.path(), ec)) {
+            if (file.path().extension() == ".in") {
+                inputs.push_back(file.path());
+            }
+        }
+        std::sort(inputs.begin(), inputs.end());
+
+        std::vector<TestCase> testCases;
+        for (const fs::path& inputPath : inputs) {
+            fs::path outputPath = inputPath;
+            outputPath.replace_extension(".out");
+
+            // Mapped, not read: large fixtures are never copied into memory
+            SharedText input, expected;
+            if (!fixtures.import(inputPath.string(), input)) {
+                continue;
+            }
+            if (fixtures.import(outputPath.string(), expected)) {
+                testCases.emplace_back(input, expected, inputPath.stem().string());
+            } else if (hasSolution) {
+                testCases.push_back(TestCase::fromReference(input, inputPath.stem().string()));
+            } else {
+                continue;
+            }
+            // The file name identifies the test across edits of its contents
+            testCases.back().id = inputPath.stem().string();
+        }
+
+        if (hasSolution) {
+            auto exercise = std::make_unique<Exercise>(exerciseId, exerciseId, "", 
+                                                       ExerciseType::CODING, DifficultyLevel::BEGINNER);
+            exercise->setSolutionCode(solutionCode);
+            for (const TestCase& testCase : testCases) {
+                exercise->addTestCase(testCase);
+            }
+            referenceExercises.push_back(std::move(exercise));
+        } else {
+            addExercise(exerciseId, testCases);
+            loaded++;
+        }
+    }
+
+    std::vector<const Exercise*> pending;
+    for (const auto& exercise : referenceExercises) {
+        pending.push_back(exercise.get());
+    }
+    loaded += addExercises(pending);
+
+    return loaded;
+}
+
+std::string BatchGrader::formatSummary(const BatchSummary& summary) {
+    std::ostringstream report;
+
+    report << "Submissions: " << summary.submissionCount
+           << " (" << summary.compiledCount << " compiled, "
+           << summary.fullyPassedCount << " fully passed)\n";
+    report << "Tests Run: " << summary.testsRun << "\n";
+    if (summary.testsReused > 0) {
+        report << "Tests Reused: " << summary.testsReused << " (executions avoided)\n";
+    }
+    report << "Wall Time: " << std::fixed << std::setprecision(3) << summary.wallTime << "s\n";
+    report << "Throughput: " << std::fixed << std::setprecision(2)
+           << summary.throughput << " submissions/s\n";
+    report << "Latency p50/p95/p99/max: " << std::fixed << std::setprecision(3)
+           << summary.p50Latency << "s / " << summary.p95Latency << "s / "
+           << summary.p99Latency << "s / " << summary.maxLatency << "s\n";
+    report << "Steals: " << summary.steals << "\n";
+    if (summary.memoLookups > 0) {
+        report << "Memo Hits: " << summary.memoHits << " of " << summary.memoLookups << " ("
+               << std::fixed << std::setprecision(1)
+               << 100.0 * summary.memoHits / summary.memoLookups << "%)\n";
+    }
+
+    return report.str();
+}
+
+bool BatchGrader::readFile(const std::string& filename, std::string& contents) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+double BatchGrader::percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+
+    // Nearest-rank percentile
+    size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+    rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+    return sorted[rank - 1];
+}
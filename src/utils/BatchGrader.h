@@ -0,0 +1,96 @@
+#pragma once
+#include "TestRunner.h"
+#include "WorkStealingPool.h"
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class ReportFormat {
+    CSV,         // one summary line per submission
+    JSON_LINES,  // per-test and per-suite records
+    JUNIT_XML
+};
+
+struct Submission {
+    std::string submissionId;
+    std::string exerciseId;
+    std::string sourcePath;
+};
+
+struct BatchSummary {
+    size_t submissionCount;
+    size_t compiledCount;
+    size_t fullyPassedCount;
+    size_t testsRun;
+    size_t testsReused;     // results taken from the memo instead of running the test
+    double wallTime;        // seconds for the whole batch
+    double throughput;      // submissions per second
+    double p50Latency;      // per-submission compile + test latency, seconds
+    double p95Latency;
+    double p99Latency;
+    double maxLatency;
+    uint64_t steals;
+    size_t memoLookups;     // submissions checked against the grading memo
+    size_t memoHits;        // ... of which were answered without compiling
+
+    BatchSummary()
+        : submissionCount(0), compiledCount(0), fullyPassedCount(0), testsRun(0), testsReused(0),
+          wallTime(0.0), throughput(0.0), p50Latency(0.0), p95Latency(0.0),
+          p99Latency(0.0), maxLatency(0.0), steals(0), memoLookups(0), memoHits(0) {}
+};
+
+// Regrades many submissions at once. Every submission becomes a compile
+// task; a successful compile fans out one task per test case onto the same
+// worker, where idle workers can steal them. Results are streamed to the
+// output as each submission finishes. With a grading memo, a regrade after
+// test-set edits runs only the new or changed tests of each submission.
+class BatchGrader {
+private:
+    TestRunner runner;
+    unsigned int workerCount;
+    ReportFormat reportFormat;
+    // What a submission is graded against: the tests and the exercise's own
+    // judging rules
+    struct BatchExercise {
+        std::vector<TestCase> testCases;
+        CheckerSpec checker;
+        AllocationLimits allocationLimits;
+    };
+    std::map<std::string, BatchExercise> exercises;
+
+public:
+    explicit BatchGrader(unsigned int workers = 0); // 0 = one per hardware thread
+
+    // Configuration
+    void setCompiler(std::unique_ptr<CodeCompiler> compiler);
+    void setReportFormat(ReportFormat format);
+    void setReferenceCache(std::shared_ptr<ReferenceOutputCache> cache);
+    void setGradingMemo(std::shared_ptr<GradingMemo> memo);
+    void setInstructionLimit(uint64_t instructions); // see TestRunner::setInstructionLimit
+    // Checkers and allocation limits apply as in TestRunner::runExerciseTests.
+    // Interactive exercises can't be batch graded and are refused.
+    void addExercise(const Exercise& exercise);
+    void addExercise(const std::string& exerciseId, const std::vector<TestCase>& testCases);
+    // Generates reference outputs for all exercises in parallel before adding
+    // them; returns the number of exercises that were added
+    size_t addExercises(const std::vector<const Exercise*>& exercises);
+    bool hasExercise(const std::string& exerciseId) const;
+
+    // Grading; streams each submission's results to output as it finishes
+    BatchSummary gradeAll(const std::vector<Submission>& submissions, std::ostream& output);
+
+    // Input formats
+    // Manifest: one "<submissionId> <exerciseId> <sourcePath>" per line, '#' comments
+    static bool loadManifest(const std::string& filename, std::vector<Submission>& submissions);
+    // Exercise directory: <directory>/<exerciseId>/<name>.in with matching <name>.out.
+    // Copies of the files are mapped (see FixtureStore::import), so the
+    // originals may be edited while grading runs.
+    size_t loadExerciseDirectory(const std::string& directory);
+
+    static std::string formatSummary(const BatchSummary& summary);
+
+private:
+    static bool readFile(const std::string& filename, std::string& contents);
+    static double percentile(const std::vector<double>& sorted, double fraction);
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Growable set of dense positions, one bit each. Secondary indexes keep one
+// bitmap per key value so that filters combine a word (64 positions) at a
+// time.
+class Bitmap {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    static constexpr size_t WORD_BITS = 64;
+
+    // Makes room for positions below size; new positions are clear
+    void resize(size_t size) { words.resize((size + WORD_BITS - 1) / WORD_BITS, 0); }
+
+    void set(size_t position, bool value = true) {
+        uint64_t mask = uint64_t(1) << (position % WORD_BITS);
+        if (value) {
+            words[position / WORD_BITS] |= mask;
+        } else {
+            words[position / WORD_BITS] &= ~mask;
+        }
+    }
+
+    bool test(size_t position) const {
+        return (word(position / WORD_BITS) >> (position % WORD_BITS)) & 1;
+    }
+
+    size_t wordCount() const { return words.size(); }
+    uint64_t word(size_t index) const { return index < words.size() ? words[index] : 0; }
+
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t bits : words) {
+            total += popcount(bits);
+        }
+        return total;
+    }
+
+    static size_t popcount(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_popcountll(bits));
+#else
+        size_t total = 0;
+        for (; bits; bits &= bits - 1) {
+            total++;
+        }
+        return total;
+#endif
+    }
+
+    // Index of the lowest set bit; bits must not be 0
+    static size_t lowestBit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_ctzll(bits));
+#else
+        size_t index = 0;
+        for (; !(bits & 1); bits >>= 1) {
+            index++;
+        }
+        return index;
+#endif
+    }
+};
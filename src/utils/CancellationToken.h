@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+// Cancel switch for a unit of grading work, e.g. one submission that a newer
+// resubmission supersedes. Copies share the switch, cancel() is sticky and
+// may be called from any thread. A child token is cancelled together with
+// its parent but can also be cancelled on its own (fail-fast uses one to
+// stop a single suite without touching the caller's token).
+class CancellationToken {
+private:
+    struct State {
+        std::atomic<bool> cancelled;
+        std::shared_ptr<const State> parent;
+
+        explicit State(std::shared_ptr<const State> parent = nullptr)
+            : cancelled(false), parent(std::move(parent)) {}
+    };
+
+    std::shared_ptr<State> state;
+
+    explicit CancellationToken(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+public:
+    CancellationToken() : state(std::make_shared<State>()) {}
+
+    // A token that is never cancelled; costs nothing to check
+    static const CancellationToken& none() {
+        static const CancellationToken never{std::shared_ptr<State>()};
+        return never;
+    }
+
+    CancellationToken child() const { return CancellationToken(std::make_shared<State>(state)); }
+
+    void cancel() const {
+        if (state) {
+            state->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    bool isCancelled() const {
+        for (const State* current = state.get(); current; current = current->parent.get()) {
+            if (current->cancelled.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // False for none(): work can skip polling entirely
+    bool canBeCancelled() const { return state != nullptr; }
+};
@@ -1,28 +1,348 @@
 #include "CodeCompiler.h"
+#include "OutputComparator.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <string_view>
 #include <cstdlib>
 #include <filesystem>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <process.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+extern char** environ;
+#endif
+
+namespace {
+    // "<field> <value>" lines written by the allocation shim at exit
+    bool readAllocationReport(const std::string& path, AllocationStats& stats) {
+        std::ifstream report(path);
+        std::string field;
+        uint64_t value = 0;
+        int fields = 0;
+        while (report >> field >> value) {
+            if (field == "allocations") stats.allocations = value;
+            else if (field == "frees") stats.frees = value;
+            else if (field == "reallocations") stats.reallocations = value;
+            else if (field == "bytes_allocated") stats.bytesAllocated = value;
+            else if (field == "peak_live_bytes") stats.peakLiveBytes = value;
+            else if (field == "leaked_allocations") stats.leakedAllocations = value;
+            else if (field == "leaked_bytes") stats.leakedBytes = value;
+            else continue;
+            fields++;
+        }
+        stats.available = fields > 0;
+        return stats.available;
+    }
+}
+
+#ifndef _WIN32
+namespace {
+    // The inherited environment with "NAME=value" overrides replacing or
+    // adding variables; the strings stay owned by overrides. Empty when there
+    // is nothing to override, which means "inherit unchanged".
+    std::vector<char*> buildEnvironment(const std::vector<std::string>& overrides) {
+        std::vector<char*> envp;
+        if (overrides.empty()) {
+            return envp;
+        }
+        for (char** entry = environ; *entry; ++entry) {
+            std::string_view variable(*entry);
+            std::string_view name = variable.substr(0, variable.find('=') + 1);
+            bool replaced = std::any_of(overrides.begin(), overrides.end(),
+                [name](const std::string& added) { return added.compare(0, name.size(), name) == 0; });
+            if (!replaced) {
+                envp.push_back(*entry);
+            }
+        }
+        for (const std::string& added : overrides) {
+            envp.push_back(const_cast<char*>(added.c_str()));
+        }
+        envp.push_back(nullptr);
+        return envp;
+    }
+    
+    // Children lead their own process group, so anything they fork is
+    // killed along with them
+    void killGroup(pid_t pid) {
+        if (kill(-pid, SIGKILL) != 0) {
+            kill(pid, SIGKILL);
+        }
+    }
+    
+    // fork + exec with the given descriptors as stdin, stdout and stderr
+    // (-1 = /dev/null) and `inherited` placed at descriptors 3, 4, ...
+    // Only async-signal-safe calls happen after fork().
+    pid_t spawnChild(char* const argv[], const std::vector<char*>& envp, 
+                     int inFd, int outFd, int errFd, 
+                     const std::vector<int>& inherited = std::vector<int>()) {
+        pid_t pid = fork();
+        if (pid > 0) {
+            setpgid(pid, pid); // also in the child: whichever runs first wins the race
+        }
+        if (pid != 0) {
+            return pid;
+        }
+        setpgid(0, 0);
+        // Move them clear of the target slots first so none is overwritten;
+        // the temporary copies close themselves at exec
+        const int firstSlot = STDERR_FILENO + 1;
+        const int clearOf = firstSlot + static_cast<int>(inherited.size());
+        int moved[16];
+        size_t count = std::min(inherited.size(), sizeof(moved) / sizeof(moved[0]));
+        for (size_t i = 0; i < count; ++i) {
+            moved[i] = fcntl(inherited[i], F_DUPFD_CLOEXEC, clearOf);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            dup2(moved[i], firstSlot + static_cast<int>(i)); // dup2 clears FD_CLOEXEC
+        }
+        int devNull = open("/dev/null", O_RDWR);
+        dup2(inFd >= 0 ? inFd : devNull, STDIN_FILENO);
+        dup2(outFd >= 0 ? outFd : devNull, STDOUT_FILENO);
+        dup2(errFd >= 0 ? errFd : devNull, STDERR_FILENO);
+        if (envp.empty()) {
+            execv(argv[0], argv);
+        } else {
+            execve(argv[0], argv, envp.data());
+        }
+        _exit(127);
+    }
+    
+    // Waits for the child until the deadline, then kills it. Returns false
+    // if it had to be killed.
+    bool reapBefore(pid_t pid, std::chrono::steady_clock::time_point deadline, 
+                    int& status, struct rusage& usage) {
+        for (;;) {
+            pid_t done = wait4(pid, &status, WNOHANG, &usage);
+            if (done == pid || (done < 0 && errno != EINTR)) {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                killGroup(pid);
+                while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {
+                }
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    
+    // An anonymous in-memory file holding contents, rewound and close-on-exec
+    // (so concurrently spawned programs never see it). Falls back to an
+    // unlinked scratch file where memfd_create is missing.
+    int openMemoryFile(const char* name, std::string_view contents, 
+                       const std::string& scratchDirectory) {
+        int fd = -1;
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+        fd = memfd_create(name, MFD_CLOEXEC);
+#endif
+        if (fd < 0) {
+            std::string path = scratchDirectory + "/" + name + "." + std::to_string(getpid()) + 
+                "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+            fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (fd >= 0) {
+                unlink(path.c_str());
+            }
+        }
+        if (fd < 0) {
+            return -1;
+        }
+        const char* next = contents.data();
+        size_t left = contents.size();
+        while (left > 0) {
+            ssize_t written = write(fd, next, left);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                close(fd);
+                return -1;
+            }
+            next += written;
+            left -= static_cast<size_t>(written);
+        }
+        lseek(fd, 0, SEEK_SET);
+        return fd;
+    }
+    
+    std::string formatSeconds(double value) {
+        std::ostringstream text;
+        text << value << "s";
+        return text.str();
+    }
+    
+    std::string readScratchFile(int fd, size_t limit) {
+        std::string contents;
+        char buffer[4096];
+        lseek(fd, 0, SEEK_SET);
+        while (contents.size() < limit) {
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            if (count > 0) {
+                contents.append(buffer, static_cast<size_t>(count));
+            } else if (count == 0 || errno != EINTR) {
+                break;
+            }
+        }
+        if (contents.size() > limit) {
+            contents.resize(limit);
+        }
+        return contents;
+    }
+}
+#endif
+
+#ifdef __linux__
+namespace {
+    // perf_event counters attached to one child. They are opened while the
+    // child waits before exec and enabled by the exec itself, so the fork
+    // and setup work done on the grader's behalf is not counted.
+    class ChildCounters {
+    public:
+        enum Counter { INSTRUCTIONS, CYCLES, CACHE_MISSES, BRANCH_MISSES, COUNT };
+        
+        explicit ChildCounters(pid_t pid) {
+            static const uint64_t events[COUNT] = {
+                PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+            };
+            for (int i = 0; i < COUNT; ++i) {
+                fds[i] = open(pid, events[i]);
+            }
+        }
+        
+        ~ChildCounters() {
+            for (int fd : fds) {
+                if (fd >= 0) close(fd);
+            }
+        }
+        
+        ChildCounters(const ChildCounters&) = delete;
+        ChildCounters& operator=(const ChildCounters&) = delete;
+        
+        bool isOpen(Counter counter) const { return fds[counter] >= 0; }
+        
+        // Scaled up when the kernel had to multiplex the PMU between events
+        int64_t read(Counter counter) const {
+            struct { uint64_t value, enabled, running; } sample {};
+            if (fds[counter] < 0 || ::read(fds[counter], &sample, sizeof(sample)) != sizeof(sample)) {
+                return -1;
+            }
+            if (sample.running == 0 || sample.running >= sample.enabled) {
+                return static_cast<int64_t>(sample.value);
+            }
+            return static_cast<int64_t>(static_cast<long double>(sample.value) * 
+                                        sample.enabled / sample.running);
+        }
+        
+        void readAll(HardwareCounters& counters) const {
+            counters.instructions = read(INSTRUCTIONS);
+            counters.cycles = read(CYCLES);
+            counters.cacheMisses = read(CACHE_MISSES);
+            counters.branchMisses = read(BRANCH_MISSES);
+        }
+        
+        static int open(pid_t pid, uint64_t event) {
+            struct perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = event;
+            attr.disabled = 1;
+            attr.enable_on_exec = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, -1, 
+                                            PERF_FLAG_FD_CLOEXEC));
+        }
+        
+    private:
+        int fds[COUNT];
+    };
+}
 #endif
 
 CodeCompiler::CodeCompiler(CompilerType compiler) 
-    : compiler(compiler), tempDirectory("temp") {
+    : compiler(compiler), tempDirectory("temp"), captureDiagnostics(false), collectCounters(false),
+      instructionLimit(0), trackAllocations(false) {
+#ifdef CURRICULUM_ALLOC_SHIM_PATH
+    allocationShimPath = CURRICULUM_ALLOC_SHIM_PATH;
+#endif
     initializeCompiler();
     
     // Create temp directory if it doesn't exist
     std::filesystem::create_directories(tempDirectory);
 }
 
+void CodeCompiler::setEnvironmentVariable(const std::string& name, const std::string& value) {
+    std::string prefix = name + "=";
+    environment.erase(std::remove_if(environment.begin(), environment.end(),
+        [&prefix](const std::string& entry) { return entry.compare(0, prefix.size(), prefix) == 0; }),
+        environment.end());
+    environment.push_back(prefix + value);
+}
+
+void CodeCompiler::setCaptureDiagnostics(bool capture) {
+    this->captureDiagnostics = capture;
+}
+
+void CodeCompiler::setCollectCounters(bool collect) {
+    this->collectCounters = collect;
+}
+
+void CodeCompiler::setInstructionLimit(uint64_t instructions) {
+    this->instructionLimit = instructions;
+}
+
+bool CodeCompiler::areCountersAvailable() {
+#ifdef __linux__
+    static const bool available = []() {
+        int fd = ChildCounters::open(0, PERF_COUNT_HW_INSTRUCTIONS);
+        if (fd < 0) {
+            return false;
+        }
+        close(fd);
+        return true;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+void CodeCompiler::setTrackAllocations(bool track) {
+    this->trackAllocations = track;
+}
+
+void CodeCompiler::setAllocationShimPath(const std::string& path) {
+    this->allocationShimPath = path;
+}
+
+bool CodeCompiler::canTrackAllocations() const {
+    std::error_code ec;
+    return !allocationShimPath.empty() && std::filesystem::exists(allocationShimPath, ec);
+}
+
 void CodeCompiler::setCompiler(CompilerType compiler) {
     this->compiler = compiler;
     initializeCompiler();
@@ -42,9 +362,16 @@ void CodeCompiler::setTempDirectory(const std::string& directory) {
 }
 
 CompilationResult CodeCompiler::compileCode(const std::string& sourceCode, 
-                                           const std::string& filename) {
+                                           const std::string& filename,
+                                           const CancellationToken& cancel) {
     CompilationResult result;
     
+    if (cancel.isCancelled()) {
+        result.cancelled = true;
+        result.errorOutput = "Cancelled";
+        return result;
+    }
+    
     if (!isCompilerAvailable()) {
         result.errorOutput = "Compiler not available";
         return result;
@@ -57,10 +384,27 @@ CompilationResult CodeCompiler::compileCode(const std::string& sourceCode,
         return result;
     }
     
-    return compileFile(sourceFile);
+    return compileFile(sourceFile, cancel);
+}
+
+CompilationResult CodeCompiler::compileScratch(const std::string& sourceCode, const std::string& stem,
+                                               const CancellationToken& cancel) {
+    static std::atomic<unsigned long> buildSequence{0};
+#ifdef _WIN32
+    unsigned long processId = static_cast<unsigned long>(_getpid());
+#else
+    unsigned long processId = static_cast<unsigned long>(getpid());
+#endif
+    std::string sourceName = stem + "_" + std::to_string(processId) + "_" + 
+                             std::to_string(buildSequence.fetch_add(1)) + ".cpp";
+    CompilationResult build = compileCode(sourceCode, sourceName, cancel);
+    std::error_code ec;
+    std::filesystem::remove(tempDirectory + "/" + sourceName, ec);
+    return build;
 }
 
-CompilationResult CodeCompiler::compileFile(const std::string& sourceFile) {
+CompilationResult CodeCompiler::compileFile(const std::string& sourceFile, 
+                                           const CancellationToken& cancel) {
     CompilationResult result;
     
     if (!std::filesystem::exists(sourceFile)) {
@@ -76,21 +420,31 @@ CompilationResult CodeCompiler::compileFile(const std::string& sourceFile) {
     outputFile += ".exe";
 #endif
     
+    // A stale executable from an earlier build must not count as success
+    std::error_code ec;
+    std::filesystem::remove(outputFile, ec);
+    
     // Build compile command
     std::string command = buildCompileCommand(sourceFile, outputFile);
     
     // Execute compilation
-    std::string output = executeCommand(command);
+    int exitCode = -1;
+    std::string output = runCommand(command, cancel, result.cancelled, exitCode);
     
     // Check if compilation was successful
-    if (std::filesystem::exists(outputFile)) {
+    if (result.cancelled) {
+        std::filesystem::remove(outputFile, ec);
+        result.errorOutput = "Cancelled";
+    } else if (std::filesystem::exists(outputFile)) {
         result.success = true;
         result.executablePath = outputFile;
         result.exitCode = 0;
     } else {
         result.success = false;
         result.errorOutput = output;
-        result.exitCode = 1;
+        result.exitCode = exitCode;
+        // 126 and 127 come from the shell: the compiler could not be started
+        result.rejected = exitCode > 0 && exitCode < 126;
     }
     
     return result;
@@ -112,7 +466,9 @@ ExecutionResult CodeCompiler::executeCode(const std::string& sourceCode,
 }
 
 ExecutionResult CodeCompiler::executeFile(const std::string& executablePath, 
-                                         const std::string& input) {
+                                         const std::string& input,
+                                         const CancellationToken& cancel,
+                                         double timeLimitSeconds) {
     ExecutionResult result;
     
     if (!std::filesystem::exists(executablePath)) {
@@ -120,32 +476,389 @@ ExecutionResult CodeCompiler::executeFile(const std::string& executablePath,
         return result;
     }
     
-    auto startTime = std::chrono::high_resolution_clock::now();
-    
-    // Create command with input redirection if needed
-    std::string command = executablePath;
+    // Each run gets its own input file so concurrent executions don't clash
+    std::string inputFile;
     if (!input.empty()) {
-        // Write input to temporary file
-        std::string inputFile = tempDirectory + "/input.txt";
-        std::ofstream inFile(inputFile);
+        inputFile = tempDirectory + "/" + generateTempFilename(".in");
+        std::ofstream inFile(inputFile, std::ios::binary);
         inFile << input;
         inFile.close();
-        
-        command += " < " + inputFile;
     }
     
+    result = executeWithStdin(executablePath, inputFile, cancel, timeLimitSeconds);
+    
+    if (!inputFile.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(inputFile, ec);
+    }
+    
+    return result;
+}
+
+ExecutionResult CodeCompiler::executeWithInput(const std::string& executablePath, 
+                                               const SharedText& input,
+                                               const CancellationToken& cancel,
+                                               double timeLimitSeconds) {
+    if (input.filePath().empty()) {
+        return executeFile(executablePath, input.str(), cancel, timeLimitSeconds);
+    }
+    
+    if (!std::filesystem::exists(executablePath)) {
+        ExecutionResult result;
+        result.errorOutput = "Executable not found: " + executablePath;
+        return result;
+    }
+    return executeWithStdin(executablePath, input.filePath(), cancel, timeLimitSeconds);
+}
+
+ExecutionResult CodeCompiler::executeWithStdin(const std::string& executablePath, 
+                                               const std::string& inputFile,
+                                               const CancellationToken& cancel,
+                                               double timeLimitSeconds) {
+    ExecutionResult result;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
     // Execute the program
-    std::string output = executeCommand(command);
+    runProcess(executablePath, inputFile, result, cancel, timeLimitSeconds);
     
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
     
-    result.success = true;
-    result.output = output;
     result.executionTime = duration.count() / 1000000.0; // Convert to seconds
-    result.exitCode = 0;
+    return result;
+}
+
+InteractionResult CodeCompiler::executeInteractive(const std::string& executablePath,
+                                                   const std::string& interactorPath,
+                                                   const std::string& testData,
+                                                   const InteractionLimits& limits,
+                                                   const CancellationToken& cancel) {
+    InteractionResult result;
+#ifdef _WIN32
+    result.message = "Interactive mode is not supported on this platform";
+    return result;
+#else
+    if (!std::filesystem::exists(executablePath) || !std::filesystem::exists(interactorPath)) {
+        result.message = "Executable not found";
+        return result;
+    }
+    
+    std::string dataFile = tempDirectory + "/" + generateTempFilename(".in");
+    {
+        std::ofstream data(dataFile, std::ios::binary);
+        data << testData;
+    }
+    auto openScratch = [this]() {
+        std::string path = tempDirectory + "/" + generateTempFilename(".err");
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd >= 0) {
+            unlink(path.c_str());
+        }
+        return fd;
+    };
+    int interactorErr = openScratch();
+    int programErr = captureDiagnostics ? openScratch() : -1;
+    
+    // Each child gets one end of a socket pair as both stdin and stdout; the
+    // grader relays between the other ends. Sockets (unlike pipes) let the
+    // relay write with MSG_NOSIGNAL, so a side that quits early can't SIGPIPE us.
+    int programLink[2] = {-1, -1};
+    int interactorLink[2] = {-1, -1};
+    std::vector<char*> envp = buildEnvironment(environment);
+    std::string programArg = executablePath;
+    std::string interactorArg = interactorPath;
+    char* const programArgv[] = {&programArg[0], nullptr};
+    char* const interactorArgv[] = {&interactorArg[0], &dataFile[0], nullptr};
+    
+    pid_t program = -1;
+    pid_t interactor = -1;
+    auto startTime = std::chrono::steady_clock::now();
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, programLink) == 0 &&
+        socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, interactorLink) == 0) {
+        interactor = spawnChild(interactorArgv, std::vector<char*>(), interactorLink[1], 
+                                interactorLink[1], interactorErr);
+        if (interactor > 0) {
+            program = spawnChild(programArgv, envp, programLink[1], programLink[1], programErr);
+        }
+    }
+    for (int* link : {programLink, interactorLink}) {
+        if (link[1] >= 0) close(link[1]);
+    }
+    
+    if (program <= 0) {
+        if (interactor > 0) {
+            killGroup(interactor);
+            waitpid(interactor, nullptr, 0);
+        }
+        for (int fd : {programLink[0], interactorLink[0], interactorErr, programErr}) {
+            if (fd >= 0) close(fd);
+        }
+        std::error_code ec;
+        std::filesystem::remove(dataFile, ec);
+        result.message = "Failed to start process";
+        return result;
+    }
+    
+    // Side i's messages are delivered to side 1 - i
+    struct Side {
+        int fd;
+        bool readable;
+        std::string pending;  // waiting to be delivered to this side
+        size_t delivered;
+        bool peerClosed;      // shut down our write end once pending is delivered
+        std::string* transcript;
+    };
+    Side sides[2] = {
+        {programLink[0], true, std::string(), 0, false, &result.programTranscript},
+        {interactorLink[0], true, std::string(), 0, false, &result.interactorTranscript}
+    };
+    for (const Side& side : sides) {
+        fcntl(side.fd, F_SETFL, fcntl(side.fd, F_GETFL) | O_NONBLOCK);
+    }
+    
+    auto deliver = [](Side& side) {
+        while (side.delivered < side.pending.size()) {
+            ssize_t count = send(side.fd, side.pending.data() + side.delivered, 
+                                 side.pending.size() - side.delivered, MSG_NOSIGNAL);
+            if (count > 0) {
+                side.delivered += static_cast<size_t>(count);
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            } else {
+                side.delivered = side.pending.size(); // receiver is gone
+            }
+        }
+        side.pending.clear();
+        side.delivered = 0;
+        if (side.peerClosed) {
+            shutdown(side.fd, SHUT_WR);
+        }
+    };
+    
+    using Clock = std::chrono::steady_clock;
+    auto deadline = startTime + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(limits.totalSeconds));
+    auto idleLimit = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(limits.idleSeconds));
+    auto lastMessage = startTime;
+    int lastSpeaker = -1;
+    bool timedOut = false;
+    bool idle = false;
+    bool cancelled = false;
+    char buffer[65536];
+    
+    while (sides[0].readable || sides[1].readable) {
+        auto now = Clock::now();
+        if (cancel.isCancelled()) {
+            cancelled = true;
+            break;
+        }
+        if (now >= deadline) {
+            timedOut = true;
+            break;
+        }
+        if (now - lastMessage >= idleLimit) {
+            idle = true;
+            break;
+        }
+        
+        struct pollfd watched[2];
+        for (int i = 0; i < 2; ++i) {
+            watched[i].fd = sides[i].fd;
+            watched[i].events = static_cast<short>((sides[i].readable ? POLLIN : 0) | 
+                                                   (sides[i].pending.empty() ? 0 : POLLOUT));
+            watched[i].revents = 0;
+        }
+        auto wait = std::min(deadline, lastMessage + idleLimit) - now;
+        int waitMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(wait).count()) + 1;
+        if (cancel.canBeCancelled()) {
+            waitMs = std::min(waitMs, 10);
+        }
+        int ready = poll(watched, 2, waitMs);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        
+        for (int i = 0; i < 2; ++i) {
+            Side& side = sides[i];
+            Side& peer = sides[1 - i];
+            if (watched[i].revents & POLLOUT) {
+                deliver(side);
+            }
+            if (!(watched[i].revents & (POLLIN | POLLHUP | POLLERR)) || !side.readable) {
+                continue;
+            }
+            
+            ssize_t count = recv(side.fd, buffer, sizeof(buffer), 0);
+            if (count > 0) {
+                // Forward right away: round-trip latency is what bounds rounds per test
+                peer.pending.append(buffer, static_cast<size_t>(count));
+                deliver(peer);
+                if (side.transcript->size() < limits.transcriptLimit) {
+                    side.transcript->append(buffer, std::min(static_cast<size_t>(count), 
+                        limits.transcriptLimit - side.transcript->size()));
+                }
+                if (lastSpeaker != i) {
+                    result.exchanges += lastSpeaker >= 0 ? 1 : 0;
+                    lastSpeaker = i;
+                }
+                lastMessage = Clock::now();
+            } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                side.readable = false;
+                peer.peerClosed = true;
+                if (peer.pending.empty()) {
+                    shutdown(peer.fd, SHUT_WR);
+                }
+            }
+        }
+    }
+    
+    // Both sides are done talking; give them until the deadline to exit
+    auto reapDeadline = (timedOut || idle || cancelled) ? Clock::now() : deadline;
+    int programStatus = 0;
+    int interactorStatus = 0;
+    struct rusage programUsage {};
+    struct rusage interactorUsage {};
+    bool programExited = reapBefore(program, reapDeadline, programStatus, programUsage);
+    bool interactorExited = reapBefore(interactor, reapDeadline, interactorStatus, interactorUsage);
+    timedOut = timedOut || !programExited || !interactorExited;
+    auto endTime = Clock::now();
+    
+    ExecutionResult& run = result.program;
+    run.executionTime = std::chrono::duration<double>(endTime - startTime).count();
+    run.cpuTime = programUsage.ru_utime.tv_sec + programUsage.ru_utime.tv_usec / 1000000.0 +
+                  programUsage.ru_stime.tv_sec + programUsage.ru_stime.tv_usec / 1000000.0;
+    run.peakMemoryKb = programUsage.ru_maxrss;
+    if (WIFSIGNALED(programStatus)) {
+        run.exitCode = 128 + WTERMSIG(programStatus);
+        run.errorOutput = "Terminated by signal " + std::to_string(WTERMSIG(programStatus));
+    } else {
+        run.exitCode = WIFEXITED(programStatus) ? WEXITSTATUS(programStatus) : -1;
+        run.success = true;
+    }
+    if (programErr >= 0) {
+        run.diagnostics = readScratchFile(programErr, std::string::npos);
+    }
+    result.interactorExitCode = WIFEXITED(interactorStatus) ? WEXITSTATUS(interactorStatus) : -1;
+    result.message = readScratchFile(interactorErr, limits.transcriptLimit);
+    while (!result.message.empty() && std::isspace(static_cast<unsigned char>(result.message.back()))) {
+        result.message.pop_back();
+    }
+    
+    if (cancelled) {
+        result.verdict = InteractionVerdict::CANCELLED;
+        result.message = "Cancelled";
+        run.aborted = true;
+    } else if (idle) {
+        result.verdict = InteractionVerdict::IDLE_TIMEOUT;
+        result.message = "No message for " + formatSeconds(limits.idleSeconds) + 
+                         " (is the output flushed after each line?)";
+    } else if (timedOut) {
+        result.verdict = InteractionVerdict::TIMEOUT;
+        result.message = "Interaction exceeded " + formatSeconds(limits.totalSeconds);
+    } else if (result.interactorExitCode == 1 || result.interactorExitCode == 2) {
+        // Checked before the program's status: a rejected program often dies of the closed pipe
+        result.verdict = InteractionVerdict::WRONG_ANSWER;
+    } else if (result.interactorExitCode != 0) {
+        result.verdict = InteractionVerdict::JUDGE_ERROR;
+        result.message = "Interactor failed (exit code " + std::to_string(result.interactorExitCode) + 
+                         ")" + (result.message.empty() ? "" : ": " + result.message);
+    } else if (!run.success || run.exitCode != 0) {
+        result.verdict = InteractionVerdict::RUNTIME_ERROR;
+        result.message = run.success ? "Exited with code " + std::to_string(run.exitCode) : 
+                                       run.errorOutput;
+    } else {
+        result.verdict = InteractionVerdict::ACCEPTED;
+    }
+    
+    for (int fd : {programLink[0], interactorLink[0], interactorErr, programErr}) {
+        if (fd >= 0) close(fd);
+    }
+    std::error_code ec;
+    std::filesystem::remove(dataFile, ec);
+    return result;
+#endif
+}
+
+CheckResult CodeCompiler::runChecker(const std::string& checkerPath, std::string_view input,
+                                     std::string_view expectedOutput, 
+                                     std::string_view actualOutput, double timeoutSeconds) {
+    CheckResult result;
+#ifdef _WIN32
+    result.message = "Checkers are not supported on this platform";
+    return result;
+#else
+    auto startTime = std::chrono::steady_clock::now();
+    int files[] = {
+        openMemoryFile("input", input, tempDirectory),
+        openMemoryFile("expected", expectedOutput, tempDirectory),
+        openMemoryFile("output", actualOutput, tempDirectory),
+        openMemoryFile("checker-stdout", "", tempDirectory),
+        openMemoryFile("checker-stderr", "", tempDirectory)
+    };
+    auto closeFiles = [&files]() {
+        for (int fd : files) {
+            if (fd >= 0) close(fd);
+        }
+    };
+    if (std::any_of(std::begin(files), std::end(files), [](int fd) { return fd < 0; })) {
+        closeFiles();
+        result.message = "Failed to create checker streams";
+        return result;
+    }
     
+    // The streams land on descriptors 3-5 of the checker
+    std::string checkerArg = checkerPath;
+    std::string inputArg = "/dev/fd/3";
+    std::string expectedArg = "/dev/fd/4";
+    std::string outputArg = "/dev/fd/5";
+    char* const argv[] = {&checkerArg[0], &inputArg[0], &expectedArg[0], &outputArg[0], nullptr};
+    pid_t pid = spawnChild(argv, std::vector<char*>(), -1, files[3], files[4], 
+                           {files[0], files[1], files[2]});
+    if (pid < 0) {
+        closeFiles();
+        result.message = "Failed to start checker";
+        return result;
+    }
+    
+    int status = 0;
+    struct rusage usage {};
+    auto deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(timeoutSeconds));
+    bool finished = reapBefore(pid, deadline, status, usage);
+    std::string verdictText = readScratchFile(files[3], 256);
+    result.message = readScratchFile(files[4], 4096);
+    closeFiles();
+    while (!result.message.empty() && std::isspace(static_cast<unsigned char>(result.message.back()))) {
+        result.message.pop_back();
+    }
+    
+    int exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    if (!finished) {
+        result.message = "Checker exceeded " + formatSeconds(timeoutSeconds);
+    } else if (exitCode == 0 || exitCode == 1 || exitCode == 2) {
+        result.judgeError = false;
+        result.accepted = exitCode == 0;
+        result.score = result.accepted ? 1.0 : 0.0;
+        std::istringstream printed(verdictText);
+        double score = 0.0;
+        if (printed >> score) {
+            result.score = std::max(0.0, std::min(1.0, score));
+        }
+    } else {
+        result.message = "Checker failed (" + (WIFSIGNALED(status) ? 
+            "signal " + std::to_string(WTERMSIG(status)) : "exit code " + std::to_string(exitCode)) + 
+            ")" + (result.message.empty() ? "" : ": " + result.message);
+    }
+    result.overheadSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - startTime).count();
     return result;
+#endif
 }
 
 bool CodeCompiler::testCode(const std::string& sourceCode, 
@@ -171,15 +884,7 @@ std::vector<bool> CodeCompiler::runTestCases(const std::string& sourceCode,
         ExecutionResult execResult = executeFile(compileResult.executablePath, testCase.first);
         
         if (execResult.success) {
-            // Simple string comparison (could be enhanced with better matching)
-            std::string expectedOutput = testCase.second;
-            std::string actualOutput = execResult.output;
-            
-            // Trim whitespace for comparison
-            expectedOutput.erase(expectedOutput.find_last_not_of(" \n\r\t") + 1);
-            actualOutput.erase(actualOutput.find_last_not_of(" \n\r\t") + 1);
-            
-            results.push_back(expectedOutput == actualOutput);
+            results.push_back(OutputComparator::matches(testCase.second, execResult.output));
         } else {
             results.push_back(false);
         }
@@ -217,6 +922,14 @@ std::string CodeCompiler::getCompilerVersion() const {
     return output;
 }
 
+std::string CodeCompiler::getProfile() const {
+    std::string profile = compilerPath;
+    for (const std::string& flag : defaultFlags) {
+        profile += " " + flag;
+    }
+    return profile;
+}
+
 void CodeCompiler::cleanup() {
     // Remove temporary files
     try {
@@ -229,11 +942,14 @@ void CodeCompiler::cleanup() {
 }
 
 std::string CodeCompiler::generateTempFilename(const std::string& extension) const {
+    static std::atomic<unsigned long> sequence{0};
+    
     auto now = std::chrono::system_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()).count();
     
-    return "temp_" + std::to_string(timestamp) + extension;
+    return "temp_" + std::to_string(timestamp) + "_" + 
+           std::to_string(sequence.fetch_add(1)) + extension;
 }
 
 std::string CodeCompiler::buildCompileCommand(const std::string& sourceFile, 
@@ -290,6 +1006,294 @@ std::string CodeCompiler::executeCommand(const std::string& command) const {
     return result;
 }
 
+std::string CodeCompiler::runCommand(const std::string& command, const CancellationToken& cancel,
+                                     bool& cancelled, int& exitCode) const {
+    cancelled = false;
+    exitCode = -1;
+#ifdef _WIN32
+    // No process groups here; a cancelled build runs to completion
+    std::string output = executeCommand(command);
+    cancelled = cancel.isCancelled();
+    return output;
+#else
+    std::string output;
+    int outPipe[2];
+    if (pipe2(outPipe, O_CLOEXEC) != 0) {
+        return executeCommand(command);
+    }
+    
+    std::string shell = "/bin/sh";
+    std::string flag = "-c";
+    std::string script = command;
+    char* const argv[] = {&shell[0], &flag[0], &script[0], nullptr};
+    pid_t pid = spawnChild(argv, std::vector<char*>(), -1, outPipe[1], STDERR_FILENO);
+    close(outPipe[1]);
+    if (pid < 0) {
+        close(outPipe[0]);
+        return output;
+    }
+    
+    char buffer[4096];
+    for (;;) {
+        if (cancel.canBeCancelled()) {
+            if (!cancelled && cancel.isCancelled()) {
+                killGroup(pid);
+                cancelled = true;
+            }
+            struct pollfd readable = {outPipe[0], POLLIN, 0};
+            int ready = poll(&readable, 1, 10);
+            if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                continue;
+            }
+        }
+        ssize_t count = read(outPipe[0], buffer, sizeof(buffer));
+        if (count > 0) {
+            output.append(buffer, static_cast<size_t>(count));
+        } else if (count == 0 || errno != EINTR) {
+            break;
+        }
+    }
+    close(outPipe[0]);
+    
+    int status = 0;
+    pid_t waited;
+    while ((waited = waitpid(pid, &status, 0)) < 0 && errno == EINTR) {
+    }
+    if (waited == pid && WIFEXITED(status)) {
+        exitCode = WEXITSTATUS(status);
+    }
+    return output;
+#endif
+}
+
+bool CodeCompiler::runProcess(const std::string& executablePath, const std::string& inputFile,
+                              ExecutionResult& result, const CancellationToken& cancel,
+                              double timeLimitSeconds) const {
+#ifdef _WIN32
+    // Windows implementation (no per-child CPU accounting)
+    std::string command = "\"" + executablePath + "\"";
+    if (!inputFile.empty()) {
+        command += " < \"" + inputFile + "\"";
+    }
+    result.output = executeCommand(command);
+    result.success = true;
+    result.exitCode = 0;
+    return true;
+#else
+    // Unix/Linux implementation: fork/exec so the child's rusage can be collected.
+    // Everything the child touches is prepared before fork() since other threads
+    // may be running test cases concurrently.
+    const char* path = executablePath.c_str();
+    const char* stdinPath = inputFile.empty() ? "/dev/null" : inputFile.c_str();
+    
+    // Inherited environment with this compiler's overrides; the allocation
+    // shim reports through a file named in the child's environment
+    std::vector<std::string> overrides = environment;
+    std::string allocationReport;
+    if (trackAllocations && canTrackAllocations()) {
+        allocationReport = tempDirectory + "/" + generateTempFilename(".alloc");
+        const char* preloaded = getenv("LD_PRELOAD");
+        overrides.push_back("LD_PRELOAD=" + allocationShimPath + 
+                            (preloaded && *preloaded ? ":" + std::string(preloaded) : ""));
+        overrides.push_back("CURRICULUM_ALLOC_REPORT=" + allocationReport);
+    }
+    std::vector<char*> envp = buildEnvironment(overrides);
+    
+    // stderr goes to an anonymous file so it can't fill a pipe nobody reads
+    int errFd = -1;
+    if (captureDiagnostics) {
+        std::string errPath = tempDirectory + "/" + generateTempFilename(".err");
+        errFd = open(errPath.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (errFd >= 0) {
+            unlink(errPath.c_str());
+        }
+    }
+    
+    // With counters, the child waits on a gate pipe until they are attached
+#ifdef __linux__
+    bool countEvents = isCollectingCounters();
+#else
+    bool countEvents = false;
+#endif
+    int gate[2] = {-1, -1};
+    if (countEvents && pipe2(gate, O_CLOEXEC) != 0) {
+        countEvents = false;
+    }
+    auto closeGate = [&gate]() {
+        for (int& fd : gate) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    };
+    
+    int outPipe[2];
+    if (pipe2(outPipe, O_CLOEXEC) != 0) {
+        if (errFd >= 0) close(errFd);
+        closeGate();
+        result.errorOutput = "Failed to create output pipe";
+        return false;
+    }
+    
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(outPipe[0]);
+        close(outPipe[1]);
+        if (errFd >= 0) close(errFd);
+        closeGate();
+        result.errorOutput = "Failed to start process";
+        return false;
+    }
+    
+    if (pid > 0) {
+        setpgid(pid, pid);
+    }
+    if (pid == 0) {
+        setpgid(0, 0);
+        if (countEvents) {
+            close(gate[1]);
+            char released;
+            while (read(gate[0], &released, 1) < 0 && errno == EINTR) {
+            }
+        }
+        int inFd = open(stdinPath, O_RDONLY);
+        if (inFd >= 0) {
+            dup2(inFd, STDIN_FILENO);
+            close(inFd);
+        }
+        dup2(outPipe[1], STDOUT_FILENO);
+        if (errFd >= 0) {
+            dup2(errFd, STDERR_FILENO);
+        }
+        if (envp.empty()) {
+            execl(path, path, static_cast<char*>(nullptr));
+        } else {
+            char* const argv[] = {const_cast<char*>(path), nullptr};
+            execve(path, argv, envp.data());
+        }
+        _exit(127);
+    }
+    
+    close(outPipe[1]);
+    
+#ifdef __linux__
+    // Counters that fail to open (no PMU access) just stay at -1
+    std::unique_ptr<ChildCounters> counters;
+    if (countEvents) {
+        counters = std::make_unique<ChildCounters>(pid);
+    }
+    bool watchInstructions = instructionLimit != 0 && counters && 
+                             counters->isOpen(ChildCounters::INSTRUCTIONS);
+#else
+    bool watchInstructions = false;
+#endif
+    closeGate(); // EOF releases the child
+    
+    bool timeLimited = timeLimitSeconds > 0.0;
+    auto deadline = std::chrono::steady_clock::now() + 
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(timeLimited ? timeLimitSeconds : 0.0));
+    char buffer[4096];
+    for (;;) {
+        // Without a cancellable token or a limit the read simply blocks;
+        // otherwise poll so they are checked while the child is quiet
+        if (cancel.canBeCancelled() || watchInstructions || timeLimited) {
+            bool killed = result.aborted || result.instructionLimitExceeded || result.timeLimitExceeded;
+            if (!killed && cancel.isCancelled()) {
+                killGroup(pid);
+                result.aborted = true;
+            }
+            if (!killed && timeLimited && std::chrono::steady_clock::now() >= deadline) {
+                killGroup(pid);
+                result.timeLimitExceeded = true;
+            }
+#ifdef __linux__
+            if (!killed && watchInstructions && 
+                counters->read(ChildCounters::INSTRUCTIONS) > static_cast<int64_t>(instructionLimit)) {
+                killGroup(pid);
+                result.instructionLimitExceeded = true;
+            }
+#endif
+            struct pollfd readable = {outPipe[0], POLLIN, 0};
+            int ready = poll(&readable, 1, 10);
+            if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                continue;
+            }
+        }
+        ssize_t count = read(outPipe[0], buffer, sizeof(buffer));
+        if (count > 0) {
+            result.output.append(buffer, static_cast<size_t>(count));
+        } else if (count == 0 || errno != EINTR) {
+            break;
+        }
+    }
+    close(outPipe[0]);
+    
+    int status = 0;
+    struct rusage usage {};
+    if (timeLimited && !result.timeLimitExceeded) {
+        // The child may close stdout and keep running
+        result.timeLimitExceeded = !reapBefore(pid, deadline, status, usage);
+    } else {
+        while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {
+        }
+    }
+    
+    if (errFd >= 0) {
+        result.diagnostics = readScratchFile(errFd, std::string::npos);
+        close(errFd);
+    }
+    
+    result.cpuTime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0 +
+                     usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+    result.peakMemoryKb = usage.ru_maxrss;
+    
+#ifdef __linux__
+    if (counters) {
+        counters->readAll(result.counters);
+    }
+#endif
+    if (!allocationReport.empty()) {
+        readAllocationReport(allocationReport, result.heap);
+        std::error_code ec;
+        std::filesystem::remove(allocationReport, ec);
+    }
+    // Also catches children that finished between two polls, so the verdict
+    // doesn't depend on polling granularity
+    if (instructionLimit != 0 && result.counters.instructions > static_cast<int64_t>(instructionLimit)) {
+        result.instructionLimitExceeded = true;
+    }
+    
+    if (result.aborted) {
+        result.success = false;
+        result.errorOutput = "Aborted";
+        return true;
+    }
+    
+    if (result.instructionLimitExceeded) {
+        result.success = false;
+        result.errorOutput = "Instruction limit exceeded";
+        return true;
+    }
+    
+    if (result.timeLimitExceeded) {
+        result.success = false;
+        result.errorOutput = "Time limit of " + formatSeconds(timeLimitSeconds) + " exceeded";
+        return true;
+    }
+    
+    if (WIFSIGNALED(status)) {
+        result.success = false;
+        result.exitCode = 128 + WTERMSIG(status);
+        result.errorOutput = "Terminated by signal " + std::to_string(WTERMSIG(status));
+        return true;
+    }
+    
+    result.success = true;
+    result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return true;
+#endif
+}
+
 void CodeCompiler::initializeCompiler() {
     defaultFlags.clear();
     
@@ -1,7 +1,12 @@
 #pragma once
+#include "CancellationToken.h"
+#include "SharedText.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <cstdint>
 
 enum class CompilerType {
     GCC,
@@ -15,8 +20,43 @@ struct CompilationResult {
     std::string errorOutput;
     std::string warningOutput;
     int exitCode;
+    bool cancelled;     // the compiler was killed because the build was cancelled
+    // The compiler ran and refused the source. Other failures (no compiler,
+    // an I/O error, the compiler crashing) say nothing about the code.
+    bool rejected;
     
-    CompilationResult() : success(false), exitCode(-1) {}
+    CompilationResult() : success(false), exitCode(-1), cancelled(false), rejected(false) {}
+};
+
+// Hardware event counts for one run, read from perf_event on Linux. A count
+// is -1 when its counter could not be opened (no PMU in VMs and containers,
+// perf_event_paranoid, other platforms).
+struct HardwareCounters {
+    int64_t instructions;  // user-space instructions retired
+    int64_t cycles;
+    int64_t cacheMisses;
+    int64_t branchMisses;
+    
+    HardwareCounters() : instructions(-1), cycles(-1), cacheMisses(-1), branchMisses(-1) {}
+    
+    bool available() const { return instructions >= 0; }
+};
+
+// Heap activity of one run, reported by the LD_PRELOAD allocation shim.
+// Only available when tracking was enabled and the program exited normally.
+struct AllocationStats {
+    bool available;
+    uint64_t allocations;        // malloc/calloc/aligned calls, including operator new
+    uint64_t frees;
+    uint64_t reallocations;
+    uint64_t bytesAllocated;     // total bytes requested
+    uint64_t peakLiveBytes;
+    uint64_t leakedAllocations;  // still live at exit
+    uint64_t leakedBytes;
+    
+    AllocationStats() 
+        : available(false), allocations(0), frees(0), reallocations(0), bytesAllocated(0),
+          peakLiveBytes(0), leakedAllocations(0), leakedBytes(0) {}
 };
 
 struct ExecutionResult {
@@ -25,8 +65,60 @@ struct ExecutionResult {
     std::string errorOutput;
     int exitCode;
     double executionTime; // in seconds
+    double cpuTime;       // user + system CPU seconds of the child
+    long peakMemoryKb;    // maximum resident set size of the child
+    bool aborted;         // killed because the caller's token was cancelled
+    std::string diagnostics; // the child's stderr, when capture is enabled
+    HardwareCounters counters; // when counter collection is enabled
+    bool instructionLimitExceeded; // killed after retiring more than the instruction limit
+    bool timeLimitExceeded;   // killed when its wall-time limit ran out
+    AllocationStats heap;     // when allocation tracking is enabled
+    
+    ExecutionResult() 
+        : success(false), exitCode(-1), executionTime(0.0), cpuTime(0.0), peakMemoryKb(0),
+          aborted(false), instructionLimitExceeded(false), timeLimitExceeded(false) {}
+};
+
+struct InteractionLimits {
+    double totalSeconds;     // the whole conversation, including both processes' exits
+    double idleSeconds;      // longest silence from both sides (a per-message deadline)
+    size_t transcriptLimit;  // bytes kept of each side's messages
     
-    ExecutionResult() : success(false), exitCode(-1), executionTime(0.0) {}
+    InteractionLimits() : totalSeconds(10.0), idleSeconds(2.0), transcriptLimit(4096) {}
+};
+
+enum class InteractionVerdict {
+    ACCEPTED,
+    WRONG_ANSWER,    // the interactor rejected the conversation
+    RUNTIME_ERROR,   // accepted by the interactor, but the program crashed or exited non-zero
+    TIMEOUT,
+    IDLE_TIMEOUT,    // neither side said anything for idleSeconds (often a missing flush)
+    JUDGE_ERROR,     // the interactor itself failed
+    CANCELLED        // both sides were killed because the caller's token was cancelled
+};
+
+struct InteractionResult {
+    InteractionVerdict verdict;
+    std::string message;             // the interactor's stderr, or what went wrong
+    ExecutionResult program;         // exit status, times and usage of the program
+    int interactorExitCode;
+    size_t exchanges;                // how often the conversation changed direction
+    std::string programTranscript;   // the first bytes the program sent
+    std::string interactorTranscript;
+    
+    InteractionResult() 
+        : verdict(InteractionVerdict::JUDGE_ERROR), interactorExitCode(-1), exchanges(0) {}
+};
+
+// What a checker program decided about one output
+struct CheckResult {
+    bool accepted;
+    bool judgeError;        // the checker crashed, timed out or could not start
+    double score;           // in [0, 1]; 1 or 0 unless the checker printed one
+    std::string message;    // the checker's stderr, or what went wrong
+    double overheadSeconds; // wall time from starting the checker to its verdict
+    
+    CheckResult() : accepted(false), judgeError(true), score(0.0), overheadSeconds(0.0) {}
 };
 
 class CodeCompiler {
@@ -35,6 +127,12 @@ private:
     std::string compilerPath;
     std::vector<std::string> defaultFlags;
     std::string tempDirectory;
+    std::vector<std::string> environment; // "NAME=value" added for executed programs
+    bool captureDiagnostics;
+    bool collectCounters;
+    uint64_t instructionLimit;
+    bool trackAllocations;
+    std::string allocationShimPath;
 
 public:
     CodeCompiler(CompilerType compiler = CompilerType::GCC);
@@ -44,17 +142,67 @@ public:
     void setCompilerPath(const std::string& path);
     void addCompilerFlag(const std::string& flag);
     void setTempDirectory(const std::string& directory);
+    void setEnvironmentVariable(const std::string& name, const std::string& value);
+    void setCaptureDiagnostics(bool capture); // keep the child's stderr in ExecutionResult
+    void setCollectCounters(bool collect);     // fill ExecutionResult::counters
+    // Kills a child once it retires more instructions than this (0 = no
+    // limit); implies counter collection. Ignored when counters are unavailable.
+    void setInstructionLimit(uint64_t instructions);
+    bool isCollectingCounters() const { return collectCounters || instructionLimit != 0; }
+    uint64_t getInstructionLimit() const { return instructionLimit; }
+    // Whether this host lets us count hardware events at all
+    static bool areCountersAvailable();
+    // Preloads the allocation shim into executed programs and fills
+    // ExecutionResult::heap. Defaults to the shim built with the project.
+    void setTrackAllocations(bool track);
+    void setAllocationShimPath(const std::string& path);
+    const std::string& getAllocationShimPath() const { return allocationShimPath; }
+    bool canTrackAllocations() const; // the shim library exists
     
-    // Compilation
+    // Compilation. Cancelling kills the compiler's whole process group.
     CompilationResult compileCode(const std::string& sourceCode, 
-                                  const std::string& filename = "temp.cpp");
-    CompilationResult compileFile(const std::string& sourceFile);
+                                  const std::string& filename = "temp.cpp",
+                                  const CancellationToken& cancel = CancellationToken::none());
+    CompilationResult compileFile(const std::string& sourceFile,
+                                  const CancellationToken& cancel = CancellationToken::none());
+    // compileCode under a name no other build uses, in this process or
+    // another sharing the temp directory; the source is removed afterwards,
+    // the executable is left to the caller
+    CompilationResult compileScratch(const std::string& sourceCode, const std::string& stem,
+                                     const CancellationToken& cancel = CancellationToken::none());
     
     // Execution
     ExecutionResult executeCode(const std::string& sourceCode, 
                                const std::string& input = "");
+    // Cancelling kills the child's process group (checked every few
+    // milliseconds) and marks the result aborted. A child still running
+    // after timeLimitSeconds (0 = no limit) is killed the same way.
     ExecutionResult executeFile(const std::string& executablePath, 
-                               const std::string& input = "");
+                               const std::string& input = "",
+                               const CancellationToken& cancel = CancellationToken::none(),
+                               double timeLimitSeconds = 0.0);
+    // executeFile for fixtures: a file-backed input (see FixtureStore) is
+    // opened as the child's stdin itself instead of being copied to a
+    // scratch file, in-memory input goes through executeFile
+    ExecutionResult executeWithInput(const std::string& executablePath, const SharedText& input,
+                                     const CancellationToken& cancel = CancellationToken::none(),
+                                     double timeLimitSeconds = 0.0);
+    // Connects the program's stdin/stdout to an interactor through the grader,
+    // which relays every message and enforces the deadlines. The interactor
+    // gets testData as a file named by argv[1] and decides the verdict by its
+    // exit code: 0 accepted, 1 or 2 wrong answer, anything else a judge error.
+    InteractionResult executeInteractive(const std::string& executablePath,
+                                         const std::string& interactorPath,
+                                         const std::string& testData,
+                                         const InteractionLimits& limits = InteractionLimits(),
+                                         const CancellationToken& cancel = CancellationToken::none());
+    // Runs a checker on one program output. The test input, the expected
+    // output and the program's output reach it as in-memory files named by
+    // argv[1..3] (never written to disk). Exit code 0 accepts, 1 or 2 rejects,
+    // anything else is a judge error; a number printed on stdout is the score.
+    CheckResult runChecker(const std::string& checkerPath, std::string_view input,
+                           std::string_view expectedOutput, std::string_view actualOutput,
+                           double timeoutSeconds = 5.0);
     
     // Testing utilities
     bool testCode(const std::string& sourceCode, 
@@ -71,6 +219,8 @@ public:
     CompilerType getCompilerType() const { return compiler; }
     const std::string& getCompilerPath() const { return compilerPath; }
     const std::vector<std::string>& getDefaultFlags() const { return defaultFlags; }
+    const std::string& getTempDirectory() const { return tempDirectory; }
+    std::string getProfile() const; // compiler and flags, identifies how code is built
 
 private:
     std::string generateTempFilename(const std::string& extension = ".cpp") const;
@@ -78,5 +228,16 @@ private:
                                    const std::string& outputFile) const;
     bool writeSourceToFile(const std::string& sourceCode, const std::string& filename) const;
     std::string executeCommand(const std::string& command) const;
+    // Runs and times the program with stdin read from inputFile ("" = none)
+    ExecutionResult executeWithStdin(const std::string& executablePath, const std::string& inputFile,
+                                     const CancellationToken& cancel, double timeLimitSeconds);
+    // executeCommand in its own process group, killed when cancelled.
+    // exitCode is the command's exit status, -1 when unknown or signalled.
+    std::string runCommand(const std::string& command, const CancellationToken& cancel, 
+                           bool& cancelled, int& exitCode) const;
+    bool runProcess(const std::string& executablePath, const std::string& inputFile,
+                    ExecutionResult& result, 
+                    const CancellationToken& cancel = CancellationToken::none(),
+                    double timeLimitSeconds = 0.0) const;
     void initializeCompiler();
 };
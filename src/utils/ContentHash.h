@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a. Stable across runs and hosts, so it can key persisted data.
+inline uint64_t contentHash(std::string_view data, uint64_t seed = 14695981039346656037ull) {
+    uint64_t hash = seed;
+    for (char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,119 @@
+#include "FailureHistory.h"
+#include "ContentHash.h"
+#include "TestRunner.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    // Laplace-smoothed, so a single early failure does not dominate
+    double smoothedRate(uint32_t runs, uint32_t failures) {
+        return (failures + 1.0) / (runs + 2.0);
+    }
+}
+
+uint64_t FailureHistory::testKey(const TestCase& testCase) {
+    return contentHash(testCase.expectedOutput, contentHash(testCase.input));
+}
+
+std::vector<size_t> FailureHistory::order(const std::string& exerciseKey,
+                                          const std::vector<TestCase>& testCases) const {
+    std::vector<size_t> indices(testCases.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = i;
+    }
+
+    std::vector<double> rates(testCases.size(), smoothedRate(0, 0));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto exercise = exercises.find(exerciseKey);
+        if (exercise == exercises.end()) {
+            return indices;
+        }
+        for (size_t i = 0; i < testCases.size(); ++i) {
+            auto stats = exercise->second.find(testKey(testCases[i]));
+            if (stats != exercise->second.end()) {
+                rates[i] = smoothedRate(stats->second.runs, stats->second.failures);
+            }
+        }
+    }
+
+    std::stable_sort(indices.begin(), indices.end(),
+                     [&rates](size_t a, size_t b) { return rates[a] > rates[b]; });
+    return indices;
+}
+
+void FailureHistory::record(const std::string& exerciseKey, const std::vector<TestCase>& testCases,
+                            const std::vector<TestResult>& results) {
+    size_t count = std::min(testCases.size(), results.size());
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = testKey(testCases[i]);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<uint64_t, TestStats>& tests = exercises[exerciseKey];
+    for (size_t i = 0; i < count; ++i) {
+        if (results[i].status == TestStatus::SKIPPED || results[i].status == TestStatus::CANCELLED) {
+            continue;
+        }
+        TestStats& stats = tests[keys[i]];
+        stats.runs++;
+        if (results[i].status != TestStatus::PASSED) {
+            stats.failures++;
+        }
+    }
+}
+
+double FailureHistory::getFailureRate(const std::string& exerciseKey, const TestCase& testCase) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto exercise = exercises.find(exerciseKey);
+    if (exercise == exercises.end()) {
+        return 0.0;
+    }
+    auto stats = exercise->second.find(testKey(testCase));
+    if (stats == exercise->second.end() || stats->second.runs == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(stats->second.failures) / stats->second.runs;
+}
+
+bool FailureHistory::save(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& exercise : exercises) {
+        for (const auto& test : exercise.second) {
+            file << exercise.first << '\t' << std::hex << test.first << std::dec << '\t'
+                 << test.second.runs << '\t' << test.second.failures << '\n';
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool FailureHistory::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream fields(line.substr(tab + 1));
+        uint64_t key = 0;
+        TestStats stats;
+        if (fields >> std::hex >> key >> std::dec >> stats.runs >> stats.failures) {
+            exercises[line.substr(0, tab)][key] = stats;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "../core/Exercise.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TestResult;
+
+// Per-exercise pass/fail counts for every test case, used to run the tests
+// most likely to fail first. Tests are identified by a hash of their input
+// and expected output, so reordering or renaming them keeps their history.
+class FailureHistory {
+private:
+    struct TestStats {
+        uint32_t runs;
+        uint32_t failures;
+
+        TestStats() : runs(0), failures(0) {}
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::map<uint64_t, TestStats>> exercises;
+
+public:
+    // Indices into testCases, highest (smoothed) failure rate first; ties and
+    // unseen tests keep declaration order
+    std::vector<size_t> order(const std::string& exerciseKey,
+                              const std::vector<TestCase>& testCases) const;
+
+    // Adds one graded run; results[i] belongs to testCases[i]. Skipped tests
+    // are not counted.
+    void record(const std::string& exerciseKey, const std::vector<TestCase>& testCases,
+                const std::vector<TestResult>& results);
+
+    double getFailureRate(const std::string& exerciseKey, const TestCase& testCase) const;
+
+    // One "<exerciseKey>\t<testKey>\t<runs>\t<failures>" line per test
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    static uint64_t testKey(const TestCase& testCase);
+};
@@ -0,0 +1,208 @@
+#include "FeatureMatcher.h"
+#include "SourceLexer.h"
+#include <algorithm>
+#include <queue>
+
+namespace {
+    // Calls visit(token) for each token that features can match. Literals
+    // are reported as gaps; directives are split into "#" plus their tokens
+    // so "#include <map>" matches regardless of spacing.
+    template <typename Visitor>
+    void forEachToken(std::string_view source, Visitor&& visit) {
+        SourceLexer lexer(source);
+        Token token;
+        while (lexer.next(token)) {
+            if (token.kind != TokenKind::PREPROCESSOR) {
+                visit(token);
+                continue;
+            }
+
+            Token hash = token;
+            hash.kind = TokenKind::PUNCTUATOR;
+            hash.text = token.text.substr(0, 1);
+            visit(hash);
+
+            SourceLexer directive(token.text.substr(1));
+            Token inner;
+            while (directive.next(inner)) {
+                inner.column += (inner.line == 1) ? token.column : 0;
+                inner.line += token.line - 1;
+                visit(inner);
+            }
+        }
+    }
+
+    bool isLiteral(const Token& token) {
+        return token.kind == TokenKind::STRING_LITERAL || token.kind == TokenKind::CHAR_LITERAL;
+    }
+
+    uint64_t transitionKey(int node, int symbol) {
+        return (static_cast<uint64_t>(node) << 32) | static_cast<uint32_t>(symbol);
+    }
+}
+
+bool FeatureReport::allRequiredPresent() const {
+    return std::all_of(features.begin(), features.end(), [](const FeatureMatch& match) {
+        return !match.required || match.found;
+    });
+}
+
+bool FeatureReport::anyForbiddenPresent() const {
+    return std::any_of(features.begin(), features.end(), [](const FeatureMatch& match) {
+        return !match.required && match.found;
+    });
+}
+
+FeatureMatcher::FeatureMatcher(const std::vector<std::string>& requiredFeatures,
+                               const std::vector<std::string>& forbiddenFeatures)
+    : longestPattern(0) {
+    nodes.emplace_back(); // root
+
+    for (const std::string& feature : requiredFeatures) {
+        addPattern(feature, true);
+    }
+    for (const std::string& feature : forbiddenFeatures) {
+        addPattern(feature, false);
+    }
+
+    buildFailureLinks();
+}
+
+FeatureReport FeatureMatcher::match(std::string_view sourceCode) const {
+    FeatureReport report;
+    report.features = features;
+
+    // Positions of the most recent tokens, to locate where a match started
+    std::vector<std::pair<int, int>> recent(std::max<size_t>(longestPattern, 1));
+    size_t tokenIndex = 0;
+    size_t remaining = 0;
+    for (size_t i = 0; i < features.size(); ++i) {
+        // A feature that lexes to nothing (blank, only a comment) can't be
+        // missing, nor be present as a forbidden feature
+        if (patternLengths[i] == 0) {
+            report.features[i].found = report.features[i].required;
+        } else {
+            remaining++;
+        }
+    }
+    int state = 0;
+
+    forEachToken(sourceCode, [&](const Token& token) {
+        if (remaining == 0) {
+            return;
+        }
+        if (isLiteral(token)) {
+            state = 0;
+            return;
+        }
+
+        recent[tokenIndex % recent.size()] = {token.line, token.column};
+        state = nextState(state, symbolFor(token.text));
+
+        for (int pattern : nodes[state].patterns) {
+            FeatureMatch& match = report.features[pattern];
+            if (!match.found) {
+                const auto& start = recent[(tokenIndex + 1 - patternLengths[pattern]) % recent.size()];
+                match.found = true;
+                match.line = start.first;
+                match.column = start.second;
+                remaining--;
+            }
+        }
+        tokenIndex++;
+    });
+
+    return report;
+}
+
+void FeatureMatcher::addPattern(const std::string& feature, bool required) {
+    int pattern = static_cast<int>(features.size());
+    features.emplace_back(feature, required);
+
+    // Feature text is kept alive so the lexer's views stay valid while interning
+    symbolTexts.push_back(feature);
+    std::string_view text = symbolTexts.back();
+
+    int node = 0;
+    size_t length = 0;
+    forEachToken(text, [&](const Token& token) {
+        auto symbol = symbols.find(token.text);
+        int id = symbol != symbols.end() ? symbol->second : static_cast<int>(symbols.size());
+        if (symbol == symbols.end()) {
+            symbols.emplace(token.text, id);
+        }
+
+        auto edge = transitions.find(transitionKey(node, id));
+        if (edge != transitions.end()) {
+            node = edge->second;
+        } else {
+            nodes.emplace_back();
+            int child = static_cast<int>(nodes.size()) - 1;
+            transitions.emplace(transitionKey(node, id), child);
+            node = child;
+        }
+        length++;
+    });
+
+    patternLengths.push_back(length);
+    if (length > 0) {
+        nodes[node].patterns.push_back(pattern);
+        longestPattern = std::max(longestPattern, length);
+    }
+}
+
+void FeatureMatcher::buildFailureLinks() {
+    // Children grouped by parent so the BFS can walk the trie level by level
+    std::vector<std::vector<std::pair<int, int>>> children(nodes.size());
+    for (const auto& edge : transitions) {
+        int parent = static_cast<int>(edge.first >> 32);
+        int symbol = static_cast<int>(edge.first & 0xFFFFFFFFu);
+        children[parent].emplace_back(symbol, edge.second);
+    }
+
+    std::queue<int> pending;
+    for (const auto& child : children[0]) {
+        nodes[child.second].failure = 0;
+        pending.push(child.second);
+    }
+
+    while (!pending.empty()) {
+        int node = pending.front();
+        pending.pop();
+
+        for (const auto& child : children[node]) {
+            int failure = nodes[node].failure;
+            nodes[child.second].failure = nextState(failure, child.first);
+            if (nodes[child.second].failure == child.second) {
+                nodes[child.second].failure = 0;
+            }
+
+            const std::vector<int>& inherited = nodes[nodes[child.second].failure].patterns;
+            nodes[child.second].patterns.insert(nodes[child.second].patterns.end(),
+                                                inherited.begin(), inherited.end());
+            pending.push(child.second);
+        }
+    }
+}
+
+int FeatureMatcher::symbolFor(std::string_view text) const {
+    auto symbol = symbols.find(text);
+    return symbol != symbols.end() ? symbol->second : -1;
+}
+
+int FeatureMatcher::nextState(int state, int symbol) const {
+    if (symbol < 0) {
+        return 0;
+    }
+
+    for (;;) {
+        auto edge = transitions.find(transitionKey(state, symbol));
+        if (edge != transitions.end()) {
+            return edge->second;
+        }
+        if (state == 0) {
+            return 0;
+        }
+        state = nodes[state].failure;
+    }
+}
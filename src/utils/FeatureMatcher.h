@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct FeatureMatch {
+    std::string feature;
+    bool required;  // false for forbidden features
+    bool found;
+    int line;       // first occurrence, 0 when not found
+    int column;
+
+    FeatureMatch(const std::string& feature, bool required)
+        : feature(feature), required(required), found(false), line(0), column(0) {}
+};
+
+struct FeatureReport {
+    std::vector<FeatureMatch> features;
+
+    bool allRequiredPresent() const;
+    bool anyForbiddenPresent() const;
+    bool isSatisfied() const { return allRequiredPresent() && !anyForbiddenPresent(); }
+};
+
+// Aho-Corasick automaton over C++ tokens. Features are token sequences
+// ("for", "std::vector", "->", "#include <map>") and are matched in one
+// linear pass over the lexed source, so text inside comments and string or
+// character literals never counts. A required feature without any tokens is
+// always satisfied. Build once per exercise and reuse; the matcher is
+// immutable after construction and safe to share across threads.
+class FeatureMatcher {
+private:
+    struct Node {
+        int failure;
+        std::vector<int> patterns; // including those reachable via failure links
+        Node() : failure(0) {}
+    };
+
+    std::vector<FeatureMatch> features;
+    std::vector<size_t> patternLengths; // in tokens, 0 for features that lex to nothing
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, int> transitions; // (node << 32 | symbol) -> node
+    std::deque<std::string> symbolTexts;           // stable storage for symbol keys
+    std::unordered_map<std::string_view, int> symbols;
+    size_t longestPattern;
+
+public:
+    FeatureMatcher(const std::vector<std::string>& requiredFeatures = {},
+                   const std::vector<std::string>& forbiddenFeatures = {});
+
+    FeatureMatcher(const FeatureMatcher&) = delete;
+    FeatureMatcher& operator=(const FeatureMatcher&) = delete;
+
+    FeatureReport match(std::string_view sourceCode) const;
+    size_t getFeatureCount() const { return features.size(); }
+
+private:
+    void addPattern(const std::string& feature, bool required);
+    void buildFailureLinks();
+    int symbolFor(std::string_view text) const;
+    int nextState(int state, int symbol) const;
+};
@@ -0,0 +1,217 @@
+#include "FixtureStore.h"
+#include "ContentHash.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Written next to path, then renamed over it, so readers only ever see
+    // complete files and existing mappings keep the old contents
+    std::string partialPathFor(const std::string& path) {
+        return path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+               ".partial";
+    }
+
+#ifndef _WIN32
+    // What identifies one version of a file; a replaced or rewritten file
+    // gets a new mapping
+    struct FileIdentity {
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        struct timespec modified;
+
+        bool operator==(const FileIdentity& other) const {
+            return device == other.device && inode == other.inode && size == other.size &&
+                   modified.tv_sec == other.modified.tv_sec &&
+                   modified.tv_nsec == other.modified.tv_nsec;
+        }
+    };
+
+    struct CachedMapping {
+        FileIdentity identity;
+        std::weak_ptr<const MappedText> text;
+    };
+
+    std::mutex cacheMutex;
+    std::unordered_map<std::string, CachedMapping> mappings;
+    size_t nextSweep = 64; // mappings.size() at which released entries are dropped
+
+    FileIdentity identityOf(const struct stat& info) {
+#ifdef __APPLE__
+        return FileIdentity{info.st_dev, info.st_ino, info.st_size, info.st_mtimespec};
+#else
+        return FileIdentity{info.st_dev, info.st_ino, info.st_size, info.st_mtim};
+#endif
+    }
+#endif
+}
+
+FixtureStore::FixtureStore(const std::string& directory) : directory(directory) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+}
+
+bool FixtureStore::load(const std::string& name, SharedText& text) const {
+    return mapFile(directory + "/" + name, text);
+}
+
+bool FixtureStore::store(std::string_view contents, SharedText& text) const {
+    std::string path = directory + "/" + nameFor(contents);
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) != contents.size() || ec) {
+        std::string partialPath = partialPathFor(path);
+        {
+            std::ofstream file(partialPath, std::ios::binary);
+            file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            if (!file) {
+                file.close();
+                std::filesystem::remove(partialPath, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(partialPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(partialPath, ec);
+            return false;
+        }
+    }
+    return mapFile(path, text);
+}
+
+std::string FixtureStore::nameFor(std::string_view contents) {
+    char digits[17];
+    std::snprintf(digits, sizeof(digits), "%016llx",
+                  static_cast<unsigned long long>(contentHash(contents)));
+    return std::string(digits) + "-" + std::to_string(contents.size()) + ".fixture";
+}
+
+bool FixtureStore::import(const std::string& path, SharedText& text) const {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    fs::file_time_type modified = fs::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+
+    char digits[17];
+    std::snprintf(digits, sizeof(digits), "%016llx",
+                  static_cast<unsigned long long>(contentHash(fs::absolute(path, ec).string())));
+    std::string copyPath = directory + "/" + digits + ".import";
+
+    // The copy carries the original's modification time to tell when it is stale
+    std::error_code copyEc;
+    bool current = fs::file_size(copyPath, copyEc) == size && !copyEc &&
+                   fs::last_write_time(copyPath, copyEc) == modified && !copyEc;
+    if (!current) {
+        std::string partialPath = partialPathFor(copyPath);
+        fs::copy_file(path, partialPath, fs::copy_options::overwrite_existing, ec);
+        if (!ec) {
+            fs::last_write_time(partialPath, modified, ec);
+        }
+        if (!ec) {
+            fs::rename(partialPath, copyPath, ec);
+        }
+        if (ec) {
+            fs::remove(partialPath, ec);
+            return false;
+        }
+    }
+    return mapFile(copyPath, text);
+}
+
+bool FixtureStore::mapFile(const std::string& path, SharedText& text) {
+#ifdef _WIN32
+    // No mapping here: the file is read once and shared like any fixture
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    auto buffer = std::make_shared<const std::string>(contents.str());
+    auto mapped = std::make_shared<MappedText>();
+    mapped->contents = *buffer;
+    mapped->path = path;
+    mapped->mapping = buffer;
+    text = SharedText(std::shared_ptr<const MappedText>(std::move(mapped)));
+    return true;
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return false;
+    }
+
+    FileIdentity identity = identityOf(info);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = mappings.find(path);
+        if (it != mappings.end()) {
+            if (auto shared = it->second.text.lock()) {
+                if (it->second.identity == identity) {
+                    close(fd);
+                    text = SharedText(std::move(shared));
+                    return true;
+                }
+            } else {
+                mappings.erase(it);
+            }
+        }
+    }
+
+    auto mapped = std::make_shared<MappedText>();
+    mapped->path = path;
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        // Empty files can't be mapped and need no mapping
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(address, size, MADV_SEQUENTIAL);
+        mapped->contents = std::string_view(static_cast<const char*>(address), size);
+        mapped->mapping = std::shared_ptr<const void>(address,
+            [size](const void* region) { munmap(const_cast<void*>(region), size); });
+    }
+    close(fd);
+
+    std::shared_ptr<const MappedText> shared = std::move(mapped);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        mappings[path] = CachedMapping{identity, shared};
+        // Entries of released mappings are dropped in batches, at most as
+        // often as the cache doubles
+        if (mappings.size() >= nextSweep) {
+            for (auto it = mappings.begin(); it != mappings.end();) {
+                it = it->second.text.expired() ? mappings.erase(it) : std::next(it);
+            }
+            nextSweep = std::max<size_t>(64, mappings.size() * 2);
+        }
+    }
+    text = SharedText(std::move(shared));
+    return true;
+#endif
+}
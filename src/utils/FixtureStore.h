@@ -0,0 +1,39 @@
+#pragma once
+#include "SharedText.h"
+#include <string>
+#include <string_view>
+
+// Directory of large test fixtures (multi-megabyte inputs and expected
+// outputs) that are memory-mapped instead of read. A mapped input becomes
+// the graded program's stdin as the file itself, and expected outputs are
+// compared straight from the mapping, so a run costs no copy of either.
+//
+// Files in the store are only ever replaced by rename, never modified in
+// place, which keeps every mapping valid: reading a mapping of a file
+// truncated meanwhile would crash. Files the store doesn't own, such as an
+// exercise directory's, are imported (copied in) before they are mapped.
+class FixtureStore {
+private:
+    std::string directory;
+
+public:
+    explicit FixtureStore(const std::string& directory); // created if missing
+
+    const std::string& getDirectory() const { return directory; }
+
+    // Maps the fixture named name in the store
+    bool load(const std::string& name, SharedText& text) const;
+    // Adds contents under "<hash>.fixture" unless already stored, then maps
+    // it; e.g. to move a generated input out of memory
+    bool store(std::string_view contents, SharedText& text) const;
+    // Name of the fixture store() keeps contents under
+    static std::string nameFor(std::string_view contents);
+    // Maps a copy of the file at path, which may then change freely. The
+    // copy is kept under a name derived from the path and is only redone
+    // once the file's size or modification time changes.
+    bool import(const std::string& path, SharedText& text) const;
+
+    // Maps a file that is only replaced by rename (see above); repeated
+    // calls for an unchanged file share one mapping
+    static bool mapFile(const std::string& path, SharedText& text);
+};
@@ -0,0 +1,457 @@
+#include "GradingMemo.h"
+#include "ContentHash.h"
+#include "SourceLexer.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    const char* const memoFormat = "curriculum-memo 5";
+    const char* const testMemoFormat = "curriculum-test-memo 1";
+
+    std::string hexHash(uint64_t hash) {
+        char digits[17];
+        std::snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+        return digits;
+    }
+
+    uint64_t hashTokens(std::string_view text, uint64_t hash) {
+        SourceLexer lexer(text);
+        Token token;
+        while (lexer.next(token)) {
+            if (token.kind == TokenKind::PREPROCESSOR) {
+                // Directives are kept whole by the lexer; hash their tokens
+                // instead so spacing and trailing comments don't matter
+                hash = contentHash("#", hash);
+                hash = hashTokens(token.text.substr(1), hash);
+            } else {
+                char kind = static_cast<char>('0' + static_cast<int>(token.kind));
+                hash = contentHash(std::string_view(&kind, 1), hash);
+                hash = contentHash(token.text, hash);
+            }
+            hash = contentHash(std::string_view("\0", 1), hash);
+        }
+        return hash;
+    }
+
+    void writeText(std::ostream& out, std::string_view text) {
+        out << text.size() << '\n';
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        out << '\n';
+    }
+
+    bool readText(std::istream& in, std::string& text) {
+        size_t size = 0;
+        if (!(in >> size) || in.get() != '\n') {
+            return false;
+        }
+        text.resize(size);
+        in.read(&text[0], static_cast<std::streamsize>(size));
+        return in.gcount() == static_cast<std::streamsize>(size) && in.get() == '\n';
+    }
+
+    // One result without its input and expected output
+    void writeResult(std::ostream& file, const TestResult& result) {
+        file << static_cast<int>(result.status) << ' ' << result.exitCode << ' '
+             << result.executionTime << ' ' << result.cpuTime << ' '
+             << result.peakMemoryKb << ' ' << result.actualOutputSize << ' '
+             << std::hex << result.actualOutputHash << std::dec << ' '
+             << result.counters.instructions << ' ' << result.counters.cycles << ' '
+             << result.counters.cacheMisses << ' ' << result.counters.branchMisses << ' '
+             << (result.heap.available ? 1 : 0) << ' ' << result.heap.allocations << ' '
+             << result.heap.frees << ' ' << result.heap.reallocations << ' '
+             << result.heap.bytesAllocated << ' ' << result.heap.peakLiveBytes << ' '
+             << result.heap.leakedAllocations << ' ' << result.heap.leakedBytes << ' '
+             << result.checkerScore << ' ' << result.checkerTime << '\n';
+        writeText(file, result.testName);
+        writeText(file, result.actualOutput);
+        writeText(file, result.errorMessage);
+        file << result.sanitizerFindings.size() << '\n';
+        for (const SanitizerFinding& finding : result.sanitizerFindings) {
+            file << static_cast<int>(finding.sanitizer) << ' ' << finding.line << ' '
+                 << finding.column << '\n';
+            writeText(file, finding.category);
+            writeText(file, finding.message);
+            writeText(file, finding.file);
+        }
+    }
+
+    bool readResult(std::istream& file, TestResult& result) {
+        int status = 0;
+        unsigned long long outputHash = 0;
+        int heapAvailable = 0;
+        if (!(file >> status >> result.exitCode >> result.executionTime >> result.cpuTime
+                   >> result.peakMemoryKb >> result.actualOutputSize >> std::hex >> outputHash
+                   >> std::dec >> result.counters.instructions >> result.counters.cycles
+                   >> result.counters.cacheMisses >> result.counters.branchMisses
+                   >> heapAvailable >> result.heap.allocations >> result.heap.frees
+                   >> result.heap.reallocations >> result.heap.bytesAllocated
+                   >> result.heap.peakLiveBytes >> result.heap.leakedAllocations
+                   >> result.heap.leakedBytes >> result.checkerScore >> result.checkerTime) || 
+            file.get() != '\n') {
+            return false;
+        }
+        result.status = static_cast<TestStatus>(status);
+        result.actualOutputHash = outputHash;
+        result.heap.available = heapAvailable != 0;
+        size_t findingCount = 0;
+        if (!readText(file, result.testName) || !readText(file, result.actualOutput) ||
+            !readText(file, result.errorMessage) || !(file >> findingCount) || file.get() != '\n') {
+            return false;
+        }
+        for (size_t f = 0; f < findingCount; ++f) {
+            SanitizerFinding finding;
+            int kind = 0;
+            if (!(file >> kind >> finding.line >> finding.column) || file.get() != '\n' ||
+                !readText(file, finding.category) || !readText(file, finding.message) ||
+                !readText(file, finding.file)) {
+                return false;
+            }
+            finding.sanitizer = static_cast<SanitizerKind>(kind);
+            result.sanitizerFindings.push_back(std::move(finding));
+        }
+        return true;
+    }
+}
+
+GradingMemo::GradingMemo(const std::string& directory, size_t capacity)
+    : directory(directory), capacity(std::max<size_t>(capacity, 1)), hits(0), misses(0), reusedTests(0) {
+    if (!this->directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(this->directory, ec);
+    }
+}
+
+uint64_t GradingMemo::normalizedSourceHash(std::string_view sourceCode) {
+    return hashTokens(sourceCode, contentHash(std::string_view()));
+}
+
+uint64_t GradingMemo::testSetVersion(const std::vector<TestCase>& testCases) {
+    uint64_t hash = contentHash(std::to_string(testCases.size()));
+    for (const TestCase& testCase : testCases) {
+        std::ostringstream rule;
+        rule << static_cast<int>(testCase.comparison.mode) << ' '
+             << testCase.comparison.absoluteTolerance << ' '
+             << testCase.comparison.relativeTolerance << ' '
+             << testCase.input.size() << ' ' << testCase.expectedOutput.size() << ' '
+             << testCase.description;
+        hash = contentHash(rule.str(), hash);
+        hash = contentHash(testCase.input, hash);
+        hash = contentHash(testCase.expectedOutput, hash);
+    }
+    return hash;
+}
+
+std::string GradingMemo::makeKey(std::string_view sourceCode, const std::vector<TestCase>& testCases,
+                                 const std::string& profile) {
+    return hexHash(normalizedSourceHash(sourceCode)) + "-" + hexHash(testSetVersion(testCases)) +
+           "-" + hexHash(contentHash(profile));
+}
+
+std::string GradingMemo::makeSubmissionKey(std::string_view sourceCode, const std::string& profile) {
+    return hexHash(normalizedSourceHash(sourceCode)) + "-" + hexHash(contentHash(profile));
+}
+
+std::string GradingMemo::testKey(const TestCase& testCase) {
+    return testCase.id.empty() ? "#" + hexHash(testCase.fingerprint()) : testCase.id;
+}
+
+bool GradingMemo::lookup(const std::string& key, const std::vector<TestCase>& testCases,
+                         TestSuite& suite) {
+    std::shared_ptr<const TestSuite> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entry = entries.find(key);
+    }
+
+    if (!entry) {
+        auto loaded = std::make_shared<TestSuite>(suite.suiteName);
+        if (loadFromDisk(key, *loaded)) {
+            entry = loaded;
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.put(key, entry, capacity);
+        }
+    }
+
+    bool hit = entry && entry->results.size() == testCases.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hit) {
+            hits++;
+        } else {
+            misses++;
+        }
+    }
+    if (!hit) {
+        return false;
+    }
+
+    std::string suiteName = suite.suiteName;
+    suite = *entry;
+    suite.suiteName = suiteName;
+    for (size_t i = 0; i < testCases.size(); ++i) {
+        suite.results[i].input = testCases[i].input;
+        suite.results[i].expectedOutput = testCases[i].expectedOutput;
+        suite.results[i].comparison = testCases[i].comparison.mode;
+    }
+    return true;
+}
+
+void GradingMemo::store(const std::string& key, const TestSuite& suite) {
+    auto entry = std::make_shared<TestSuite>(suite);
+    for (TestResult& result : entry->results) {
+        result.input = SharedText();
+        result.expectedOutput = SharedText();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.put(key, entry, capacity);
+    }
+    saveToDisk(key, *entry);
+}
+
+std::vector<bool> GradingMemo::reuseTests(const std::string& submissionKey,
+                                          const std::vector<TestCase>& testCases, TestSuite& suite) {
+    std::vector<bool> reused(testCases.size(), false);
+    std::shared_ptr<const StoredTests> stored;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stored = testEntries.find(submissionKey);
+    }
+    if (!stored) {
+        auto loaded = std::make_shared<StoredTests>();
+        if (!loadTestsFromDisk(submissionKey, *loaded)) {
+            return reused;
+        }
+        stored = loaded;
+        std::lock_guard<std::mutex> lock(mutex);
+        testEntries.put(submissionKey, stored, capacity);
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < testCases.size() && i < suite.results.size(); ++i) {
+        auto it = stored->find(testKey(testCases[i]));
+        if (it == stored->end() || it->second.fingerprint != testCases[i].fingerprint()) {
+            continue;
+        }
+        // Names follow the current description
+        std::string testName = suite.results[i].testName;
+        suite.results[i] = it->second.result;
+        suite.results[i].testName = testName;
+        suite.results[i].input = testCases[i].input;
+        suite.results[i].expectedOutput = testCases[i].expectedOutput;
+        suite.results[i].comparison = testCases[i].comparison.mode;
+        reused[i] = true;
+        count++;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    reusedTests += count;
+    return reused;
+}
+
+void GradingMemo::storeTests(const std::string& submissionKey, const std::vector<TestCase>& testCases,
+                             const TestSuite& suite) {
+    if (!suite.compiled) {
+        return;
+    }
+
+    std::shared_ptr<const StoredTests> previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        previous = testEntries.find(submissionKey);
+    }
+
+    // Only the current tests are kept; a conclusive new result replaces the
+    // stored one, and a stored one survives if its test is unchanged
+    auto tests = std::make_shared<StoredTests>();
+    for (size_t i = 0; i < testCases.size() && i < suite.results.size(); ++i) {
+        const TestResult& result = suite.results[i];
+        std::string key = testKey(testCases[i]);
+        uint64_t fingerprint = testCases[i].fingerprint();
+        if (result.status != TestStatus::SKIPPED && result.status != TestStatus::TIMEOUT &&
+            result.status != TestStatus::CANCELLED) {
+            auto entry = tests->emplace(key, StoredTest(fingerprint, result)).first;
+            entry->second.result.input = SharedText();
+            entry->second.result.expectedOutput = SharedText();
+        } else if (previous) {
+            auto it = previous->find(key);
+            if (it != previous->end() && it->second.fingerprint == fingerprint) {
+                tests->emplace(key, it->second);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        testEntries.put(submissionKey, tests, capacity);
+    }
+    saveTestsToDisk(submissionKey, *tests);
+}
+
+size_t GradingMemo::getReusedTestCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reusedTests;
+}
+
+size_t GradingMemo::getHitCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t GradingMemo::getMissCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+double GradingMemo::getHitRate() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+}
+
+size_t GradingMemo::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+bool GradingMemo::loadFromDisk(const std::string& key, TestSuite& suite) const {
+    if (directory.empty()) {
+        return false;
+    }
+
+    std::ifstream file(directory + "/" + key + ".memo", std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string header;
+    size_t count = 0;
+    int compiled = 0;
+    int sanitized = 0;
+    if (!std::getline(file, header) || header != memoFormat ||
+        !(file >> count >> compiled >> sanitized >> suite.wallTime)) {
+        return false;
+    }
+    suite.compiled = compiled != 0;
+    suite.sanitized = sanitized != 0;
+
+    suite.results.clear();
+    suite.results.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        TestResult result("");
+        if (!readResult(file, result)) {
+            return false;
+        }
+        suite.results.push_back(std::move(result));
+    }
+
+    // Counts and totals follow from the results
+    suite.passedCount = suite.failedCount = suite.errorCount = suite.skippedCount = 0;
+    suite.cancelledCount = 0;
+    suite.totalTime = suite.cpuTime = suite.checkerTime = 0.0;
+    for (const TestResult& result : suite.results) {
+        switch (result.status) {
+            case TestStatus::PASSED: suite.passedCount++; break;
+            case TestStatus::FAILED: suite.failedCount++; break;
+            case TestStatus::ERROR:
+            case TestStatus::TIMEOUT: suite.errorCount++; break;
+            case TestStatus::SKIPPED: suite.skippedCount++; break;
+            case TestStatus::CANCELLED: suite.cancelledCount++; break;
+        }
+        suite.totalTime += result.executionTime;
+        suite.cpuTime += result.cpuTime;
+        suite.checkerTime += result.checkerTime;
+    }
+    return true;
+}
+
+void GradingMemo::saveToDisk(const std::string& key, const TestSuite& suite) const {
+    if (directory.empty()) {
+        return;
+    }
+
+    std::string path = directory + "/" + key + ".memo";
+    std::string partialPath = path + ".partial";
+    {
+        std::ofstream file(partialPath, std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+
+        file << memoFormat << '\n'
+             << suite.results.size() << ' ' << (suite.compiled ? 1 : 0) << ' '
+             << (suite.sanitized ? 1 : 0) << ' ' << suite.wallTime << '\n';
+        for (const TestResult& result : suite.results) {
+            writeResult(file, result);
+        }
+        if (!file) {
+            return;
+        }
+    }
+
+    // Rename last so a concurrent grader never reads a partial entry
+    std::error_code ec;
+    std::filesystem::rename(partialPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(partialPath, ec);
+    }
+}
+
+bool GradingMemo::loadTestsFromDisk(const std::string& submissionKey, StoredTests& tests) const {
+    if (directory.empty()) {
+        return false;
+    }
+
+    std::ifstream file(directory + "/" + submissionKey + ".tests", std::ios::binary);
+    std::string header;
+    size_t count = 0;
+    if (!file.is_open() || !std::getline(file, header) || header != testMemoFormat ||
+        !(file >> count) || file.get() != '\n') {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        std::string key;
+        unsigned long long fingerprint = 0;
+        TestResult result("");
+        if (!readText(file, key) || !(file >> std::hex >> fingerprint >> std::dec) ||
+            file.get() != '\n' || !readResult(file, result)) {
+            return false;
+        }
+        tests.emplace(key, StoredTest(fingerprint, result));
+    }
+    return true;
+}
+
+void GradingMemo::saveTestsToDisk(const std::string& submissionKey, const StoredTests& tests) const {
+    if (directory.empty()) {
+        return;
+    }
+
+    std::string path = directory + "/" + submissionKey + ".tests";
+    std::string partialPath = path + ".partial";
+    {
+        std::ofstream file(partialPath, std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        file << testMemoFormat << '\n' << tests.size() << '\n';
+        for (const auto& entry : tests) {
+            writeText(file, entry.first);
+            file << std::hex << entry.second.fingerprint << std::dec << '\n';
+            writeResult(file, entry.second.result);
+        }
+        if (!file) {
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(partialPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(partialPath, ec);
+    }
+}
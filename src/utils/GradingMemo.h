@@ -0,0 +1,125 @@
+#pragma once
+#include "TestRunner.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Remembers graded suites so a resubmission that differs only in comments or
+// whitespace (or a token-identical copy) is answered without compiling or
+// running anything. Keys combine a hash of the token stream, the test-set
+// version and the grading profile; entries can be persisted to a directory
+// so they survive grader restarts.
+//
+// Results are also kept per test, keyed by submission and test id, so that
+// after an instructor edits, adds or removes tests a regrade only runs the
+// tests whose fingerprint is new or changed.
+//
+// At most `capacity` suites and as many per-test records are held in
+// memory; the least recently used are dropped first (persisted ones are
+// read back from disk when asked for again).
+class GradingMemo {
+private:
+    // Least recently used at the back
+    template <typename Value>
+    class LruMap {
+    private:
+        using Entry = std::pair<std::string, Value>;
+        std::list<Entry> order;
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+
+    public:
+        // An empty Value when missing
+        Value find(const std::string& key) {
+            auto it = index.find(key);
+            if (it == index.end()) {
+                return Value();
+            }
+            order.splice(order.begin(), order, it->second);
+            return it->second->second;
+        }
+
+        void put(const std::string& key, Value value, size_t capacity) {
+            auto it = index.find(key);
+            if (it != index.end()) {
+                it->second->second = std::move(value);
+                order.splice(order.begin(), order, it->second);
+                return;
+            }
+            order.emplace_front(key, std::move(value));
+            index.emplace(key, order.begin());
+            while (order.size() > capacity) {
+                index.erase(order.back().first);
+                order.pop_back();
+            }
+        }
+
+        size_t size() const { return order.size(); }
+    };
+
+
+    struct StoredTest {
+        uint64_t fingerprint;
+        TestResult result;
+
+        StoredTest(uint64_t fingerprint, const TestResult& result)
+            : fingerprint(fingerprint), result(result) {}
+    };
+    using StoredTests = std::map<std::string, StoredTest>; // by test key
+
+    std::string directory;
+    size_t capacity;
+    mutable std::mutex mutex;
+    LruMap<std::shared_ptr<const TestSuite>> entries;
+    LruMap<std::shared_ptr<const StoredTests>> testEntries; // by submission key
+    size_t hits;
+    size_t misses;
+    size_t reusedTests;
+
+public:
+    explicit GradingMemo(const std::string& directory = "", size_t capacity = 4096);
+
+    // Hash of the source's tokens; comments, whitespace and line breaks
+    // between tokens do not change it
+    static uint64_t normalizedSourceHash(std::string_view sourceCode);
+    // Changes whenever any input, expected output or comparison rule changes
+    static uint64_t testSetVersion(const std::vector<TestCase>& testCases);
+    static std::string makeKey(std::string_view sourceCode, const std::vector<TestCase>& testCases,
+                               const std::string& profile);
+    // Like makeKey without the test set, for per-test results
+    static std::string makeSubmissionKey(std::string_view sourceCode, const std::string& profile);
+    // The test's id, or its fingerprint when it has none
+    static std::string testKey(const TestCase& testCase);
+
+    // On a hit, fills suite with the stored results; inputs and expected
+    // outputs are re-attached from testCases rather than stored
+    bool lookup(const std::string& key, const std::vector<TestCase>& testCases, TestSuite& suite);
+    void store(const std::string& key, const TestSuite& suite);
+
+    // suite.results must be sized like testCases; stored results replace the
+    // entries of unchanged tests, which are flagged in the returned vector
+    std::vector<bool> reuseTests(const std::string& submissionKey,
+                                 const std::vector<TestCase>& testCases, TestSuite& suite);
+    // Keeps the conclusive results (not skipped, not timed out) of a compiled suite
+    void storeTests(const std::string& submissionKey, const std::vector<TestCase>& testCases,
+                    const TestSuite& suite);
+
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+    double getHitRate() const;
+    size_t size() const; // suites held in memory, at most getCapacity()
+    size_t getCapacity() const { return capacity; }
+    size_t getReusedTestCount() const; // test executions avoided by reuseTests
+
+private:
+    bool loadFromDisk(const std::string& key, TestSuite& suite) const;
+    void saveToDisk(const std::string& key, const TestSuite& suite) const;
+    bool loadTestsFromDisk(const std::string& submissionKey, StoredTests& tests) const;
+    void saveTestsToDisk(const std::string& submissionKey, const StoredTests& tests) const;
+};
@@ -0,0 +1,115 @@
+#include "GradingService.h"
+#include <algorithm>
+
+GradingService::GradingService(unsigned int workerCount)
+    : nextSequence(0), stopping(false), submitted(0), graded(0), superseded(0) {
+    // Created lazily otherwise, which would race between the workers
+    runner.getReferenceCache();
+
+    workerCount = std::max(1u, workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&GradingService::workerLoop, this);
+    }
+}
+
+GradingService::~GradingService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (auto& entry : latest) {
+            entry.second.cancel.cancel();
+        }
+    }
+    queueCondition.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+GradingService& GradingService::shared() {
+    static GradingService service;
+    return service;
+}
+
+void GradingService::submit(const std::string& key, const std::string& sourceCode,
+                            const Exercise& exercise, Completion done) {
+    submitted.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto job = std::make_unique<Job>(key, nextSequence++, sourceCode, exercise, std::move(done));
+        auto previous = latest.find(key);
+        if (previous != latest.end()) {
+            previous->second.cancel.cancel();
+            superseded.fetch_add(1);
+        }
+        latest[key] = Latest{job->sequence, job->cancel};
+        queue.push_back(std::move(job));
+    }
+    queueCondition.notify_one();
+}
+
+std::future<TestSuite> GradingService::submit(const std::string& key, const std::string& sourceCode,
+                                              const Exercise& exercise) {
+    auto promise = std::make_shared<std::promise<TestSuite>>();
+    std::future<TestSuite> future = promise->get_future();
+    submit(key, sourceCode, exercise,
+           [promise](const TestSuite& suite) { promise->set_value(suite); });
+    return future;
+}
+
+void GradingService::cancel(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = latest.find(key);
+    if (it != latest.end()) {
+        it->second.cancel.cancel();
+    }
+}
+
+size_t GradingService::getQueuedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+void GradingService::workerLoop() {
+    for (;;) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        // Superseded while queued: not worth a compile
+        TestSuite suite = job->cancel.isCancelled() ? cancelledSuite(*job) :
+            runner.runExerciseTests(job->sourceCode, job->exercise, job->cancel);
+        graded.fetch_add(1);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = latest.find(job->key);
+            if (it != latest.end() && it->second.sequence == job->sequence) {
+                latest.erase(it);
+            }
+        }
+        if (job->done) {
+            job->done(suite);
+        }
+    }
+}
+
+TestSuite GradingService::cancelledSuite(const Job& job) const {
+    TestSuite suite("Exercise: " + job.exercise.getTitle());
+    for (size_t i = 0; i < job.exercise.getTestCases().size(); ++i) {
+        TestResult result("Test " + std::to_string(i + 1));
+        result.status = TestStatus::CANCELLED;
+        result.errorMessage = "Cancelled";
+        suite.results.push_back(result);
+    }
+    runner.updateSuiteStatistics(suite, 0.0);
+    return suite;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "TestRunner.h"
+#include "CancellationToken.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One grading pipeline shared by every caller: a single TestRunner (so one
+// compiler setup, reference cache and grading memo) behind a submission
+// queue served by a few workers. Submissions carry a key, e.g. student and
+// exercise; a newer submission under the same key cancels the older one,
+// whether it is still queued or already compiling or running.
+class GradingService {
+public:
+    // Runs on a grading worker once the suite is done (or was cancelled)
+    using Completion = std::function<void(const TestSuite& suite)>;
+
+private:
+    struct Job {
+        std::string key;
+        uint64_t sequence;
+        std::string sourceCode;
+        Exercise exercise;   // its grading snapshot: the caller's exercise may change meanwhile
+        CancellationToken cancel;
+        Completion done;
+
+        Job(const std::string& key, uint64_t sequence, const std::string& sourceCode,
+            const Exercise& exercise, Completion done)
+            : key(key), sequence(sequence), sourceCode(sourceCode), 
+              exercise(exercise.gradingSnapshot()), done(std::move(done)) {}
+    };
+
+    struct Latest {
+        uint64_t sequence;
+        CancellationToken cancel;
+    };
+
+    TestRunner runner;
+    std::mutex mutex;
+    std::condition_variable queueCondition;
+    std::deque<std::unique_ptr<Job>> queue;
+    std::map<std::string, Latest> latest; // newest unfinished submission per key
+    std::vector<std::thread> workers;
+    uint64_t nextSequence;
+    bool stopping;
+    std::atomic<size_t> submitted;
+    std::atomic<size_t> graded;
+    std::atomic<size_t> superseded;
+
+public:
+    // Submissions graded at once; each spreads its tests over the runner's
+    // own workers
+    explicit GradingService(unsigned int workers = 2);
+    // Cancels whatever is queued or running and waits for the workers
+    ~GradingService();
+
+    GradingService(const GradingService&) = delete;
+    GradingService& operator=(const GradingService&) = delete;
+
+    // The instance used by Exercise::submitSolution and the application
+    static GradingService& shared();
+
+    // Configure before the first submission
+    TestRunner& getRunner() { return runner; }
+
+    void submit(const std::string& key, const std::string& sourceCode, const Exercise& exercise,
+                Completion done);
+    std::future<TestSuite> submit(const std::string& key, const std::string& sourceCode,
+                                  const Exercise& exercise);
+    // Cancels the newest submission under key, if it hasn't finished
+    void cancel(const std::string& key);
+
+    size_t getQueuedCount();
+    size_t getSubmittedCount() const { return submitted.load(); }
+    size_t getGradedCount() const { return graded.load(); }
+    size_t getSupersededCount() const { return superseded.load(); }
+
+private:
+    void workerLoop();
+    TestSuite cancelledSuite(const Job& job) const;
+};
@@ -0,0 +1,288 @@
+#include "LintEngine.h"
+#include <algorithm>
+
+namespace {
+    bool isPunctuator(const Token& token, std::string_view text) {
+        return token.kind == TokenKind::PUNCTUATOR && token.text == text;
+    }
+
+    bool isIdentifier(const Token& token, std::string_view text) {
+        return token.kind == TokenKind::IDENTIFIER && token.text == text;
+    }
+
+    // Header named by an #include directive, or empty for other directives
+    std::string_view includedHeader(std::string_view directive) {
+        size_t pos = directive.find_first_not_of(" \t", 1);
+        if (pos == std::string_view::npos || directive.compare(pos, 7, "include") != 0) {
+            return std::string_view();
+        }
+
+        pos = directive.find_first_of("<\"", pos + 7);
+        if (pos == std::string_view::npos) {
+            return std::string_view();
+        }
+        size_t close = directive.find(directive[pos] == '<' ? '>' : '"', pos + 1);
+        if (close == std::string_view::npos) {
+            return std::string_view();
+        }
+        return directive.substr(pos + 1, close - pos - 1);
+    }
+
+    // Standard stream names and the header that declares them
+    struct IncludeRequirement {
+        std::string_view identifier;
+        std::string_view header;
+    };
+
+    constexpr IncludeRequirement includeRequirements[] = {
+        {"cout", "iostream"},
+        {"cin", "iostream"},
+        {"cerr", "iostream"},
+        {"clog", "iostream"},
+        {"endl", "iostream"},
+    };
+
+    constexpr std::string_view streamNames[] = {"cout", "cin", "cerr", "clog", "endl"};
+
+    bool isStreamName(std::string_view identifier) {
+        return std::find(std::begin(streamNames), std::end(streamNames), identifier) !=
+               std::end(streamNames);
+    }
+
+    class MissingIncludeRule : public LintRule {
+    private:
+        std::vector<std::string_view> includedHeaders;
+        std::vector<Token> firstUses; // one per header, in order of use
+
+    public:
+        void onToken(const Token& token, std::vector<LintFinding>&) override {
+            if (token.kind == TokenKind::PREPROCESSOR) {
+                std::string_view header = includedHeader(token.text);
+                if (!header.empty()) {
+                    includedHeaders.push_back(header);
+                }
+                return;
+            }
+            if (token.kind != TokenKind::IDENTIFIER) {
+                return;
+            }
+
+            for (const IncludeRequirement& requirement : includeRequirements) {
+                if (token.text != requirement.identifier) {
+                    continue;
+                }
+                bool seen = std::any_of(firstUses.begin(), firstUses.end(), [&](const Token& use) {
+                    return headerFor(use.text) == requirement.header;
+                });
+                if (!seen) {
+                    firstUses.push_back(token);
+                }
+            }
+        }
+
+        void onEnd(std::vector<LintFinding>& findings) override {
+            for (const Token& use : firstUses) {
+                std::string_view header = headerFor(use.text);
+                if (std::find(includedHeaders.begin(), includedHeaders.end(), header) ==
+                    includedHeaders.end()) {
+                    findings.emplace_back("missing-include",
+                        "Missing #include <" + std::string(header) + "> for " +
+                        std::string(use.text) + " usage", use.line, use.column);
+                }
+            }
+        }
+
+    private:
+        static std::string_view headerFor(std::string_view identifier) {
+            for (const IncludeRequirement& requirement : includeRequirements) {
+                if (requirement.identifier == identifier) {
+                    return requirement.header;
+                }
+            }
+            return std::string_view();
+        }
+    };
+
+    class StdQualificationRule : public LintRule {
+    private:
+        Token previous[3];
+        bool usingNamespaceStd = false;
+        bool reported = false;
+        std::vector<std::string_view> usingDeclarations;
+
+    public:
+        void onToken(const Token& token, std::vector<LintFinding>& findings) override {
+            // using namespace std
+            if (isIdentifier(token, "std") && isIdentifier(previous[0], "namespace") &&
+                isIdentifier(previous[1], "using")) {
+                usingNamespaceStd = true;
+            }
+            // using std::name
+            if (token.kind == TokenKind::IDENTIFIER && isPunctuator(previous[0], "::") &&
+                isIdentifier(previous[1], "std") && isIdentifier(previous[2], "using")) {
+                usingDeclarations.push_back(token.text);
+            }
+
+            if (!reported && !usingNamespaceStd && token.kind == TokenKind::IDENTIFIER &&
+                isStreamName(token.text) && !isPunctuator(previous[0], "::") &&
+                !isPunctuator(previous[0], ".") && !isPunctuator(previous[0], "->") &&
+                std::find(usingDeclarations.begin(), usingDeclarations.end(), token.text) ==
+                    usingDeclarations.end()) {
+                findings.emplace_back("std-qualification",
+                    "Missing 'std::' prefix or 'using namespace std;'", token.line, token.column);
+                reported = true;
+            }
+
+            previous[2] = previous[1];
+            previous[1] = previous[0];
+            previous[0] = token;
+        }
+    };
+
+    class MissingMainRule : public LintRule {
+    private:
+        Token previous;
+        bool found = false;
+
+    public:
+        void onToken(const Token& token, std::vector<LintFinding>&) override {
+            if (isIdentifier(token, "main") && isIdentifier(previous, "int")) {
+                found = true;
+            }
+            previous = token;
+        }
+
+        void onEnd(std::vector<LintFinding>& findings) override {
+            if (!found) {
+                findings.emplace_back("missing-main", "Missing main function");
+            }
+        }
+    };
+
+    // Flags a line that looks like a statement (stream I/O or an assignment)
+    // but has no ';', '{' or '}' and is not continued on the next line.
+    class MissingSemicolonRule : public LintRule {
+    private:
+        Token last;
+        int currentLine = 0;
+        int nesting = 0; // open parentheses and brackets
+        bool hasStatement = false;
+        bool hasTerminator = false;
+
+    public:
+        void onToken(const Token& token, std::vector<LintFinding>& findings) override {
+            if (token.line != currentLine) {
+                checkLine(&token, findings);
+                currentLine = token.line;
+                hasStatement = false;
+                hasTerminator = false;
+            }
+
+            if (token.kind == TokenKind::PUNCTUATOR) {
+                std::string_view text = token.text;
+                if (text == ";" || text == "{" || text == "}") {
+                    hasTerminator = true;
+                } else if (text == "(" || text == "[") {
+                    nesting++;
+                } else if (text == ")" || text == "]") {
+                    nesting = std::max(0, nesting - 1);
+                } else if (isAssignment(text)) {
+                    hasStatement = true;
+                }
+            } else if (token.kind == TokenKind::IDENTIFIER && (token.text == "cout" || token.text == "cin")) {
+                hasStatement = true;
+            }
+
+            if (token.kind != TokenKind::PREPROCESSOR) {
+                last = token;
+            }
+        }
+
+        void onEnd(std::vector<LintFinding>& findings) override {
+            checkLine(nullptr, findings);
+        }
+
+    private:
+        static bool isAssignment(std::string_view text) {
+            return text == "=" || text == "+=" || text == "-=" || text == "*=" || text == "/=" ||
+                   text == "%=" || text == "&=" || text == "|=" || text == "^=" ||
+                   text == "<<=" || text == ">>=";
+        }
+
+        void checkLine(const Token* next, std::vector<LintFinding>& findings) const {
+            if (!hasStatement || hasTerminator || nesting > 0) {
+                return;
+            }
+            // A trailing operator means the statement carries on
+            if (last.kind == TokenKind::PUNCTUATOR && last.text != ")" && last.text != "]") {
+                return;
+            }
+            // So does a next line that doesn't start a new statement
+            if (next && next->kind != TokenKind::IDENTIFIER && next->kind != TokenKind::PREPROCESSOR &&
+                !isPunctuator(*next, "}")) {
+                return;
+            }
+
+            findings.emplace_back("missing-semicolon", "Statement might be missing a semicolon",
+                                  last.line, last.column + static_cast<int>(last.text.size()));
+        }
+    };
+
+    template <typename Rule>
+    std::unique_ptr<LintRule> makeRule() {
+        return std::make_unique<Rule>();
+    }
+
+    using RuleFactoryFunction = std::unique_ptr<LintRule> (*)();
+
+    constexpr RuleFactoryFunction defaultRules[] = {
+        &makeRule<MissingIncludeRule>,
+        &makeRule<StdQualificationRule>,
+        &makeRule<MissingMainRule>,
+        &makeRule<MissingSemicolonRule>,
+    };
+}
+
+void LintEngine::registerRule(RuleFactory factory) {
+    ruleFactories.push_back(std::move(factory));
+}
+
+std::vector<LintFinding> LintEngine::lint(std::string_view sourceCode) const {
+    std::vector<std::unique_ptr<LintRule>> rules;
+    rules.reserve(ruleFactories.size());
+    for (const RuleFactory& factory : ruleFactories) {
+        rules.push_back(factory());
+    }
+
+    std::vector<LintFinding> findings;
+    SourceLexer lexer(sourceCode);
+    Token token;
+    while (lexer.next(token)) {
+        for (const auto& rule : rules) {
+            rule->onToken(token, findings);
+        }
+    }
+    for (const auto& rule : rules) {
+        rule->onEnd(findings);
+    }
+
+    std::stable_sort(findings.begin(), findings.end(), [](const LintFinding& a, const LintFinding& b) {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+    return findings;
+}
+
+const LintEngine& LintEngine::defaultEngine() {
+    static const LintEngine engine = []() {
+        LintEngine defaults;
+        registerDefaultRules(defaults);
+        return defaults;
+    }();
+    return engine;
+}
+
+void LintEngine::registerDefaultRules(LintEngine& engine) {
+    for (RuleFactoryFunction factory : defaultRules) {
+        engine.registerRule(factory);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "SourceLexer.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct LintFinding {
+    std::string ruleId;
+    std::string message;
+    int line;    // 0 when the finding applies to the whole file
+    int column;
+
+    LintFinding(const std::string& ruleId, const std::string& message, int line = 0, int column = 0)
+        : ruleId(ruleId), message(message), line(line), column(column) {}
+};
+
+// A lint rule sees every token of one source file in order. A fresh instance
+// is created for each run, so rules may keep per-file state in members.
+class LintRule {
+public:
+    virtual ~LintRule() = default;
+    virtual void onToken(const Token& token, std::vector<LintFinding>& findings) = 0;
+    virtual void onEnd(std::vector<LintFinding>& findings) { (void)findings; }
+};
+
+// Lexes a source file once and feeds the token stream to every registered
+// rule. Findings come back sorted by position. lint() is const and keeps no
+// shared state, so one engine can serve many threads.
+class LintEngine {
+public:
+    using RuleFactory = std::function<std::unique_ptr<LintRule>()>;
+
+private:
+    std::vector<RuleFactory> ruleFactories;
+
+public:
+    void registerRule(RuleFactory factory);
+    size_t getRuleCount() const { return ruleFactories.size(); }
+
+    std::vector<LintFinding> lint(std::string_view sourceCode) const;
+
+    // Engine preloaded with the built-in common-mistake rules
+    static const LintEngine& defaultEngine();
+    static void registerDefaultRules(LintEngine& engine);
+};
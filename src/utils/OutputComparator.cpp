@@ -0,0 +1,251 @@
+#include "OutputComparator.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OUTPUT_COMPARATOR_SSE2 1
+#endif
+
+namespace {
+    inline bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    inline bool isLineSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    inline char foldAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    size_t skipWhitespace(std::string_view text, size_t pos) {
+        while (pos < text.size() && isWhitespace(text[pos])) {
+            pos++;
+        }
+        return pos;
+    }
+
+    size_t skipLineSpace(std::string_view text, size_t pos) {
+        while (pos < text.size() && isLineSpace(text[pos])) {
+            pos++;
+        }
+        return pos;
+    }
+
+    size_t tokenEnd(std::string_view text, size_t pos) {
+        while (pos < text.size() && !isWhitespace(text[pos])) {
+            pos++;
+        }
+        return pos;
+    }
+
+    bool atTokenBoundary(std::string_view text, size_t pos) {
+        return pos == 0 || pos == text.size() ||
+               isWhitespace(text[pos - 1]) || isWhitespace(text[pos]);
+    }
+
+    bool parseNumber(std::string_view token, double& value) {
+        const char* first = token.data();
+        const char* last = token.data() + token.size();
+        if (first != last && *first == '+') {
+            first++;
+        }
+        auto parsed = std::from_chars(first, last, value);
+        return parsed.ec == std::errc() && parsed.ptr == last;
+    }
+
+#ifdef OUTPUT_COMPARATOR_SSE2
+    inline __m128i foldBlock(__m128i block) {
+        const __m128i upperMin = _mm_set1_epi8('A' - 1);
+        const __m128i upperMax = _mm_set1_epi8('Z' + 1);
+        const __m128i caseBit = _mm_set1_epi8(0x20);
+        __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(block, upperMin),
+                                        _mm_cmplt_epi8(block, upperMax));
+        return _mm_or_si128(block, _mm_and_si128(isUpper, caseBit));
+    }
+
+    inline unsigned int countTrailingZeros(unsigned int mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned int>(index);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+#endif
+}
+
+bool OutputComparator::matches(std::string_view expected, std::string_view actual,
+                               const ComparisonOptions& options) {
+    switch (options.mode) {
+        case ComparisonMode::EXACT:
+            return expected.size() == actual.size() &&
+                   firstMismatch(expected.data(), actual.data(), expected.size()) == expected.size();
+        case ComparisonMode::IGNORE_TRAILING_WHITESPACE:
+            return matchLines(expected, actual, false);
+        case ComparisonMode::CASE_INSENSITIVE:
+            return matchLines(expected, actual, true);
+        case ComparisonMode::IGNORE_ALL_WHITESPACE:
+            return matchIgnoringWhitespace(expected, actual);
+        case ComparisonMode::TOKENS:
+            return matchTokens(expected, actual);
+        case ComparisonMode::NUMERIC_TOLERANCE:
+            return matchNumericTokens(expected, actual,
+                                      options.absoluteTolerance, options.relativeTolerance);
+    }
+    return false;
+}
+
+size_t OutputComparator::firstMismatch(const char* a, const char* b, size_t length, bool foldCase) {
+    size_t pos = 0;
+
+#ifdef OUTPUT_COMPARATOR_SSE2
+    for (; pos + 16 <= length; pos += 16) {
+        __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + pos));
+        __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + pos));
+        if (foldCase) {
+            blockA = foldBlock(blockA);
+            blockB = foldBlock(blockB);
+        }
+        unsigned int equal = static_cast<unsigned int>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(blockA, blockB)));
+        if (equal != 0xFFFFu) {
+            return pos + countTrailingZeros(~equal & 0xFFFFu);
+        }
+    }
+#else
+    if (!foldCase) {
+        // memcmp is vectorized by the C library; narrow down to the byte afterwards
+        const size_t chunk = 4096;
+        while (pos + chunk <= length && std::memcmp(a + pos, b + pos, chunk) == 0) {
+            pos += chunk;
+        }
+    }
+#endif
+
+    if (foldCase) {
+        while (pos < length && foldAscii(a[pos]) == foldAscii(b[pos])) {
+            pos++;
+        }
+    } else {
+        while (pos < length && a[pos] == b[pos]) {
+            pos++;
+        }
+    }
+    return pos;
+}
+
+bool OutputComparator::matchLines(std::string_view expected, std::string_view actual, bool foldCase) {
+    size_t i = 0;
+    size_t j = 0;
+
+    for (;;) {
+        size_t common = firstMismatch(expected.data() + i, actual.data() + j,
+                                      std::min(expected.size() - i, actual.size() - j), foldCase);
+        i += common;
+        j += common;
+        if (i == expected.size() && j == actual.size()) {
+            return true;
+        }
+
+        // Only a difference in trailing whitespace on this line is allowed here
+        size_t lineEndExpected = skipLineSpace(expected, i);
+        size_t lineEndActual = skipLineSpace(actual, j);
+        bool expectedAtEol = lineEndExpected == expected.size() || expected[lineEndExpected] == '\n';
+        bool actualAtEol = lineEndActual == actual.size() || actual[lineEndActual] == '\n';
+        if (!expectedAtEol || !actualAtEol) {
+            return false;
+        }
+
+        // Once either side runs out, the rest of the other may only be blank lines
+        if (lineEndExpected == expected.size() || lineEndActual == actual.size()) {
+            return skipWhitespace(expected, lineEndExpected) == expected.size() &&
+                   skipWhitespace(actual, lineEndActual) == actual.size();
+        }
+
+        i = lineEndExpected + 1;
+        j = lineEndActual + 1;
+    }
+}
+
+bool OutputComparator::matchIgnoringWhitespace(std::string_view expected, std::string_view actual) {
+    size_t i = 0;
+    size_t j = 0;
+
+    for (;;) {
+        size_t common = firstMismatch(expected.data() + i, actual.data() + j,
+                                      std::min(expected.size() - i, actual.size() - j));
+        i = skipWhitespace(expected, i + common);
+        j = skipWhitespace(actual, j + common);
+
+        if (i == expected.size() || j == actual.size()) {
+            return i == expected.size() && j == actual.size();
+        }
+        if (expected[i] != actual[j]) {
+            return false;
+        }
+    }
+}
+
+bool OutputComparator::matchTokens(std::string_view expected, std::string_view actual) {
+    size_t i = skipWhitespace(expected, 0);
+    size_t j = skipWhitespace(actual, 0);
+
+    for (;;) {
+        size_t common = firstMismatch(expected.data() + i, actual.data() + j,
+                                      std::min(expected.size() - i, actual.size() - j));
+        i += common;
+        j += common;
+
+        // A divergence is only acceptable between tokens on both sides
+        if (!atTokenBoundary(expected, i) || !atTokenBoundary(actual, j)) {
+            return false;
+        }
+
+        i = skipWhitespace(expected, i);
+        j = skipWhitespace(actual, j);
+        if (i == expected.size() || j == actual.size()) {
+            return i == expected.size() && j == actual.size();
+        }
+        if (expected[i] != actual[j]) {
+            return false;
+        }
+    }
+}
+
+bool OutputComparator::matchNumericTokens(std::string_view expected, std::string_view actual,
+                                          double absoluteTolerance, double relativeTolerance) {
+    size_t i = skipWhitespace(expected, 0);
+    size_t j = skipWhitespace(actual, 0);
+
+    while (i < expected.size() && j < actual.size()) {
+        size_t endExpected = tokenEnd(expected, i);
+        size_t endActual = tokenEnd(actual, j);
+        std::string_view tokenExpected = expected.substr(i, endExpected - i);
+        std::string_view tokenActual = actual.substr(j, endActual - j);
+
+        if (tokenExpected != tokenActual) {
+            double valueExpected = 0.0;
+            double valueActual = 0.0;
+            if (!parseNumber(tokenExpected, valueExpected) || !parseNumber(tokenActual, valueActual)) {
+                return false;
+            }
+
+            double difference = std::fabs(valueExpected - valueActual);
+            double scale = std::max(std::fabs(valueExpected), std::fabs(valueActual));
+            if (!(difference <= absoluteTolerance || difference <= relativeTolerance * scale)) {
+                return false;
+            }
+        }
+
+        i = skipWhitespace(expected, endExpected);
+        j = skipWhitespace(actual, endActual);
+    }
+
+    return i == expected.size() && j == actual.size();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+enum class ComparisonMode {
+    EXACT,                      // byte-for-byte
+    IGNORE_TRAILING_WHITESPACE, // trailing spaces per line and trailing blank lines
+    IGNORE_ALL_WHITESPACE,      // whitespace removed entirely before comparing
+    TOKENS,                     // whitespace-separated tokens must match
+    CASE_INSENSITIVE,           // like IGNORE_TRAILING_WHITESPACE, ASCII case folded
+    NUMERIC_TOLERANCE           // token-wise, numeric tokens within tolerance
+};
+
+struct ComparisonOptions {
+    ComparisonMode mode;
+    double absoluteTolerance;
+    double relativeTolerance;
+
+    ComparisonOptions(ComparisonMode mode = ComparisonMode::IGNORE_TRAILING_WHITESPACE,
+                      double absoluteTolerance = 1e-9, double relativeTolerance = 1e-9)
+        : mode(mode), absoluteTolerance(absoluteTolerance),
+          relativeTolerance(relativeTolerance) {}
+};
+
+// Compares program output against the expected output without copying or
+// allocating. EXACT, IGNORE_TRAILING_WHITESPACE, CASE_INSENSITIVE,
+// IGNORE_ALL_WHITESPACE and TOKENS are driven by a vectorized (SSE2) search
+// for the first differing byte, so identical stretches are skipped at memory
+// bandwidth and the mode rules only run where the outputs diverge.
+// NUMERIC_TOLERANCE walks the outputs token by token with a scalar loop and
+// parses only the tokens that differ.
+class OutputComparator {
+public:
+    static bool matches(std::string_view expected, std::string_view actual,
+                        const ComparisonOptions& options = ComparisonOptions());
+
+    // Length of the common prefix of a and b (both at least `length` bytes)
+    static size_t firstMismatch(const char* a, const char* b, size_t length,
+                                bool foldCase = false);
+
+private:
+    static bool matchLines(std::string_view expected, std::string_view actual, bool foldCase);
+    static bool matchIgnoringWhitespace(std::string_view expected, std::string_view actual);
+    static bool matchTokens(std::string_view expected, std::string_view actual);
+    static bool matchNumericTokens(std::string_view expected, std::string_view actual,
+                                   double absoluteTolerance, double relativeTolerance);
+};
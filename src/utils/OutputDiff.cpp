@@ -0,0 +1,263 @@
+#include "OutputDiff.h"
+#include "ContentHash.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    struct Line {
+        std::string_view text;
+        uint64_t hash;  // of the text without trailing whitespace
+    };
+
+    enum class EditType { KEEP, REMOVE, ADD };
+
+    // Positions in both outputs before the edit is applied (0-based)
+    struct Edit {
+        EditType type;
+        size_t expectedLine;
+        size_t actualLine;
+    };
+
+    std::string_view trimTrailingSpace(std::string_view line) {
+        size_t end = line.size();
+        while (end > 0 && (line[end - 1] == ' ' || line[end - 1] == '\t' || line[end - 1] == '\r' ||
+                           line[end - 1] == '\v' || line[end - 1] == '\f')) {
+            end--;
+        }
+        return line.substr(0, end);
+    }
+
+    std::vector<Line> splitLines(std::string_view text) {
+        std::vector<Line> lines;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            std::string_view line = text.substr(start, end - start);
+            lines.push_back({line, contentHash(trimTrailingSpace(line))});
+            start = end + 1;
+        }
+        while (!lines.empty() && trimTrailingSpace(lines.back().text).empty()) {
+            lines.pop_back();
+        }
+        return lines;
+    }
+
+    inline bool sameLine(const Line& a, const Line& b) {
+        return a.hash == b.hash && trimTrailingSpace(a.text) == trimTrailingSpace(b.text);
+    }
+
+    // Myers' greedy forward search on a[aBegin, aEnd) against b[bBegin, bEnd),
+    // keeping the frontier of every step for the traceback (O(D^2) memory).
+    // Returns false once the edit distance would exceed maxDistance.
+    bool myersDiff(const std::vector<Line>& a, size_t aBegin, size_t aEnd,
+                   const std::vector<Line>& b, size_t bBegin, size_t bEnd,
+                   size_t maxDistance, std::vector<Edit>& edits) {
+        const ptrdiff_t n = static_cast<ptrdiff_t>(aEnd - aBegin);
+        const ptrdiff_t m = static_cast<ptrdiff_t>(bEnd - bBegin);
+        const ptrdiff_t maxD = std::min<ptrdiff_t>(static_cast<ptrdiff_t>(maxDistance), n + m);
+        const ptrdiff_t offset = maxD + 1;
+
+        std::vector<ptrdiff_t> v(static_cast<size_t>(2 * maxD + 3), 0);
+        std::vector<std::vector<ptrdiff_t>> trace; // trace[d][k + d] for k in [-d, d]
+        ptrdiff_t distance = -1;
+        for (ptrdiff_t d = 0; d <= maxD && distance < 0; ++d) {
+            for (ptrdiff_t k = -d; k <= d; k += 2) {
+                ptrdiff_t x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ?
+                    v[offset + k + 1] : v[offset + k - 1] + 1;
+                ptrdiff_t y = x - k;
+                while (x < n && y < m && sameLine(a[aBegin + x], b[bBegin + y])) {
+                    x++;
+                    y++;
+                }
+                v[offset + k] = x;
+                if (x >= n && y >= m) {
+                    distance = d;
+                    break;
+                }
+            }
+            trace.emplace_back(v.begin() + (offset - d), v.begin() + (offset + d + 1));
+        }
+        if (distance < 0) {
+            return false;
+        }
+
+        // Walk back from the end, emitting edits in reverse
+        std::vector<Edit> reversed;
+        ptrdiff_t x = n;
+        ptrdiff_t y = m;
+        for (ptrdiff_t d = distance; d > 0; --d) {
+            const std::vector<ptrdiff_t>& previous = trace[static_cast<size_t>(d - 1)];
+            auto at = [&previous, d](ptrdiff_t k) { return previous[static_cast<size_t>(k + d - 1)]; };
+            ptrdiff_t k = x - y;
+            bool down = k == -d || (k != d && at(k - 1) < at(k + 1));
+            ptrdiff_t previousK = down ? k + 1 : k - 1;
+            ptrdiff_t previousX = at(previousK);
+            ptrdiff_t previousY = previousX - previousK;
+            ptrdiff_t snakeX = down ? previousX : previousX + 1;
+            ptrdiff_t snakeY = down ? previousY + 1 : previousY;
+
+            while (x > snakeX && y > snakeY) {
+                x--;
+                y--;
+                reversed.push_back({EditType::KEEP, aBegin + x, bBegin + y});
+            }
+            if (down) {
+                reversed.push_back({EditType::ADD, aBegin + previousX, bBegin + previousY});
+            } else {
+                reversed.push_back({EditType::REMOVE, aBegin + previousX, bBegin + previousY});
+            }
+            x = previousX;
+            y = previousY;
+        }
+        while (x > 0 && y > 0) {
+            x--;
+            y--;
+            reversed.push_back({EditType::KEEP, aBegin + x, bBegin + y});
+        }
+
+        edits.insert(edits.end(), reversed.rbegin(), reversed.rend());
+        return true;
+    }
+
+    void appendLine(std::string& out, char marker, std::string_view text, size_t maxLength) {
+        out += marker;
+        if (text.size() > maxLength) {
+            out.append(text.substr(0, maxLength));
+            out += "...";
+        } else {
+            out.append(text);
+        }
+        out += '\n';
+    }
+
+    // "start,length" in unified-diff convention (1-based; an empty range
+    // names the line before it)
+    std::string range(size_t start, size_t length) {
+        if (length == 1) {
+            return std::to_string(start + 1);
+        }
+        return std::to_string(length == 0 ? start : start + 1) + "," + std::to_string(length);
+    }
+}
+
+std::string OutputDiff::unified(std::string_view expected, std::string_view actual,
+                                const DiffOptions& options) {
+    std::vector<Line> a = splitLines(expected);
+    std::vector<Line> b = splitLines(actual);
+
+    size_t prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && sameLine(a[prefix], b[prefix])) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+           sameLine(a[a.size() - 1 - suffix], b[b.size() - 1 - suffix])) {
+        suffix++;
+    }
+    if (prefix == a.size() && prefix == b.size()) {
+        return "";
+    }
+
+    const size_t context = options.contextLines;
+    std::string out = "--- expected\n+++ actual\n";
+
+    // Leading context, the diffed middle, trailing context
+    std::vector<Edit> edits;
+    for (size_t i = prefix - std::min(prefix, context); i < prefix; ++i) {
+        edits.push_back({EditType::KEEP, i, i});
+    }
+    size_t middleLines = (a.size() - suffix - prefix) + (b.size() - suffix - prefix);
+    bool complete = middleLines <= options.maxDiffLines &&
+        myersDiff(a, prefix, a.size() - suffix, b, prefix, b.size() - suffix,
+                  options.maxEditDistance, edits);
+
+    if (!complete) {
+        out += "@@ first difference at line " + std::to_string(prefix + 1) +
+               "; outputs differ too much for a full diff @@\n";
+        for (size_t i = prefix - std::min(prefix, context); i < prefix; ++i) {
+            appendLine(out, ' ', a[i].text, options.maxLineLength);
+        }
+        if (prefix < a.size()) {
+            appendLine(out, '-', a[prefix].text, options.maxLineLength);
+        }
+        if (prefix < b.size()) {
+            appendLine(out, '+', b[prefix].text, options.maxLineLength);
+        }
+        return out;
+    }
+
+    for (size_t i = 0; i < std::min(suffix, context); ++i) {
+        edits.push_back({EditType::KEEP, a.size() - suffix + i, b.size() - suffix + i});
+    }
+
+    // Group changes separated by at most 2 * context unchanged lines into hunks
+    size_t emitted = 0;
+    size_t omitted = 0;
+    size_t position = 0;
+    while (position < edits.size()) {
+        size_t first = position;
+        while (first < edits.size() && edits[first].type == EditType::KEEP) {
+            first++;
+        }
+        if (first == edits.size()) {
+            break;
+        }
+        size_t last = first;
+        for (size_t j = first + 1; j < edits.size();) {
+            if (edits[j].type != EditType::KEEP) {
+                last = j++;
+                continue;
+            }
+            size_t runEnd = j;
+            while (runEnd < edits.size() && edits[runEnd].type == EditType::KEEP) {
+                runEnd++;
+            }
+            if (runEnd == edits.size() || runEnd - j > 2 * context) {
+                break;
+            }
+            j = runEnd;
+        }
+        size_t hunkBegin = first - std::min(context, first - position);
+        size_t hunkEnd = std::min(edits.size(), last + 1 + context);
+
+        size_t expectedLength = 0;
+        size_t actualLength = 0;
+        for (size_t i = hunkBegin; i < hunkEnd; ++i) {
+            expectedLength += edits[i].type != EditType::ADD;
+            actualLength += edits[i].type != EditType::REMOVE;
+        }
+        if (emitted < options.maxOutputLines) {
+            out += "@@ -" + range(edits[hunkBegin].expectedLine, expectedLength) +
+                   " +" + range(edits[hunkBegin].actualLine, actualLength) + " @@\n";
+        }
+        for (size_t i = hunkBegin; i < hunkEnd; ++i) {
+            if (emitted >= options.maxOutputLines) {
+                omitted++;
+                continue;
+            }
+            const Edit& edit = edits[i];
+            switch (edit.type) {
+                case EditType::KEEP:
+                    appendLine(out, ' ', a[edit.expectedLine].text, options.maxLineLength);
+                    break;
+                case EditType::REMOVE:
+                    appendLine(out, '-', a[edit.expectedLine].text, options.maxLineLength);
+                    break;
+                case EditType::ADD:
+                    appendLine(out, '+', b[edit.actualLine].text, options.maxLineLength);
+                    break;
+            }
+            emitted++;
+        }
+        position = hunkEnd;
+    }
+
+    if (omitted > 0) {
+        out += "... " + std::to_string(omitted) + " more diff lines\n";
+    }
+    return out;
+}
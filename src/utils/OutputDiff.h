@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+struct DiffOptions {
+    size_t contextLines;      // unchanged lines shown around each change
+    size_t maxEditDistance;   // Myers search depth; beyond it only the first difference is shown
+    size_t maxDiffLines;      // lines left after trimming common ends; beyond it likewise
+    size_t maxOutputLines;    // diff lines emitted before the rest is summarized
+    size_t maxLineLength;     // longer lines are clipped
+
+    DiffOptions()
+        : contextLines(3), maxEditDistance(200), maxDiffLines(20000), maxOutputLines(60),
+          maxLineLength(200) {}
+};
+
+// Line-level unified diff of expected against actual program output, for
+// failure feedback. Lines are compared by precomputed hashes (ignoring
+// trailing whitespace and trailing blank lines), common leading and trailing
+// lines are trimmed, and the rest is diffed with Myers' O(ND) algorithm.
+// Search depth, input size and output size are all bounded, so a pathological
+// output degrades to showing the first difference instead of stalling a report.
+class OutputDiff {
+public:
+    // Empty when the outputs have the same lines
+    static std::string unified(std::string_view expected, std::string_view actual,
+                               const DiffOptions& options = DiffOptions());
+};
@@ -0,0 +1,364 @@
+#include "ReferenceOutputCache.h"
+#include "ContentHash.h"
+#include "FixtureStore.h"
+#include "WorkStealingPool.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+    std::string hexHash(uint64_t hash) {
+        char digits[17];
+        std::snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+        return digits;
+    }
+
+    // Host name, CPU model and core count: what makes timings from one
+    // grading host meaningless on another
+    std::string hostFingerprint() {
+        std::string host;
+#ifdef _WIN32
+        if (const char* name = std::getenv("COMPUTERNAME")) {
+            host = name;
+        }
+#else
+        char name[256] = {};
+        if (gethostname(name, sizeof(name) - 1) == 0) {
+            host = name;
+        }
+#endif
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 10, "model name") == 0) {
+                host += "|" + line;
+                break;
+            }
+        }
+        host += "|" + std::to_string(std::thread::hardware_concurrency());
+        return hexHash(contentHash(host));
+    }
+
+    // Write then rename so a concurrent grader never reads a partial entry
+    void writeEntry(const std::string& path, const std::string& contents) {
+        std::string partialPath = path + ".partial";
+        {
+            std::ofstream file(partialPath, std::ios::binary);
+            if (!file.is_open()) {
+                return;
+            }
+            file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            if (!file) {
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(partialPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(partialPath, ec);
+        }
+    }
+}
+
+ReferenceOutputCache::ReferenceOutputCache(std::unique_ptr<CodeCompiler> compiler,
+                                           const std::string& cacheDirectory)
+    : compiler(compiler ? std::move(compiler) : std::make_unique<CodeCompiler>()),
+      cacheDirectory(cacheDirectory), hostKey(hostFingerprint()), hits(0), misses(0) {
+    if (!this->cacheDirectory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(this->cacheDirectory, ec);
+    }
+}
+
+std::string ReferenceOutputCache::solutionKeyFor(const std::string& solutionCode) const {
+    return hexHash(contentHash(solutionCode)) + "-" + hexHash(contentHash(compiler->getProfile()));
+}
+
+ReferenceOutput ReferenceOutputCache::getOutput(const std::string& solutionCode,
+                                                const SharedText& input) {
+    std::string solutionKey = solutionKeyFor(solutionCode);
+    std::string key = solutionKey + "-" + hexHash(contentHash(input));
+
+    std::promise<ReferenceOutput> promise;
+    std::shared_future<ReferenceOutput> future;
+    bool owner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = outputs.find(key);
+        if (it != outputs.end()) {
+            hits++;
+            future = it->second;
+        } else {
+            misses++;
+            future = promise.get_future().share();
+            outputs.emplace(key, future);
+            owner = true;
+        }
+    }
+
+    // Concurrent requests for the same key wait on the first one
+    if (owner) {
+        ReferenceOutput result;
+        if (!loadFromDisk(key, result)) {
+            result = generate(solutionCode, solutionKey, input);
+            if (result.success) {
+                saveToDisk(key, result.output);
+            }
+        }
+        promise.set_value(result);
+        // Waiters already holding the future see this failure; the next
+        // request tries again
+        if (!result.success) {
+            std::lock_guard<std::mutex> lock(mutex);
+            outputs.erase(key);
+        }
+    }
+    return future.get();
+}
+
+void ReferenceOutputCache::setTimeLimitCalibration(const TimeLimitCalibration& calibration) {
+    this->calibration = calibration;
+}
+
+ReferenceTiming ReferenceOutputCache::getReferenceTime(const std::string& solutionCode,
+                                                       const SharedText& input) {
+    std::string solutionKey = solutionKeyFor(solutionCode);
+    std::string key = solutionKey + "-" + hexHash(contentHash(input)) + "-" + hostKey;
+
+    std::promise<ReferenceTiming> promise;
+    std::shared_future<ReferenceTiming> future;
+    bool owner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = timings.find(key);
+        if (it != timings.end()) {
+            future = it->second;
+        } else {
+            future = promise.get_future().share();
+            timings.emplace(key, future);
+            owner = true;
+        }
+    }
+
+    if (owner) {
+        ReferenceTiming result;
+        if (!loadTimingFromDisk(key, result)) {
+            result = measure(solutionCode, solutionKey, input);
+            if (result.success) {
+                saveTimingToDisk(key, result.seconds);
+            }
+        }
+        promise.set_value(result);
+        if (!result.success) {
+            std::lock_guard<std::mutex> lock(mutex);
+            timings.erase(key);
+        }
+    }
+    return future.get();
+}
+
+bool ReferenceOutputCache::needsResolving(const Exercise& exercise) const {
+    return exercise.hasReferenceTestCases() || 
+           (calibration.enabled && !exercise.getSolutionCode().empty());
+}
+
+bool ReferenceOutputCache::resolveTestCases(const Exercise& exercise, std::vector<TestCase>& testCases,
+                                            std::string& errorMessage) {
+    testCases = exercise.getTestCases();
+    bool calibrate = calibration.enabled && !exercise.getSolutionCode().empty();
+    for (TestCase& testCase : testCases) {
+        if (testCase.expectedFromReference) {
+            if (exercise.getSolutionCode().empty()) {
+                errorMessage = "Exercise has no reference solution";
+                return false;
+            }
+
+            ReferenceOutput reference = getOutput(exercise.getSolutionCode(), testCase.input);
+            if (!reference.success) {
+                errorMessage = reference.errorMessage;
+                return false;
+            }
+            testCase.expectedOutput = reference.output;
+        }
+
+        // Limits set by hand win over calibrated ones
+        if (calibrate && testCase.timeLimitSeconds == 0.0) {
+            ReferenceTiming timing = getReferenceTime(exercise.getSolutionCode(), testCase.input);
+            if (timing.success) {
+                testCase.timeLimitSeconds = calibration.limitFor(timing.seconds);
+            }
+        }
+    }
+    return true;
+}
+
+size_t ReferenceOutputCache::warmUp(const std::vector<const Exercise*>& exercises, unsigned int workers) {
+    std::vector<std::pair<const std::string*, const SharedText*>> work;
+    std::vector<std::pair<const std::string*, const SharedText*>> timingWork;
+    for (const Exercise* exercise : exercises) {
+        if (exercise->getSolutionCode().empty()) {
+            continue;
+        }
+        for (const TestCase& testCase : exercise->getTestCases()) {
+            if (testCase.expectedFromReference) {
+                work.emplace_back(&exercise->getSolutionCode(), &testCase.input);
+            }
+            if (calibration.enabled && testCase.timeLimitSeconds == 0.0) {
+                timingWork.emplace_back(&exercise->getSolutionCode(), &testCase.input);
+            }
+        }
+    }
+
+    // Each solution is built once by whichever task reaches it first
+    WorkStealingPool pool(workers);
+    for (const auto& item : work) {
+        pool.submit([this, item]() { getOutput(*item.first, *item.second); });
+    }
+    for (const auto& item : timingWork) {
+        pool.submit([this, item]() { getReferenceTime(*item.first, *item.second); });
+    }
+    pool.wait();
+    return work.size() + timingWork.size();
+}
+
+size_t ReferenceOutputCache::getHitCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t ReferenceOutputCache::getMissCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+CompilationResult ReferenceOutputCache::buildSolution(const std::string& solutionCode,
+                                                      const std::string& solutionKey) {
+    std::promise<CompilationResult> promise;
+    std::shared_future<CompilationResult> future;
+    bool owner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = builds.find(solutionKey);
+        if (it != builds.end()) {
+            future = it->second;
+        } else {
+            future = promise.get_future().share();
+            builds.emplace(solutionKey, future);
+            owner = true;
+        }
+    }
+
+    if (owner) {
+        CompilationResult build = compiler->compileCode(solutionCode, "reference_" + solutionKey + ".cpp");
+        promise.set_value(build);
+        if (!build.success) {
+            std::lock_guard<std::mutex> lock(mutex);
+            builds.erase(solutionKey);
+        }
+    }
+    return future.get();
+}
+
+ReferenceOutput ReferenceOutputCache::generate(const std::string& solutionCode,
+                                               const std::string& solutionKey,
+                                               const SharedText& input) {
+    ReferenceOutput result;
+    CompilationResult build = buildSolution(solutionCode, solutionKey);
+    if (!build.success) {
+        result.errorMessage = "Reference solution failed to compile";
+        return result;
+    }
+
+    ExecutionResult execution = compiler->executeWithInput(build.executablePath, input);
+    if (!execution.success) {
+        result.errorMessage = "Reference solution failed (exit code " +
+                              std::to_string(execution.exitCode) + ")";
+        return result;
+    }
+
+    result.success = true;
+    result.output = SharedText(std::move(execution.output));
+    return result;
+}
+
+ReferenceTiming ReferenceOutputCache::measure(const std::string& solutionCode,
+                                              const std::string& solutionKey,
+                                              const SharedText& input) {
+    ReferenceTiming result;
+    CompilationResult build = buildSolution(solutionCode, solutionKey);
+    if (!build.success) {
+        result.errorMessage = "Reference solution failed to compile";
+        return result;
+    }
+
+    std::vector<double> samples;
+    for (int run = 0; run < std::max(calibration.runs, 1); ++run) {
+        ExecutionResult execution = compiler->executeWithInput(build.executablePath, input);
+        if (!execution.success) {
+            result.errorMessage = "Reference solution failed (exit code " +
+                                  std::to_string(execution.exitCode) + ")";
+            return result;
+        }
+        samples.push_back(execution.executionTime);
+    }
+
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    result.success = true;
+    result.seconds = samples[samples.size() / 2];
+    return result;
+}
+
+bool ReferenceOutputCache::loadFromDisk(const std::string& key, ReferenceOutput& result) const {
+    if (cacheDirectory.empty()) {
+        return false;
+    }
+
+    // Entries are replaced by rename only, so the mapping stays valid
+    if (!FixtureStore::mapFile(cacheDirectory + "/" + key + ".out", result.output)) {
+        return false;
+    }
+    result.success = true;
+    return true;
+}
+
+void ReferenceOutputCache::saveToDisk(const std::string& key, const std::string& output) const {
+    if (cacheDirectory.empty()) {
+        return;
+    }
+    writeEntry(cacheDirectory + "/" + key + ".out", output);
+}
+
+bool ReferenceOutputCache::loadTimingFromDisk(const std::string& key, ReferenceTiming& result) const {
+    if (cacheDirectory.empty()) {
+        return false;
+    }
+
+    std::ifstream file(cacheDirectory + "/" + key + ".time");
+    double seconds = 0.0;
+    if (!(file >> seconds) || seconds < 0.0) {
+        return false;
+    }
+    result.success = true;
+    result.seconds = seconds;
+    return true;
+}
+
+void ReferenceOutputCache::saveTimingToDisk(const std::string& key, double seconds) const {
+    if (cacheDirectory.empty()) {
+        return;
+    }
+
+    std::ostringstream text;
+    text.precision(9);
+    text << seconds << "\n";
+    writeEntry(cacheDirectory + "/" + key + ".time", text.str());
+}
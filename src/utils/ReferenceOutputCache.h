@@ -0,0 +1,110 @@
+#pragma once
+#include "CodeCompiler.h"
+#include "SharedText.h"
+#include "../core/Exercise.h"
+#include <algorithm>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ReferenceOutput {
+    bool success;
+    SharedText output;
+    std::string errorMessage;
+
+    ReferenceOutput() : success(false) {}
+};
+
+// Median wall time of the reference solution on one input, on this host
+struct ReferenceTiming {
+    bool success;
+    double seconds;
+    std::string errorMessage;
+
+    ReferenceTiming() : success(false), seconds(0.0) {}
+};
+
+// Per-test time limits derived from the reference solution's running time
+// instead of one fixed timeout. Timings are measured once per host (told
+// apart by name, CPU model and core count), so graders on faster or slower
+// machines each get limits that fit them.
+struct TimeLimitCalibration {
+    bool enabled;
+    double multiplier;    // limit = multiplier x reference time ...
+    double floorSeconds;  // ... but never below this (process startup, scheduling noise)
+    int runs;             // reference runs per input; the median counts
+
+    TimeLimitCalibration() : enabled(false), multiplier(3.0), floorSeconds(0.5), runs(3) {}
+
+    double limitFor(double referenceSeconds) const {
+        return std::max(floorSeconds, multiplier * referenceSeconds);
+    }
+};
+
+// Expected outputs produced by compiling and running an exercise's reference
+// solution. Entries are keyed by (solution hash, input hash, compile
+// profile), computed at most once even under concurrent requests, and
+// optionally persisted to a directory so they survive grader restarts.
+// With time-limit calibration the reference is also timed on each input;
+// timings are additionally keyed by host.
+class ReferenceOutputCache {
+private:
+    std::unique_ptr<CodeCompiler> compiler;
+    std::string cacheDirectory;
+    std::mutex mutex;
+    std::map<std::string, std::shared_future<ReferenceOutput>> outputs;
+    std::map<std::string, std::shared_future<CompilationResult>> builds;
+    std::map<std::string, std::shared_future<ReferenceTiming>> timings;
+    TimeLimitCalibration calibration;
+    std::string hostKey;
+    size_t hits;
+    size_t misses;
+
+public:
+    explicit ReferenceOutputCache(std::unique_ptr<CodeCompiler> compiler = nullptr,
+                                  const std::string& cacheDirectory = "");
+
+    // Inputs backed by a fixture file are fed to the reference as they are
+    ReferenceOutput getOutput(const std::string& solutionCode, const SharedText& input);
+
+    // Set before grading starts
+    void setTimeLimitCalibration(const TimeLimitCalibration& calibration);
+    const TimeLimitCalibration& getTimeLimitCalibration() const { return calibration; }
+    ReferenceTiming getReferenceTime(const std::string& solutionCode, const SharedText& input);
+    // Identifies this machine in persisted timings
+    const std::string& getHostKey() const { return hostKey; }
+
+    // Copies of the exercise's test cases with generated expected outputs
+    // filled in (sharing the cached buffers) and, when calibrating, their
+    // time limits. Returns false with an error message if the reference
+    // solution could not produce an output; a test the reference can't be
+    // timed on keeps the runner's timeout.
+    bool resolveTestCases(const Exercise& exercise, std::vector<TestCase>& testCases,
+                          std::string& errorMessage);
+    // Whether resolveTestCases changes anything for this exercise
+    bool needsResolving(const Exercise& exercise) const;
+
+    // Generates every missing output (and timing, when calibrating) for the
+    // given exercises in parallel, e.g. at startup or ahead of an exam.
+    // Timings are taken under the same parallel load that grading sees.
+    // Returns the number of entries.
+    size_t warmUp(const std::vector<const Exercise*>& exercises, unsigned int workers = 0);
+
+    size_t getHitCount();
+    size_t getMissCount();
+
+private:
+    CompilationResult buildSolution(const std::string& solutionCode, const std::string& solutionKey);
+    ReferenceOutput generate(const std::string& solutionCode, const std::string& solutionKey,
+                             const SharedText& input);
+    ReferenceTiming measure(const std::string& solutionCode, const std::string& solutionKey,
+                            const SharedText& input);
+    bool loadTimingFromDisk(const std::string& key, ReferenceTiming& result) const;
+    void saveTimingToDisk(const std::string& key, double seconds) const;
+    bool loadFromDisk(const std::string& key, ReferenceOutput& result) const;
+    void saveToDisk(const std::string& key, const std::string& output) const;
+    std::string solutionKeyFor(const std::string& solutionCode) const;
+};
@@ -0,0 +1,451 @@
+#include "ReportWriter.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Length of the valid UTF-8 sequence starting at text[pos], 0 if invalid
+    size_t utf8SequenceLength(std::string_view text, size_t pos) {
+        unsigned char lead = static_cast<unsigned char>(text[pos]);
+        size_t length;
+        unsigned int minimum;
+        if (lead < 0x80) return 1;
+        if ((lead & 0xE0) == 0xC0) { length = 2; minimum = 0x80; }
+        else if ((lead & 0xF0) == 0xE0) { length = 3; minimum = 0x800; }
+        else if ((lead & 0xF8) == 0xF0) { length = 4; minimum = 0x10000; }
+        else return 0;
+
+        if (pos + length > text.size()) {
+            return 0;
+        }
+
+        unsigned int codePoint = lead & (0x3F >> (length - 1));
+        for (size_t i = 1; i < length; ++i) {
+            unsigned char next = static_cast<unsigned char>(text[pos + i]);
+            if ((next & 0xC0) != 0x80) {
+                return 0;
+            }
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+
+        bool surrogate = codePoint >= 0xD800 && codePoint <= 0xDFFF;
+        return (codePoint < minimum || codePoint > 0x10FFFF || surrogate) ? 0 : length;
+    }
+
+    const char* const replacementCharacter = "\xEF\xBF\xBD";
+}
+
+ReportWriter::ReportWriter(std::ostream& out, size_t bufferCapacity, size_t maxOutputBytes)
+    : out(out), bufferCapacity(bufferCapacity), maxOutputBytes(maxOutputBytes) {
+    buffer.reserve(bufferCapacity);
+}
+
+ReportWriter::~ReportWriter() {
+    flush();
+}
+
+void ReportWriter::writeSuite(const TestSuite& suite, std::string_view group) {
+    beginSuite(suite, group);
+    for (const TestResult& result : suite.results) {
+        writeResult(suite, result, group);
+    }
+    endSuite(suite, group);
+}
+
+void ReportWriter::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    out.flush();
+}
+
+void ReportWriter::append(std::string_view text) {
+    if (text.size() >= bufferCapacity) {
+        flush();
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return;
+    }
+    reserveFor(text.size());
+    buffer.append(text.data(), text.size());
+}
+
+void ReportWriter::append(char c) {
+    reserveFor(1);
+    buffer.push_back(c);
+}
+
+void ReportWriter::appendNumber(double value) {
+    if (!std::isfinite(value)) {
+        append("0");
+        return;
+    }
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%.6f", value);
+    append(std::string_view(digits, static_cast<size_t>(length)));
+}
+
+void ReportWriter::appendInteger(long long value) {
+    char digits[24];
+    int length = std::snprintf(digits, sizeof(digits), "%lld", value);
+    append(std::string_view(digits, static_cast<size_t>(length)));
+}
+
+void ReportWriter::appendJsonString(std::string_view text, bool capped) {
+    size_t omitted = 0;
+    if (capped && text.size() > maxOutputBytes) {
+        omitted = text.size() - maxOutputBytes;
+        text = text.substr(0, maxOutputBytes);
+    }
+
+    append('"');
+    size_t pos = 0;
+    while (pos < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        switch (c) {
+            case '"': append("\\\""); pos++; continue;
+            case '\\': append("\\\\"); pos++; continue;
+            case '\n': append("\\n"); pos++; continue;
+            case '\r': append("\\r"); pos++; continue;
+            case '\t': append("\\t"); pos++; continue;
+            default: break;
+        }
+
+        if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            append(escaped);
+            pos++;
+            continue;
+        }
+
+        size_t length = utf8SequenceLength(text, pos);
+        if (length == 0) {
+            append(replacementCharacter);
+            pos++;
+        } else {
+            append(text.substr(pos, length));
+            pos += length;
+        }
+    }
+
+    if (omitted > 0) {
+        append(" [truncated ");
+        appendInteger(static_cast<long long>(omitted));
+        append(" bytes]");
+    }
+    append('"');
+}
+
+void ReportWriter::appendXmlText(std::string_view text, bool capped) {
+    size_t omitted = 0;
+    if (capped && text.size() > maxOutputBytes) {
+        omitted = text.size() - maxOutputBytes;
+        text = text.substr(0, maxOutputBytes);
+    }
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        switch (c) {
+            case '&': append("&amp;"); pos++; continue;
+            case '<': append("&lt;"); pos++; continue;
+            case '>': append("&gt;"); pos++; continue;
+            case '"': append("&quot;"); pos++; continue;
+            case '\'': append("&apos;"); pos++; continue;
+            case '\n': case '\r': case '\t': append(static_cast<char>(c)); pos++; continue;
+            default: break;
+        }
+
+        // Other control characters are not allowed anywhere in XML 1.0
+        size_t length = c < 0x20 ? 0 : utf8SequenceLength(text, pos);
+        if (length == 0) {
+            append(replacementCharacter);
+            pos++;
+        } else {
+            append(text.substr(pos, length));
+            pos += length;
+        }
+    }
+
+    if (omitted > 0) {
+        append(" [truncated ");
+        appendInteger(static_cast<long long>(omitted));
+        append(" bytes]");
+    }
+}
+
+const char* ReportWriter::statusName(TestStatus status) {
+    switch (status) {
+        case TestStatus::PASSED: return "PASSED";
+        case TestStatus::FAILED: return "FAILED";
+        case TestStatus::ERROR: return "ERROR";
+        case TestStatus::TIMEOUT: return "TIMEOUT";
+        case TestStatus::SKIPPED: return "SKIPPED";
+        case TestStatus::CANCELLED: return "CANCELLED";
+    }
+    return "ERROR";
+}
+
+void ReportWriter::reserveFor(size_t bytes) {
+    if (buffer.size() + bytes > bufferCapacity) {
+        flush();
+    }
+}
+
+// JsonLinesReportWriter implementation
+void JsonLinesReportWriter::beginSuite(const TestSuite&, std::string_view) {}
+
+void JsonLinesReportWriter::writeResult(const TestSuite& suite, const TestResult& result,
+                                        std::string_view group) {
+    append("{\"type\":\"test\",\"suite\":");
+    appendJsonString(suite.suiteName);
+    if (!group.empty()) {
+        append(",\"group\":");
+        appendJsonString(group);
+    }
+    append(",\"name\":");
+    appendJsonString(result.testName);
+    append(",\"status\":\"");
+    append(statusName(result.status));
+    append("\",\"time\":");
+    appendNumber(result.executionTime);
+    append(",\"cpu_time\":");
+    appendNumber(result.cpuTime);
+    append(",\"peak_memory_kb\":");
+    appendInteger(result.peakMemoryKb);
+    append(",\"exit_code\":");
+    appendInteger(result.exitCode);
+    if (result.counters.available()) {
+        append(",\"instructions\":");
+        appendInteger(result.counters.instructions);
+        append(",\"cycles\":");
+        appendInteger(result.counters.cycles);
+        append(",\"cache_misses\":");
+        appendInteger(result.counters.cacheMisses);
+        append(",\"branch_misses\":");
+        appendInteger(result.counters.branchMisses);
+    }
+    if (result.heap.available) {
+        append(",\"heap\":{\"allocations\":");
+        appendInteger(static_cast<long long>(result.heap.allocations));
+        append(",\"frees\":");
+        appendInteger(static_cast<long long>(result.heap.frees));
+        append(",\"reallocations\":");
+        appendInteger(static_cast<long long>(result.heap.reallocations));
+        append(",\"bytes_allocated\":");
+        appendInteger(static_cast<long long>(result.heap.bytesAllocated));
+        append(",\"peak_live_bytes\":");
+        appendInteger(static_cast<long long>(result.heap.peakLiveBytes));
+        append(",\"leaked_allocations\":");
+        appendInteger(static_cast<long long>(result.heap.leakedAllocations));
+        append(",\"leaked_bytes\":");
+        appendInteger(static_cast<long long>(result.heap.leakedBytes));
+        append("}");
+    }
+    if (result.checkerScore >= 0.0) {
+        append(",\"score\":");
+        appendNumber(result.checkerScore);
+        append(",\"checker_time\":");
+        appendNumber(result.checkerTime);
+    }
+
+    // Fixtures and output only where they help explain a failure
+    if (result.status != TestStatus::PASSED && result.status != TestStatus::SKIPPED &&
+        result.status != TestStatus::CANCELLED) {
+        append(",\"input\":");
+        appendJsonString(result.input, true);
+        append(",\"expected\":");
+        appendJsonString(result.expectedOutput, true);
+        append(",\"actual\":");
+        appendJsonString(result.actualOutput, true);
+    }
+    if (!result.errorMessage.empty()) {
+        append(",\"error\":");
+        appendJsonString(result.errorMessage, true);
+    }
+    if (!result.sanitizerFindings.empty()) {
+        append(",\"sanitizer_findings\":[");
+        for (size_t i = 0; i < result.sanitizerFindings.size(); ++i) {
+            const SanitizerFinding& finding = result.sanitizerFindings[i];
+            append(i == 0 ? "{\"sanitizer\":" : ",{\"sanitizer\":");
+            appendJsonString(SanitizerReportParser::kindName(finding.sanitizer));
+            append(",\"category\":");
+            appendJsonString(finding.category);
+            append(",\"message\":");
+            appendJsonString(finding.message, true);
+            append(",\"file\":");
+            appendJsonString(finding.file);
+            append(",\"line\":");
+            appendInteger(finding.line);
+            append(",\"column\":");
+            appendInteger(finding.column);
+            append('}');
+        }
+        append(']');
+    }
+    append("}\n");
+}
+
+void JsonLinesReportWriter::endSuite(const TestSuite& suite, std::string_view group) {
+    append("{\"type\":\"suite\",\"suite\":");
+    appendJsonString(suite.suiteName);
+    if (!group.empty()) {
+        append(",\"group\":");
+        appendJsonString(group);
+    }
+    append(",\"tests\":");
+    appendInteger(static_cast<long long>(suite.results.size()));
+    append(",\"passed\":");
+    appendInteger(suite.passedCount);
+    append(",\"failed\":");
+    appendInteger(suite.failedCount);
+    append(",\"errors\":");
+    appendInteger(suite.errorCount);
+    append(",\"skipped\":");
+    appendInteger(suite.skippedCount);
+    if (suite.cancelledCount > 0) {
+        append(",\"cancelled\":");
+        appendInteger(suite.cancelledCount);
+    }
+    append(",\"time\":");
+    appendNumber(suite.totalTime);
+    append(",\"wall_time\":");
+    appendNumber(suite.wallTime);
+    append(",\"cpu_time\":");
+    appendNumber(suite.cpuTime);
+    if (suite.checkerTime > 0.0) {
+        append(",\"checker_time\":");
+        appendNumber(suite.checkerTime);
+    }
+    append("}\n");
+}
+
+// JUnitReportWriter implementation
+JUnitReportWriter::JUnitReportWriter(std::ostream& out, size_t bufferCapacity, size_t maxOutputBytes)
+    : ReportWriter(out, bufferCapacity, maxOutputBytes), opened(false), closed(false) {}
+
+JUnitReportWriter::~JUnitReportWriter() {
+    finish();
+}
+
+void JUnitReportWriter::finish() {
+    if (!closed) {
+        open();
+        append("</testsuites>\n");
+        closed = true;
+    }
+    flush();
+}
+
+void JUnitReportWriter::open() {
+    if (!opened) {
+        append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n");
+        opened = true;
+    }
+}
+
+void JUnitReportWriter::beginSuite(const TestSuite& suite, std::string_view group) {
+    open();
+    append("  <testsuite name=\"");
+    appendXmlText(suite.suiteName);
+    if (!group.empty()) {
+        append("\" package=\"");
+        appendXmlText(group);
+    }
+    append("\" tests=\"");
+    appendInteger(static_cast<long long>(suite.results.size()));
+    append("\" failures=\"");
+    appendInteger(suite.failedCount);
+    append("\" errors=\"");
+    appendInteger(suite.errorCount);
+    append("\" skipped=\"");
+    appendInteger(suite.skippedCount + suite.cancelledCount);
+    append("\" time=\"");
+    appendNumber(suite.wallTime);
+    append("\">\n");
+}
+
+void JUnitReportWriter::writeResult(const TestSuite& suite, const TestResult& result,
+                                    std::string_view group) {
+    append("    <testcase name=\"");
+    appendXmlText(result.testName);
+    append("\" classname=\"");
+    appendXmlText(group.empty() ? std::string_view(suite.suiteName) : group);
+    append("\" time=\"");
+    appendNumber(result.executionTime);
+    append("\">\n");
+
+    append("      <properties>\n        <property name=\"cpu_time\" value=\"");
+    appendNumber(result.cpuTime);
+    append("\"/>\n        <property name=\"peak_memory_kb\" value=\"");
+    appendInteger(result.peakMemoryKb);
+    append("\"/>\n        <property name=\"exit_code\" value=\"");
+    appendInteger(result.exitCode);
+    if (result.counters.available()) {
+        append("\"/>\n        <property name=\"instructions\" value=\"");
+        appendInteger(result.counters.instructions);
+        append("\"/>\n        <property name=\"cycles\" value=\"");
+        appendInteger(result.counters.cycles);
+        append("\"/>\n        <property name=\"cache_misses\" value=\"");
+        appendInteger(result.counters.cacheMisses);
+        append("\"/>\n        <property name=\"branch_misses\" value=\"");
+        appendInteger(result.counters.branchMisses);
+    }
+    if (result.heap.available) {
+        append("\"/>\n        <property name=\"heap_allocations\" value=\"");
+        appendInteger(static_cast<long long>(result.heap.allocations));
+        append("\"/>\n        <property name=\"heap_peak_live_bytes\" value=\"");
+        appendInteger(static_cast<long long>(result.heap.peakLiveBytes));
+        append("\"/>\n        <property name=\"heap_leaked_allocations\" value=\"");
+        appendInteger(static_cast<long long>(result.heap.leakedAllocations));
+        append("\"/>\n        <property name=\"heap_leaked_bytes\" value=\"");
+        appendInteger(static_cast<long long>(result.heap.leakedBytes));
+    }
+    if (result.checkerScore >= 0.0) {
+        append("\"/>\n        <property name=\"checker_score\" value=\"");
+        appendNumber(result.checkerScore);
+        append("\"/>\n        <property name=\"checker_time\" value=\"");
+        appendNumber(result.checkerTime);
+    }
+    append("\"/>\n      </properties>\n");
+
+    if (result.status == TestStatus::FAILED) {
+        append("      <failure message=\"");
+        appendXmlText(result.errorMessage.empty() ? "Output mismatch" : result.errorMessage, true);
+        append("\">Input:\n");
+        appendXmlText(result.input, true);
+        append("\nExpected:\n");
+        appendXmlText(result.expectedOutput, true);
+        append("\nActual:\n");
+        appendXmlText(result.actualOutput, true);
+        append("</failure>\n");
+    } else if (result.status == TestStatus::ERROR || result.status == TestStatus::TIMEOUT) {
+        append("      <error message=\"");
+        appendXmlText(result.status == TestStatus::TIMEOUT ? std::string_view("Timed out") :
+                      std::string_view(result.errorMessage), true);
+        append("\" type=\"");
+        append(statusName(result.status));
+        append("\">");
+        appendXmlText(result.actualOutput, true);
+        append("</error>\n");
+    } else if (result.status == TestStatus::SKIPPED || result.status == TestStatus::CANCELLED) {
+        append("      <skipped message=\"");
+        appendXmlText(result.errorMessage, true);
+        append("\"/>\n");
+    }
+
+    if (!result.sanitizerFindings.empty()) {
+        append("      <system-err>");
+        for (const SanitizerFinding& finding : result.sanitizerFindings) {
+            appendXmlText(SanitizerReportParser::format(finding), true);
+            append('\n');
+        }
+        append("</system-err>\n");
+    }
+
+    append("    </testcase>\n");
+}
+
+void JUnitReportWriter::endSuite(const TestSuite&, std::string_view) {
+    append("  </testsuite>\n");
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "TestRunner.h"
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Streams machine-readable test reports into a reusable buffer that is
+// flushed to the output whenever it fills, so memory stays bounded no matter
+// how many suites are written. Student output is escaped on the fly and
+// capped at maxOutputBytes per field; invalid UTF-8 is replaced with U+FFFD.
+class ReportWriter {
+protected:
+    std::ostream& out;
+    std::string buffer;
+    size_t bufferCapacity;
+    size_t maxOutputBytes;
+
+public:
+    explicit ReportWriter(std::ostream& out, size_t bufferCapacity = 64 * 1024,
+                          size_t maxOutputBytes = 64 * 1024);
+    virtual ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    // group names what the suite belongs to, e.g. the exercise ID
+    void writeSuite(const TestSuite& suite, std::string_view group = std::string_view());
+    virtual void finish() { flush(); }
+    void flush();
+
+    void setMaxOutputBytes(size_t bytes) { maxOutputBytes = bytes; }
+
+protected:
+    virtual void beginSuite(const TestSuite& suite, std::string_view group) = 0;
+    virtual void writeResult(const TestSuite& suite, const TestResult& result,
+                             std::string_view group) = 0;
+    virtual void endSuite(const TestSuite& suite, std::string_view group) = 0;
+
+    void append(std::string_view text);
+    void append(char c);
+    void appendNumber(double value);
+    void appendInteger(long long value);
+    void appendJsonString(std::string_view text, bool capped = false);
+    void appendXmlText(std::string_view text, bool capped = false);
+
+    static const char* statusName(TestStatus status);
+
+private:
+    void reserveFor(size_t bytes);
+};
+
+// One JSON object per line: a "test" record per result followed by a
+// "suite" summary record.
+class JsonLinesReportWriter : public ReportWriter {
+public:
+    using ReportWriter::ReportWriter;
+
+protected:
+    void beginSuite(const TestSuite& suite, std::string_view group) override;
+    void writeResult(const TestSuite& suite, const TestResult& result,
+                     std::string_view group) override;
+    void endSuite(const TestSuite& suite, std::string_view group) override;
+};
+
+// JUnit XML as understood by common CI dashboards. The <testsuites> root is
+// opened with the first suite and closed by finish() (or the destructor).
+class JUnitReportWriter : public ReportWriter {
+private:
+    bool opened;
+    bool closed;
+
+public:
+    explicit JUnitReportWriter(std::ostream& out, size_t bufferCapacity = 64 * 1024,
+                               size_t maxOutputBytes = 64 * 1024);
+    ~JUnitReportWriter() override;
+
+    void finish() override;
+
+protected:
+    void beginSuite(const TestSuite& suite, std::string_view group) override;
+    void writeResult(const TestSuite& suite, const TestResult& result,
+                     std::string_view group) override;
+    void endSuite(const TestSuite& suite, std::string_view group) override;
+
+private:
+    void open();
+};
@@ -0,0 +1,214 @@
+#include "SanitizerReport.h"
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+    struct UndefinedCategory {
+        const char* phrase;
+        const char* category;
+    };
+
+    // Checked in order against the text after "runtime error: "
+    constexpr UndefinedCategory undefinedCategories[] = {
+        {"signed integer overflow", "signed-integer-overflow"},
+        {"division by zero", "division-by-zero"},
+        {"shift exponent", "invalid-shift"},
+        {"left shift", "invalid-shift"},
+        {"out of bounds for type", "array-index-out-of-bounds"},
+        {"null pointer", "null-pointer-use"},
+        {"misaligned address", "misaligned-access"},
+        {"insufficient space", "insufficient-object-size"},
+        {"is not a valid value for type", "invalid-value"},
+        {"outside the range of representable values", "float-cast-overflow"},
+        {"reached the end of a value-returning function", "missing-return"},
+        {"reached an unreachable program point", "unreachable"},
+        {"pointer overflow", "pointer-overflow"},
+    };
+
+    bool startsWith(std::string_view text, std::string_view prefix) {
+        return text.substr(0, prefix.size()) == prefix;
+    }
+
+    std::string_view trim(std::string_view text) {
+        size_t start = text.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos) {
+            return std::string_view();
+        }
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(start, end - start + 1);
+    }
+
+    // Parses "path:line[:column]" at the end of text
+    bool parseLocation(std::string_view text, std::string& file, int& line, int& column) {
+        std::string_view location = trim(text);
+        size_t space = location.find_last_of(' ');
+        if (space != std::string_view::npos) {
+            location = location.substr(space + 1);
+        }
+
+        // Peel up to two trailing ":<number>" fields
+        int numbers[2] = {0, 0};
+        int count = 0;
+        while (count < 2) {
+            size_t colon = location.rfind(':');
+            if (colon == std::string_view::npos || colon + 1 >= location.size()) {
+                break;
+            }
+            std::string_view digits = location.substr(colon + 1);
+            bool numeric = true;
+            for (char c : digits) {
+                numeric = numeric && std::isdigit(static_cast<unsigned char>(c));
+            }
+            if (!numeric) {
+                break;
+            }
+            numbers[count++] = std::atoi(std::string(digits).c_str());
+            location = location.substr(0, colon);
+        }
+        if (count == 0 || location.empty()) {
+            return false;
+        }
+
+        file = std::string(location);
+        line = count == 2 ? numbers[1] : numbers[0];
+        column = count == 2 ? numbers[0] : 0;
+        return true;
+    }
+
+    // A stack frame such as "#1 0x5582bc80d505 in main /tmp/solution.cpp:3:7"
+    bool isProgramFrame(std::string_view line, std::string& file, int& lineNumber, int& column) {
+        std::string_view frame = trim(line);
+        if (!startsWith(frame, "#") || frame.find(" in ") == std::string_view::npos) {
+            return false;
+        }
+        if (!parseLocation(frame, file, lineNumber, column)) {
+            return false;
+        }
+        // Runtime and library frames don't tell the student anything
+        return file.find("libsanitizer") == std::string::npos && !startsWith(file, "/usr/") &&
+               file.find(".so") == std::string::npos && file.front() != '(';
+    }
+
+    bool sameProblem(const SanitizerFinding& a, const SanitizerFinding& b) {
+        return a.sanitizer == b.sanitizer && a.category == b.category &&
+               a.file == b.file && a.line == b.line && a.column == b.column;
+    }
+}
+
+std::vector<SanitizerFinding> SanitizerReportParser::parse(std::string_view diagnostics) {
+    std::vector<SanitizerFinding> findings;
+    SanitizerFinding pending;
+    bool awaitingFrame = false;
+
+    auto commit = [&findings](const SanitizerFinding& finding) {
+        for (const SanitizerFinding& existing : findings) {
+            if (sameProblem(existing, finding)) {
+                return;
+            }
+        }
+        findings.push_back(finding);
+    };
+
+    size_t pos = 0;
+    while (pos < diagnostics.size()) {
+        size_t end = diagnostics.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = diagnostics.size();
+        }
+        std::string_view line = diagnostics.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t runtimeError = line.find(": runtime error: ");
+        size_t asanError = line.find("ERROR: AddressSanitizer: ");
+        size_t leak = std::string_view::npos;
+        if (startsWith(line, "Direct leak of") || startsWith(line, "Indirect leak of")) {
+            leak = 0;
+        }
+
+        if (runtimeError != std::string_view::npos) {
+            if (awaitingFrame) {
+                commit(pending);
+                awaitingFrame = false;
+            }
+            SanitizerFinding finding;
+            finding.sanitizer = SanitizerKind::UNDEFINED;
+            finding.message = std::string(trim(line.substr(runtimeError + 17)));
+            finding.category = "undefined-behavior";
+            for (const UndefinedCategory& known : undefinedCategories) {
+                if (finding.message.find(known.phrase) != std::string::npos) {
+                    finding.category = known.category;
+                    break;
+                }
+            }
+            parseLocation(line.substr(0, runtimeError), finding.file, finding.line, finding.column);
+            commit(finding);
+        } else if (asanError != std::string_view::npos) {
+            if (awaitingFrame) {
+                commit(pending);
+            }
+            std::string_view description = trim(line.substr(asanError + 25));
+            pending = SanitizerFinding();
+            pending.sanitizer = SanitizerKind::ADDRESS;
+            std::string_view category = description.substr(0, description.find(' '));
+            if (category == "attempting" && description.size() > category.size() + 1) {
+                std::string_view rest = description.substr(category.size() + 1);
+                category = rest.substr(0, rest.find(' '));
+            }
+            pending.category = std::string(category);
+            pending.message = std::string(description.substr(0, description.find(" on address")));
+            awaitingFrame = true;
+        } else if (leak != std::string_view::npos) {
+            if (awaitingFrame) {
+                commit(pending);
+            }
+            pending = SanitizerFinding();
+            pending.sanitizer = SanitizerKind::LEAK;
+            pending.category = startsWith(line, "Direct") ? "memory-leak" : "indirect-memory-leak";
+            std::string_view description = trim(line);
+            pending.message = std::string(description.substr(0, description.find(" allocated from")));
+            awaitingFrame = true;
+        } else if (awaitingFrame) {
+            std::string_view text = trim(line);
+            if (pending.sanitizer == SanitizerKind::ADDRESS &&
+                (startsWith(text, "READ of size") || startsWith(text, "WRITE of size"))) {
+                pending.message += " (" + std::string(text.substr(0, text.find(" at "))) + ")";
+            } else if (isProgramFrame(line, pending.file, pending.line, pending.column)) {
+                commit(pending);
+                awaitingFrame = false;
+            } else if (startsWith(text, "SUMMARY:") || startsWith(text, "==")) {
+                pending.file.clear();
+                pending.line = pending.column = 0;
+                commit(pending);
+                awaitingFrame = false;
+            }
+        }
+    }
+
+    if (awaitingFrame) {
+        pending.file.clear();
+        pending.line = pending.column = 0;
+        commit(pending);
+    }
+    return findings;
+}
+
+const char* SanitizerReportParser::kindName(SanitizerKind kind) {
+    switch (kind) {
+        case SanitizerKind::ADDRESS: return "AddressSanitizer";
+        case SanitizerKind::UNDEFINED: return "UndefinedBehaviorSanitizer";
+        case SanitizerKind::LEAK: return "LeakSanitizer";
+    }
+    return "Sanitizer";
+}
+
+std::string SanitizerReportParser::format(const SanitizerFinding& finding) {
+    std::string text = std::string(kindName(finding.sanitizer)) + " " + finding.category;
+    if (!finding.file.empty()) {
+        std::string file = finding.file.substr(finding.file.find_last_of('/') + 1);
+        text += " at " + file + ":" + std::to_string(finding.line);
+        if (finding.column > 0) {
+            text += ":" + std::to_string(finding.column);
+        }
+    }
+    return text + ": " + finding.message;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class SanitizerKind {
+    ADDRESS,
+    UNDEFINED,
+    LEAK
+};
+
+// One problem reported by a sanitizer-instrumented run, located at the
+// innermost stack frame that belongs to the program rather than to the
+// sanitizer runtime or the system headers.
+struct SanitizerFinding {
+    SanitizerKind sanitizer;
+    std::string category;   // e.g. "heap-buffer-overflow", "signed-integer-overflow"
+    std::string message;    // the sanitizer's one-line description
+    std::string file;       // empty when no program frame was found
+    int line;
+    int column;
+
+    SanitizerFinding() : sanitizer(SanitizerKind::ADDRESS), line(0), column(0) {}
+};
+
+// Turns the stderr of an ASan/UBSan/LSan run into findings. Repeated
+// reports of the same problem at the same place are collapsed.
+class SanitizerReportParser {
+public:
+    static std::vector<SanitizerFinding> parse(std::string_view diagnostics);
+
+    static const char* kindName(SanitizerKind kind);
+    static std::string format(const SanitizerFinding& finding);
+};
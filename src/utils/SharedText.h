@@ -0,0 +1,68 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Contents of a file that must not change while in use, mapped read-only by
+// FixtureStore. The mapping is released with the last SharedText using it.
+struct MappedText {
+    std::string_view contents;
+    std::string path;
+    std::shared_ptr<const void> mapping;
+    // For callers that need a std::string; made on first use only
+    mutable std::once_flag copyOnce;
+    mutable std::string copy;
+};
+
+// Immutable, reference-counted string. Copies share one buffer, so test
+// fixtures can be handed to every TestResult without duplicating them.
+// Large fixtures can instead be backed by a mapped file: view() reads the
+// mapping and filePath() lets a program read the file as its stdin, while
+// str() copies it once for code that needs a std::string.
+class SharedText {
+private:
+    std::shared_ptr<const std::string> text;
+    std::shared_ptr<const MappedText> file;
+
+public:
+    SharedText() = default;
+    SharedText(const std::string& value) : text(std::make_shared<const std::string>(value)) {}
+    SharedText(std::string&& value) : text(std::make_shared<const std::string>(std::move(value))) {}
+    SharedText(const char* value) : text(std::make_shared<const std::string>(value)) {}
+    explicit SharedText(std::shared_ptr<const MappedText> file) : file(std::move(file)) {}
+
+    const std::string& str() const {
+        static const std::string emptyText;
+        if (file) {
+            std::call_once(file->copyOnce, [this]() { file->copy.assign(file->contents); });
+            return file->copy;
+        }
+        return text ? *text : emptyText;
+    }
+    std::string_view view() const {
+        if (file) {
+            return file->contents;
+        }
+        return text ? std::string_view(*text) : std::string_view();
+    }
+    operator const std::string&() const { return str(); }
+    operator std::string_view() const { return view(); }
+
+    // The backing file, empty for in-memory text
+    const std::string& filePath() const {
+        static const std::string noPath;
+        return file ? file->path : noPath;
+    }
+
+    bool empty() const { return view().empty(); }
+    size_t size() const { return view().size(); }
+    bool sharesBufferWith(const SharedText& other) const {
+        return (text && text == other.text) || (file && file == other.file);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const SharedText& value) {
+        return out << value.view();
+    }
+};
@@ -0,0 +1,232 @@
+#include "SourceLexer.h"
+#include <cstring>
+
+namespace {
+    inline bool isIdentifierStart(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+               static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    inline bool isIdentifierChar(char c) {
+        return isIdentifierStart(c) || (c >= '0' && c <= '9');
+    }
+
+    inline bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    bool isStringPrefix(std::string_view identifier) {
+        return identifier == "u8" || identifier == "u" || identifier == "U" || identifier == "L";
+    }
+
+    bool isRawStringPrefix(std::string_view identifier) {
+        return identifier == "R" || identifier == "u8R" || identifier == "uR" ||
+               identifier == "UR" || identifier == "LR";
+    }
+
+    // Longest operators first so scanning is maximal munch
+    const char* const threeCharPunctuators[] = {"<<=", ">>=", "...", "->*", "<=>"};
+    const char* const twoCharPunctuators[] = {
+        "::", "->", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "++", "--",
+        "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "##", ".*"
+    };
+}
+
+SourceLexer::SourceLexer(std::string_view source)
+    : source(source), pos(0), line(1), lineStart(0), atLineStart(true) {}
+
+bool SourceLexer::next(Token& token) {
+    skipWhitespaceAndComments();
+
+    token.line = line;
+    token.column = static_cast<int>(pos - lineStart) + 1;
+
+    if (pos >= source.size()) {
+        token.kind = TokenKind::END;
+        token.text = std::string_view();
+        return false;
+    }
+
+    size_t start = pos;
+    size_t end;
+    char c = source[pos];
+
+    if (c == '#' && atLineStart) {
+        token.kind = TokenKind::PREPROCESSOR;
+        end = scanDirective(start);
+    } else if (isIdentifierStart(c)) {
+        end = scanIdentifier(start);
+        std::string_view identifier = source.substr(start, end - start);
+        char following = end < source.size() ? source[end] : '\0';
+
+        if (following == '"' && isRawStringPrefix(identifier)) {
+            token.kind = TokenKind::STRING_LITERAL;
+            end = scanRawString(end);
+        } else if ((following == '"' || following == '\'') && isStringPrefix(identifier)) {
+            token.kind = following == '"' ? TokenKind::STRING_LITERAL : TokenKind::CHAR_LITERAL;
+            end = scanQuoted(end, following);
+        } else {
+            token.kind = TokenKind::IDENTIFIER;
+        }
+    } else if (isDigit(c) || (c == '.' && pos + 1 < source.size() && isDigit(source[pos + 1]))) {
+        token.kind = TokenKind::NUMBER;
+        end = scanNumber(start);
+    } else if (c == '"') {
+        token.kind = TokenKind::STRING_LITERAL;
+        end = scanQuoted(start, '"');
+    } else if (c == '\'') {
+        token.kind = TokenKind::CHAR_LITERAL;
+        end = scanQuoted(start, '\'');
+    } else {
+        token.kind = TokenKind::PUNCTUATOR;
+        end = scanPunctuator(start);
+    }
+
+    token.text = source.substr(start, end - start);
+    atLineStart = false;
+    advanceTo(end);
+    return true;
+}
+
+void SourceLexer::skipWhitespaceAndComments() {
+    while (pos < source.size()) {
+        char c = source[pos];
+
+        if (c == '\n') {
+            pos++;
+            line++;
+            lineStart = pos;
+            atLineStart = true;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+            pos++;
+        } else if (c == '\\' && pos + 1 < source.size() &&
+                   (source[pos + 1] == '\n' || source[pos + 1] == '\r')) {
+            // Line continuation outside a directive
+            pos++;
+        } else if (c == '/' && pos + 1 < source.size() && source[pos + 1] == '/') {
+            const void* newline = std::memchr(source.data() + pos, '\n', source.size() - pos);
+            pos = newline ? static_cast<size_t>(static_cast<const char*>(newline) - source.data())
+                          : source.size();
+        } else if (c == '/' && pos + 1 < source.size() && source[pos + 1] == '*') {
+            size_t close = source.find("*/", pos + 2);
+            advanceTo(close == std::string_view::npos ? source.size() : close + 2);
+        } else {
+            break;
+        }
+    }
+}
+
+size_t SourceLexer::scanIdentifier(size_t start) const {
+    size_t end = start;
+    while (end < source.size() && isIdentifierChar(source[end])) {
+        end++;
+    }
+    return end;
+}
+
+size_t SourceLexer::scanNumber(size_t start) const {
+    size_t end = start;
+    while (end < source.size()) {
+        char c = source[end];
+        if (isIdentifierChar(c) || c == '.') {
+            end++;
+        } else if ((c == '+' || c == '-') &&
+                   (source[end - 1] == 'e' || source[end - 1] == 'E' ||
+                    source[end - 1] == 'p' || source[end - 1] == 'P')) {
+            end++;
+        } else if (c == '\'' && end + 1 < source.size() && isIdentifierChar(source[end + 1])) {
+            end++; // digit separator
+        } else {
+            break;
+        }
+    }
+    return end;
+}
+
+size_t SourceLexer::scanQuoted(size_t start, char quote) const {
+    size_t end = start + 1;
+    while (end < source.size()) {
+        char c = source[end];
+        if (c == '\\' && end + 1 < source.size()) {
+            end += 2;
+        } else if (c == quote) {
+            return end + 1;
+        } else if (c == '\n') {
+            return end; // unterminated literal ends at the line break
+        } else {
+            end++;
+        }
+    }
+    return end;
+}
+
+size_t SourceLexer::scanRawString(size_t quote) const {
+    size_t open = source.find('(', quote + 1);
+    if (open == std::string_view::npos || open - quote - 1 > 16) {
+        return scanQuoted(quote, '"');
+    }
+
+    std::string_view delimiter = source.substr(quote + 1, open - quote - 1);
+    size_t search = open + 1;
+    for (;;) {
+        size_t close = source.find(')', search);
+        if (close == std::string_view::npos) {
+            return source.size();
+        }
+        if (source.substr(close + 1, delimiter.size()) == delimiter &&
+            close + 1 + delimiter.size() < source.size() &&
+            source[close + 1 + delimiter.size()] == '"') {
+            return close + delimiter.size() + 2;
+        }
+        search = close + 1;
+    }
+}
+
+size_t SourceLexer::scanDirective(size_t start) const {
+    size_t end = start;
+    while (end < source.size()) {
+        if (source[end] == '\n') {
+            size_t last = end;
+            if (last > start && source[last - 1] == '\r') {
+                last--;
+            }
+            if (last > start && source[last - 1] == '\\') {
+                end++;
+                continue;
+            }
+            // Don't include a trailing carriage return in the token
+            return last;
+        }
+        end++;
+    }
+    return end;
+}
+
+size_t SourceLexer::scanPunctuator(size_t start) const {
+    std::string_view rest = source.substr(start, 3);
+
+    for (const char* op : threeCharPunctuators) {
+        if (rest == op) {
+            return start + 3;
+        }
+    }
+    for (const char* op : twoCharPunctuators) {
+        if (rest.substr(0, 2) == op) {
+            return start + 2;
+        }
+    }
+    return start + 1;
+}
+
+void SourceLexer::advanceTo(size_t end) {
+    while (pos < end) {
+        const void* newline = std::memchr(source.data() + pos, '\n', end - pos);
+        if (!newline) {
+            pos = end;
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const char*>(newline) - source.data()) + 1;
+        line++;
+        lineStart = pos;
+    }
+}
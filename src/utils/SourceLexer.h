@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+enum class TokenKind {
+    IDENTIFIER,      // identifiers and keywords
+    NUMBER,
+    STRING_LITERAL,  // including prefixed and raw strings
+    CHAR_LITERAL,
+    PUNCTUATOR,
+    PREPROCESSOR,    // a whole directive line, e.g. "#include <iostream>"
+    END
+};
+
+struct Token {
+    TokenKind kind;
+    std::string_view text; // points into the lexed source
+    int line;              // 1-based
+    int column;            // 1-based, in bytes
+
+    Token() : kind(TokenKind::END), line(0), column(0) {}
+};
+
+// Lightweight single-pass C++ tokenizer for student code. Comments and
+// whitespace are skipped, literals are kept whole, so checks built on the
+// token stream never trip over text inside comments or strings. Tokens are
+// views into the source, which must outlive the lexer.
+class SourceLexer {
+private:
+    std::string_view source;
+    size_t pos;
+    int line;
+    size_t lineStart;
+    bool atLineStart;
+
+public:
+    explicit SourceLexer(std::string_view source);
+
+    // Produces the next token; returns false (with an END token) at the end
+    bool next(Token& token);
+
+private:
+    void skipWhitespaceAndComments();
+    size_t scanIdentifier(size_t start) const;
+    size_t scanNumber(size_t start) const;
+    size_t scanQuoted(size_t start, char quote) const;
+    size_t scanRawString(size_t quote) const;
+    size_t scanDirective(size_t start) const;
+    size_t scanPunctuator(size_t start) const;
+    void advanceTo(size_t end);
+};
@@ -1,10 +1,165 @@
 #include "TestRunner.h"
+#include "LintEngine.h"
+#include "ContentHash.h"
+#include "ReferenceOutputCache.h"
+#include "FailureHistory.h"
+#include "GradingMemo.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <cmath>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
 
-TestRunner::TestRunner() : timeoutSeconds(10.0), verboseOutput(false) {
+namespace {
+    // Wall-time backstop under an instruction limit, as a multiple of the
+    // test's time limit: loaded hosts must not turn into timeouts, but a
+    // program retiring no instructions still has to end
+    const double INSTRUCTION_LIMITED_WALL_FACTOR = 4.0;
+    
+    // Rules a line diff can't reflect; nullptr for the whitespace-only ones
+    const char* describeComparison(ComparisonMode mode) {
+        switch (mode) {
+            case ComparisonMode::IGNORE_ALL_WHITESPACE: return "compared with all whitespace removed";
+            case ComparisonMode::TOKENS: return "compared as whitespace-separated tokens";
+            case ComparisonMode::CASE_INSENSITIVE: return "compared ignoring case";
+            case ComparisonMode::NUMERIC_TOLERANCE: return "numbers compared within a tolerance";
+            default: return nullptr;
+        }
+    }
+    
+    // "N instructions, N cycles (IPC x), ..." for the counters that were measured
+    std::string formatCounters(const HardwareCounters& counters) {
+        std::ostringstream out;
+        out << counters.instructions << " instructions";
+        if (counters.cycles > 0) {
+            out << ", " << counters.cycles << " cycles (IPC " << std::fixed << std::setprecision(2)
+                << static_cast<double>(counters.instructions) / counters.cycles << ")";
+        }
+        if (counters.cacheMisses >= 0) {
+            out << ", " << counters.cacheMisses << " cache misses";
+        }
+        if (counters.branchMisses >= 0) {
+            out << ", " << counters.branchMisses << " branch misses";
+        }
+        return out.str();
+    }
+    
+    std::string formatHeap(const AllocationStats& heap) {
+        return std::to_string(heap.allocations) + " allocations, " + std::to_string(heap.frees) + 
+               " frees, peak " + std::to_string(heap.peakLiveBytes) + " bytes, leaked " + 
+               std::to_string(heap.leakedAllocations) + " (" + std::to_string(heap.leakedBytes) + 
+               " bytes)";
+    }
+    
+    // Deletes a scratch build's executable when the suite that ran it returns
+    struct ExecutableCleanup {
+        const CompilationResult& build;
+        
+        ~ExecutableCleanup() {
+            if (!build.executablePath.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(build.executablePath, ec);
+            }
+        }
+    };
+    
+    // splitmix64: independent, reproducible seeds for every generated input
+    uint64_t mixSeed(uint64_t seed, uint64_t index) {
+        uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    
+    enum class TrialOutcome {
+        AGREED,
+        DIFFERED,
+        GENERATOR_FAILED,
+        REFERENCE_FAILED,
+        ABORTED
+    };
+    
+    struct RandomTrial {
+        TrialOutcome outcome;
+        std::string input;
+        ExecutionResult expected;
+        ExecutionResult actual;
+        std::string errorMessage;
+        
+        RandomTrial() : outcome(TrialOutcome::AGREED) {}
+    };
+    
+    // Everything one generated input needs; both programs are compiled once
+    struct RandomHarness {
+        CodeCompiler& compiler;
+        const RandomTestSpec& spec;
+        std::string generatorPath;
+        std::string submissionPath;
+        std::string referencePath;
+        double timeoutSeconds;
+        double killLimit;       // for all three programs, so none of them can hang a trial
+        
+        RandomTrial run(uint64_t seed, size_t size, const CancellationToken& cancel) const {
+            RandomTrial trial;
+            if (spec.generator) {
+                try {
+                    trial.input = spec.generator(seed, size);
+                } catch (const std::exception& e) {
+                    trial.outcome = TrialOutcome::GENERATOR_FAILED;
+                    trial.errorMessage = std::string("Generator threw: ") + e.what();
+                    return trial;
+                }
+            } else {
+                ExecutionResult generated = compiler.executeFile(generatorPath, 
+                    std::to_string(seed) + " " + std::to_string(size) + "\n", cancel, killLimit);
+                if (generated.aborted) {
+                    trial.outcome = TrialOutcome::ABORTED;
+                    return trial;
+                }
+                if (!generated.success || generated.exitCode != 0) {
+                    trial.outcome = TrialOutcome::GENERATOR_FAILED;
+                    trial.errorMessage = "Generator failed (exit code " + 
+                                         std::to_string(generated.exitCode) + ")";
+                    return trial;
+                }
+                trial.input = std::move(generated.output);
+            }
+            
+            // Submission and reference run side by side on the same input
+            std::future<ExecutionResult> reference = std::async(std::launch::async, [&]() {
+                return compiler.executeFile(referencePath, trial.input, cancel, killLimit);
+            });
+            trial.actual = compiler.executeFile(submissionPath, trial.input, cancel, killLimit);
+            trial.expected = reference.get();
+            
+            if (trial.actual.aborted || trial.expected.aborted) {
+                trial.outcome = TrialOutcome::ABORTED;
+            } else if (!trial.expected.success || trial.expected.exitCode != 0) {
+                trial.outcome = TrialOutcome::REFERENCE_FAILED;
+                trial.errorMessage = "Reference solution failed on generated input (seed " + 
+                                     std::to_string(seed) + ", size " + std::to_string(size) + ")";
+            } else if (!trial.actual.success || trial.actual.executionTime > timeoutSeconds ||
+                       !OutputComparator::matches(trial.expected.output, trial.actual.output, 
+                                                  spec.comparison)) {
+                trial.outcome = TrialOutcome::DIFFERED;
+            } else {
+                trial.outcome = TrialOutcome::AGREED;
+            }
+            return trial;
+        }
+    };
+}
+
+TestRunner::TestRunner() 
+    : timeoutSeconds(10.0), verboseOutput(false), parallelism(0), outputExcerptLimit(4096),
+      failFast(false), sanitizerPolicy(SanitizerPolicy::NEVER), cancelledSuites(0), 
+      cancelledTests(0) {
     compiler = std::make_unique<CodeCompiler>();
 }
 
@@ -12,20 +167,162 @@ TestRunner::~TestRunner() = default;
 
 void TestRunner::setCompiler(std::unique_ptr<CodeCompiler> compiler) {
     this->compiler = std::move(compiler);
+    std::lock_guard<std::mutex> lock(sanitizedCompilerMutex);
+    sanitizedCompiler.reset();
 }
 
 void TestRunner::setTimeout(double seconds) {
     this->timeoutSeconds = seconds;
 }
 
+void TestRunner::setInstructionLimit(uint64_t instructions) {
+    if (compiler) {
+        compiler->setInstructionLimit(instructions);
+    }
+}
+
+void TestRunner::setCollectCounters(bool collect) {
+    if (compiler) {
+        compiler->setCollectCounters(collect);
+    }
+}
+
+void TestRunner::setTrackAllocations(bool track) {
+    if (compiler) {
+        compiler->setTrackAllocations(track);
+    }
+}
+
 void TestRunner::setVerboseOutput(bool verbose) {
     this->verboseOutput = verbose;
 }
 
+void TestRunner::setParallelism(unsigned int workers) {
+    this->parallelism = workers;
+}
+
+void TestRunner::setOutputExcerptLimit(size_t bytes) {
+    this->outputExcerptLimit = bytes;
+}
+
+void TestRunner::setDiffOptions(const DiffOptions& options) {
+    this->diffOptions = options;
+}
+
+void TestRunner::setReferenceCache(std::shared_ptr<ReferenceOutputCache> cache) {
+    this->referenceCache = std::move(cache);
+}
+
+void TestRunner::setFailFast(bool enabled) {
+    this->failFast = enabled;
+}
+
+void TestRunner::setFailureHistory(std::shared_ptr<FailureHistory> history) {
+    this->failureHistory = std::move(history);
+}
+
+void TestRunner::setGradingMemo(std::shared_ptr<GradingMemo> memo) {
+    this->gradingMemo = std::move(memo);
+}
+
+void TestRunner::setObserver(std::shared_ptr<TestObserver> observer) {
+    this->observer = std::move(observer);
+}
+
+void TestRunner::setSanitizerPolicy(SanitizerPolicy policy) {
+    this->sanitizerPolicy = policy;
+}
+
+std::string TestRunner::getGradingProfile() const {
+    return gradingProfile(sanitizerPolicy);
+}
+
+std::string TestRunner::gradingProfile(SanitizerPolicy policy) const {
+    std::ostringstream profile;
+    profile << (compiler ? compiler->getProfile() : std::string()) 
+            << "|timeout=" << timeoutSeconds 
+            << "|instructions=" << (compiler ? compiler->getInstructionLimit() : 0)
+            << "|failfast=" << failFast
+            << "|sanitizers=" << static_cast<int>(policy);
+    return profile.str();
+}
+
+std::string TestRunner::getGradingProfile(const AllocationLimits& allocationLimits,
+                                          const CheckerSpec& checker) const {
+    return gradingProfile(sanitizerPolicy, allocationLimits, checker);
+}
+
+std::string TestRunner::gradingProfile(SanitizerPolicy policy, const AllocationLimits& allocationLimits,
+                                       const CheckerSpec& checker) const {
+    std::ostringstream profile;
+    profile << gradingProfile(policy);
+    if (allocationLimits.enabled) {
+        profile << "|allocations=" << allocationLimits.maxAllocations << "," 
+                << allocationLimits.maxPeakBytes << "," << allocationLimits.forbidLeaks;
+    }
+    if (checker.enabled) {
+        profile << "|checker=" << std::hex << contentHash(checker.checkerCode) 
+                << std::dec << "," << checker.timeoutSeconds;
+    }
+    return profile.str();
+}
+
+double TestRunner::timeLimitFor(const TestCase& testCase) const {
+    return testCase.timeLimitSeconds > 0.0 ? testCase.timeLimitSeconds : timeoutSeconds;
+}
+
+double TestRunner::killLimitFor(double timeLimit) const {
+    bool instructionLimited = compiler && compiler->getInstructionLimit() != 0 && 
+                              CodeCompiler::areCountersAvailable();
+    return instructionLimited ? timeLimit * INSTRUCTION_LIMITED_WALL_FACTOR : timeLimit;
+}
+
+unsigned int TestRunner::workerCountFor(size_t tasks) const {
+    unsigned int workerCount = parallelism != 0 ? parallelism : 
+        std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned int>(std::min<size_t>(workerCount, std::max<size_t>(tasks, 1)));
+}
+
+CodeCompiler& TestRunner::getSanitizedCompiler() {
+    std::lock_guard<std::mutex> lock(sanitizedCompilerMutex);
+    if (!sanitizedCompiler) {
+        sanitizedCompiler = std::make_unique<CodeCompiler>(*compiler);
+        if (compiler->getCompilerType() == CompilerType::MSVC) {
+            sanitizedCompiler->addCompilerFlag("/fsanitize=address");
+            sanitizedCompiler->addCompilerFlag("/Zi");
+        } else {
+            sanitizedCompiler->addCompilerFlag("-g");
+            sanitizedCompiler->addCompilerFlag("-O1");
+            sanitizedCompiler->addCompilerFlag("-fno-omit-frame-pointer");
+            sanitizedCompiler->addCompilerFlag("-fsanitize=address,undefined");
+        }
+        // Keep going after UB so one run reports every problem site
+        sanitizedCompiler->setEnvironmentVariable("ASAN_OPTIONS", 
+            "exitcode=23:abort_on_error=0:detect_leaks=1:print_summary=1");
+        sanitizedCompiler->setEnvironmentVariable("UBSAN_OPTIONS", 
+            "print_stacktrace=0:halt_on_error=0");
+        sanitizedCompiler->setCaptureDiagnostics(true);
+        // Instrumented code retires several times more instructions
+        sanitizedCompiler->setInstructionLimit(0);
+        sanitizedCompiler->setCollectCounters(false);
+        // ASan replaces malloc itself and must come first in the library list
+        sanitizedCompiler->setTrackAllocations(false);
+    }
+    return *sanitizedCompiler;
+}
+
+ReferenceOutputCache& TestRunner::getReferenceCache() {
+    if (!referenceCache) {
+        referenceCache = std::make_shared<ReferenceOutputCache>();
+    }
+    return *referenceCache;
+}
+
 TestResult TestRunner::runSingleTest(const std::string& sourceCode, 
                                     const std::string& testName,
                                     const std::string& input, 
-                                    const std::string& expectedOutput) {
+                                    const std::string& expectedOutput,
+                                    const CancellationToken& cancel) {
     TestResult result(testName);
     result.input = input;
     result.expectedOutput = expectedOutput;
@@ -37,18 +334,44 @@ TestResult TestRunner::runSingleTest(const std::string& sourceCode,
     }
     
     // Execute the code with the given input
-    ExecutionResult execResult = compiler->executeCode(sourceCode, input);
+    ExecutionResult execResult;
+    CompilationResult build = compiler->compileScratch(sourceCode, "single_test", cancel);
+    ExecutableCleanup cleanup{build};
+    if (build.success) {
+        execResult = compiler->executeFile(build.executablePath, input, cancel, 
+                                           killLimitFor(timeoutSeconds));
+    } else {
+        execResult.errorOutput = "Compilation failed: " + build.errorOutput;
+    }
+    if (build.cancelled || execResult.aborted) {
+        result.status = TestStatus::CANCELLED;
+        result.errorMessage = "Cancelled";
+        cancelledTests.fetch_add(1);
+        return result;
+    }
     result.executionTime = execResult.executionTime;
+    result.cpuTime = execResult.cpuTime;
+    result.peakMemoryKb = execResult.peakMemoryKb;
+    result.exitCode = execResult.exitCode;
+    
+    if (execResult.timeLimitExceeded) {
+        result.status = TestStatus::TIMEOUT;
+        result.errorMessage = execResult.errorOutput;
+        recordActualOutput(result, execResult.output);
+        return result;
+    }
     
     if (!execResult.success) {
         result.status = TestStatus::ERROR;
         result.errorMessage = execResult.errorOutput;
-        result.actualOutput = execResult.output;
+        recordActualOutput(result, execResult.output);
         return result;
     }
     
-    result.actualOutput = execResult.output;
-    result.status = determineTestStatus(execResult, expectedOutput);
+    result.status = determineTestStatus(execResult, expectedOutput, ComparisonOptions(), timeoutSeconds);
+    if (result.status != TestStatus::PASSED) {
+        recordActualOutput(result, execResult.output);
+    }
     
     if (verboseOutput) {
         printTestResult(result);
@@ -59,100 +382,917 @@ TestResult TestRunner::runSingleTest(const std::string& sourceCode,
 
 TestSuite TestRunner::runTestSuite(const std::string& sourceCode, 
                                   const std::vector<TestCase>& testCases,
-                                  const std::string& suiteName) {
+                                  const std::string& suiteName,
+                                  const std::string& historyKey,
+                                  const CancellationToken& cancel) {
+    return runSuite(sourceCode, testCases, suiteName, historyKey, sanitizerPolicy, AllocationLimits(),
+                    CheckerSpec(), cancel);
+}
+
+TestSuite TestRunner::runSuite(const std::string& sourceCode, const std::vector<TestCase>& testCases,
+                               const std::string& suiteName, const std::string& historyKey,
+                               SanitizerPolicy policy, const AllocationLimits& allocationLimits,
+                               const CheckerSpec& checker, const CancellationToken& cancel) {
     TestSuite suite(suiteName);
     
+    // Held for the whole suite so the observer can't be swapped out mid-run
+    std::shared_ptr<TestObserver> events = observer;
+    auto notify = [&](const std::function<void(TestObserver&)>& event) {
+        std::lock_guard<std::mutex> lock(observerMutex);
+        event(*events);
+    };
+    auto notifyAllFinished = [&]() {
+        std::lock_guard<std::mutex> lock(observerMutex);
+        for (size_t i = 0; i < suite.results.size(); ++i) {
+            events->onTestFinished(suiteName, i, suite.results[i]);
+        }
+        events->onSuiteFinished(suite);
+    };
+    
     if (verboseOutput) {
         std::cout << "\n=== Running Test Suite: " << suiteName << " ===" << std::endl;
     }
     
-    // First, validate syntax
-    if (!validateSyntax(sourceCode)) {
+    std::string memoKey;
+    std::string submissionKey;
+    if (gradingMemo && compiler) {
+        std::string profile = gradingProfile(policy, allocationLimits, checker);
+        memoKey = GradingMemo::makeKey(sourceCode, testCases, profile);
+        if (gradingMemo->lookup(memoKey, testCases, suite)) {
+            if (events) {
+                notifyAllFinished();
+            }
+            if (verboseOutput) {
+                std::cout << "(results reused from an identical earlier submission)" << std::endl;
+                printTestSuite(suite);
+            }
+            return suite;
+        }
+        submissionKey = GradingMemo::makeSubmissionKey(sourceCode, profile);
+    }
+    
+    auto startTime = std::chrono::steady_clock::now();
+    
+    // One preallocated slot per test keeps reporting order deterministic
+    suite.results.reserve(testCases.size());
+    for (size_t i = 0; i < testCases.size(); ++i) {
+        const TestCase& testCase = testCases[i];
+        suite.results.emplace_back(testCase.description.empty() ? 
+            ("Test " + std::to_string(i + 1)) : testCase.description);
+    }
+    
+    // Tests unchanged since this source was last graded keep their results
+    std::vector<bool> reused(testCases.size(), false);
+    if (!submissionKey.empty()) {
+        reused = gradingMemo->reuseTests(submissionKey, testCases, suite);
+        suite.reusedCount = static_cast<int>(std::count(reused.begin(), reused.end(), true));
+    }
+    bool allReused = !testCases.empty() && suite.reusedCount == static_cast<int>(testCases.size());
+    
+    // Compile once; every test case runs the same executable
+    CompilationResult build;
+    ExecutableCleanup cleanup{build};
+    CompilationResult checkerBuild;
+    if (!allReused) {
+        if (events) {
+            notify([&](TestObserver& o) { o.onCompileStarted(suiteName); });
+        }
+        if (compiler) {
+            build = compiler->compileScratch(sourceCode, "suite_under_test", cancel);
+        }
+        if (events) {
+            notify([&](TestObserver& o) { o.onCompileFinished(suiteName, build); });
+        }
+        if (build.success && checker.enabled) {
+            checkerBuild = getCheckerBuild(checker);
+        }
+    }
+    
+    if (!allReused && (!build.success || (checker.enabled && !checkerBuild.success))) {
         // Create error results for all test cases
+        suite.results.clear();
+        suite.reusedCount = 0;
         for (size_t i = 0; i < testCases.size(); ++i) {
+            TestResult result("Test " + std::to_string(i + 1));
+            result.status = build.cancelled ? TestStatus::CANCELLED : TestStatus::ERROR;
+            result.errorMessage = build.cancelled ? "Cancelled" : build.success ? 
+                "Checker failed to compile: " + checkerBuild.errorOutput : 
+                build.rejected ? "Syntax validation failed" : "Build error: " + build.errorOutput;
+            suite.results.push_back(result);
+        }
+        suite.compiled = build.success || build.cancelled;
+        updateSuiteStatistics(suite, 0.0);
+        if (build.cancelled) {
+            cancelledSuites.fetch_add(1);
+            cancelledTests.fetch_add(suite.results.size());
+        } else if (build.rejected && !memoKey.empty()) {
+            // Only the verdict on the code is remembered; a broken checker
+            // or toolchain is retried next time
+            gradingMemo->store(memoKey, suite);
+        }
+        if (events) {
+            notifyAllFinished();
+        }
+        return suite;
+    }
+    
+    // Tests most likely to fail run first; results stay in declaration order
+    bool useHistory = failureHistory && !historyKey.empty();
+    std::vector<size_t> runOrder;
+    if (useHistory) {
+        runOrder = failureHistory->order(historyKey, testCases);
+    } else {
+        runOrder.resize(testCases.size());
+        for (size_t i = 0; i < runOrder.size(); ++i) {
+            runOrder[i] = i;
+        }
+    }
+    
+    // Limits are checked on a copy of the compiler that preloads the shim
+    CodeCompiler* executor = compiler.get();
+    std::unique_ptr<CodeCompiler> allocationTracker;
+    if (allocationLimits.enabled) {
+        allocationTracker = std::make_unique<CodeCompiler>(*compiler);
+        allocationTracker->setTrackAllocations(true);
+        executor = allocationTracker.get();
+    }
+    
+    // Fail-fast cancels this suite's child token; the caller's stays untouched
+    CancellationToken stopped = cancel.child();
+    const CancellationToken& runCancel = failFast || cancel.canBeCancelled() ? 
+        stopped : CancellationToken::none();
+    for (size_t i = 0; i < reused.size() && failFast; ++i) {
+        if (reused[i] && suite.results[i].status != TestStatus::PASSED) {
+            stopped.cancel();
+        }
+    }
+    std::atomic<size_t> nextTest{0};
+    auto worker = [&]() {
+        for (size_t n = nextTest.fetch_add(1); n < runOrder.size(); n = nextTest.fetch_add(1)) {
+            size_t i = runOrder[n];
+            TestResult& result = suite.results[i];
+            if (reused[i]) {
+                // Carried over as is, sanitizer findings included
+            } else if (cancel.isCancelled()) {
+                result.status = TestStatus::CANCELLED;
+                result.input = testCases[i].input;
+                result.expectedOutput = testCases[i].expectedOutput;
+                result.errorMessage = "Cancelled";
+            } else if (stopped.isCancelled()) {
+                result.status = TestStatus::SKIPPED;
+                result.input = testCases[i].input;
+                result.expectedOutput = testCases[i].expectedOutput;
+                result.errorMessage = "Skipped after an earlier failure";
+            } else {
+                if (events) {
+                    notify([&](TestObserver& o) { o.onTestStarted(suiteName, i, result.testName); });
+                }
+                ExecutionResult run = 
+                    executor->executeWithInput(build.executablePath, testCases[i].input, runCancel,
+                                          killLimitFor(timeLimitFor(testCases[i])));
+                result = buildTestResult(result.testName, testCases[i], run);
+                if (run.aborted && cancel.isCancelled()) {
+                    result.status = TestStatus::CANCELLED;
+                    result.errorMessage = "Cancelled";
+                } else if (checker.enabled) {
+                    applyChecker(result, testCases[i], run.output, checkerBuild.executablePath, checker);
+                }
+                if (allocationLimits.enabled && result.status != TestStatus::CANCELLED) {
+                    applyAllocationLimits(result, allocationLimits);
+                }
+                if (failFast && result.status != TestStatus::PASSED && 
+                    result.status != TestStatus::SKIPPED && result.status != TestStatus::CANCELLED) {
+                    stopped.cancel();
+                }
+            }
+            
+            if (events) {
+                notify([&](TestObserver& o) { o.onTestFinished(suiteName, i, result); });
+            }
+        }
+    };
+    
+    unsigned int workerCount = workerCountFor(testCases.size());
+    std::vector<std::thread> workers;
+    for (unsigned int w = 1; w < workerCount; ++w) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    
+    // Tier 2 only when it is required or can explain a failure
+    std::vector<size_t> sanitizerTests;
+    for (size_t i = 0; i < suite.results.size() && !cancel.isCancelled(); ++i) {
+        TestStatus status = suite.results[i].status;
+        if (status == TestStatus::SKIPPED || status == TestStatus::CANCELLED || reused[i]) {
+            continue;
+        }
+        if (policy == SanitizerPolicy::ALWAYS || 
+            (policy == SanitizerPolicy::ON_FAILURE && status != TestStatus::PASSED)) {
+            sanitizerTests.push_back(i);
+        }
+    }
+    if (!sanitizerTests.empty()) {
+        runSanitizerTier(sourceCode, testCases, suite, sanitizerTests, 
+                         policy == SanitizerPolicy::ALWAYS, false, cancel);
+    }
+    
+    auto endTime = std::chrono::steady_clock::now();
+    updateSuiteStatistics(suite, std::chrono::duration<double>(endTime - startTime).count());
+    
+    if (useHistory) {
+        failureHistory->record(historyKey, testCases, suite.results);
+    }
+    if (suite.cancelledCount > 0) {
+        cancelledSuites.fetch_add(1);
+        cancelledTests.fetch_add(suite.cancelledCount);
+    }
+    
+    // Timeouts depend on machine load, so such suites are graded again next
+    // time; cancelled ones never finished
+    bool hasTimeout = std::any_of(suite.results.begin(), suite.results.end(),
+        [](const TestResult& result) { return result.status == TestStatus::TIMEOUT; });
+    if (!memoKey.empty() && !hasTimeout && suite.cancelledCount == 0) {
+        gradingMemo->store(memoKey, suite);
+    }
+    if (!submissionKey.empty()) {
+        gradingMemo->storeTests(submissionKey, testCases, suite);
+    }
+    
+    if (events) {
+        notify([&](TestObserver& o) { o.onSuiteFinished(suite); });
+    }
+    
+    if (verboseOutput) {
+        for (const TestResult& result : suite.results) {
+            printTestResult(result);
+        }
+        printTestSuite(suite);
+    }
+    
+    return suite;
+}
+
+TestSuite TestRunner::runExerciseTests(const std::string& sourceCode, 
+                                      const Exercise& exercise,
+                                      const CancellationToken& cancel) {
+    if (exercise.getInteractiveSpec().enabled) {
+        return runInteractiveTests(sourceCode, exercise, cancel);
+    }
+    
+    SanitizerPolicy policy = exercise.areSanitizersRequired() ? 
+        SanitizerPolicy::ALWAYS : sanitizerPolicy;
+    if (!getReferenceCache().needsResolving(exercise)) {
+        return runSuite(sourceCode, exercise.getTestCases(), 
+                        "Exercise: " + exercise.getTitle(), exercise.getId(), policy, 
+                        exercise.getAllocationLimits(), exercise.getCheckerSpec(), cancel);
+    }
+    
+    std::vector<TestCase> testCases;
+    std::string errorMessage;
+    if (!getReferenceCache().resolveTestCases(exercise, testCases, errorMessage)) {
+        TestSuite suite("Exercise: " + exercise.getTitle());
+        for (size_t i = 0; i < exercise.getTestCases().size(); ++i) {
             TestResult result("Test " + std::to_string(i + 1));
             result.status = TestStatus::ERROR;
-            result.errorMessage = "Syntax validation failed";
+            result.errorMessage = errorMessage;
             suite.results.push_back(result);
         }
-        updateSuiteStatistics(suite);
+        updateSuiteStatistics(suite, 0.0);
         return suite;
     }
+    return runSuite(sourceCode, testCases, "Exercise: " + exercise.getTitle(), exercise.getId(), 
+                    policy, exercise.getAllocationLimits(), exercise.getCheckerSpec(), cancel);
+}
+
+TestSuite TestRunner::runInteractiveTests(const std::string& sourceCode, 
+                                          const Exercise& exercise,
+                                          const CancellationToken& cancel) {
+    const std::string suiteName = "Exercise: " + exercise.getTitle();
+    const std::vector<TestCase>& testCases = exercise.getTestCases();
+    const InteractiveSpec& spec = exercise.getInteractiveSpec();
+    TestSuite suite(suiteName);
+    
+    std::shared_ptr<TestObserver> events = observer;
+    auto notify = [&](const std::function<void(TestObserver&)>& event) {
+        std::lock_guard<std::mutex> lock(observerMutex);
+        event(*events);
+    };
+    
+    if (verboseOutput) {
+        std::cout << "\n=== Running Interactive Test Suite: " << suiteName << " ===" << std::endl;
+    }
     
-    // Run each test case
+    auto startTime = std::chrono::steady_clock::now();
+    
+    CompilationResult build;
+    ExecutableCleanup cleanup{build};
+    if (events) {
+        notify([&](TestObserver& o) { o.onCompileStarted(suiteName); });
+    }
+    if (compiler) {
+        build = compiler->compileScratch(sourceCode, "interactive_under_test", cancel);
+    }
+    if (events) {
+        notify([&](TestObserver& o) { o.onCompileFinished(suiteName, build); });
+    }
+    CompilationResult interactor;
+    if (build.success) {
+        interactor = getSupportBuild(spec.interactorCode, "interactor");
+    }
+    
+    suite.results.reserve(testCases.size());
     for (size_t i = 0; i < testCases.size(); ++i) {
-        const TestCase& testCase = testCases[i];
-        std::string testName = testCase.description.empty() ? 
-            ("Test " + std::to_string(i + 1)) : testCase.description;
-        
-        TestResult result = runSingleTest(sourceCode, testName, 
-                                         testCase.input, testCase.expectedOutput);
-        suite.results.push_back(result);
+        suite.results.emplace_back(testCases[i].description.empty() ? 
+            ("Test " + std::to_string(i + 1)) : testCases[i].description);
+    }
+    
+    if (!build.success || !interactor.success) {
+        for (TestResult& result : suite.results) {
+            result.status = build.cancelled ? TestStatus::CANCELLED : TestStatus::ERROR;
+            result.errorMessage = build.cancelled ? "Cancelled" : build.success ? 
+                "Interactor failed to compile: " + interactor.errorOutput : "Syntax validation failed";
+        }
+        suite.compiled = build.success || build.cancelled;
+        updateSuiteStatistics(suite, 0.0);
+        if (build.cancelled) {
+            cancelledSuites.fetch_add(1);
+            cancelledTests.fetch_add(suite.results.size());
+        }
+        if (events) {
+            std::lock_guard<std::mutex> lock(observerMutex);
+            for (size_t i = 0; i < suite.results.size(); ++i) {
+                events->onTestFinished(suiteName, i, suite.results[i]);
+            }
+            events->onSuiteFinished(suite);
+        }
+        return suite;
     }
     
-    updateSuiteStatistics(suite);
+    InteractionLimits limits;
+    limits.totalSeconds = spec.totalSeconds;
+    limits.idleSeconds = spec.idleSeconds;
+    limits.transcriptLimit = std::max<size_t>(outputExcerptLimit, limits.transcriptLimit);
+    
+    // Fail-fast cancels this suite's child token, which also ends the
+    // conversations still running; the caller's token stays untouched
+    CancellationToken stopped = cancel.child();
+    const CancellationToken& runCancel = failFast || cancel.canBeCancelled() ? 
+        stopped : CancellationToken::none();
+    std::atomic<size_t> nextTest{0};
+    auto worker = [&]() {
+        for (size_t i = nextTest.fetch_add(1); i < testCases.size(); i = nextTest.fetch_add(1)) {
+            TestResult& result = suite.results[i];
+            if (cancel.isCancelled()) {
+                result.status = TestStatus::CANCELLED;
+                result.input = testCases[i].input;
+                result.errorMessage = "Cancelled";
+            } else if (stopped.isCancelled()) {
+                result.status = TestStatus::SKIPPED;
+                result.input = testCases[i].input;
+                result.errorMessage = "Skipped after an earlier failure";
+            } else {
+                if (events) {
+                    notify([&](TestObserver& o) { o.onTestStarted(suiteName, i, result.testName); });
+                }
+                result = buildInteractiveResult(result.testName, testCases[i], 
+                    compiler->executeInteractive(build.executablePath, interactor.executablePath,
+                                                 testCases[i].input, limits, runCancel));
+                if (result.status == TestStatus::CANCELLED && !cancel.isCancelled()) {
+                    result.status = TestStatus::SKIPPED;
+                    result.errorMessage = "Cancelled after an earlier failure";
+                } else if (failFast && result.status != TestStatus::PASSED && 
+                           result.status != TestStatus::CANCELLED) {
+                    stopped.cancel();
+                }
+            }
+            if (events) {
+                notify([&](TestObserver& o) { o.onTestFinished(suiteName, i, result); });
+            }
+        }
+    };
+    
+    // The two sides of a test take turns, so one worker still keeps one core busy
+    unsigned int workerCount = workerCountFor(testCases.size());
+    std::vector<std::thread> workers;
+    for (unsigned int w = 1; w < workerCount; ++w) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    
+    auto endTime = std::chrono::steady_clock::now();
+    updateSuiteStatistics(suite, std::chrono::duration<double>(endTime - startTime).count());
+    if (suite.cancelledCount > 0) {
+        cancelledSuites.fetch_add(1);
+        cancelledTests.fetch_add(suite.cancelledCount);
+    }
+    
+    if (events) {
+        notify([&](TestObserver& o) { o.onSuiteFinished(suite); });
+    }
     
     if (verboseOutput) {
+        for (const TestResult& result : suite.results) {
+            printTestResult(result);
+        }
         printTestSuite(suite);
     }
     
     return suite;
 }
 
-TestSuite TestRunner::runExerciseTests(const std::string& sourceCode, 
-                                      const Exercise& exercise) {
-    return runTestSuite(sourceCode, exercise.getTestCases(), 
-                       "Exercise: " + exercise.getTitle());
+CompilationResult TestRunner::getSupportBuild(const std::string& sourceCode, const std::string& role) {
+    std::lock_guard<std::mutex> lock(supportBuildMutex);
+    uint64_t key = contentHash(sourceCode);
+    auto found = supportBuilds.find(key);
+    if (found != supportBuilds.end() && 
+        std::filesystem::exists(found->second.executablePath)) {
+        return found->second;
+    }
+    
+    CompilationResult build;
+    if (!compiler) {
+        return build;
+    }
+    std::ostringstream name;
+    name << role << "_" << std::hex << key << ".cpp";
+    build = compiler->compileCode(sourceCode, name.str());
+    if (build.success) {
+        supportBuilds[key] = build;
+    }
+    return build;
 }
 
-bool TestRunner::validateSyntax(const std::string& sourceCode) {
+TestResult TestRunner::buildInteractiveResult(const std::string& testName, const TestCase& testCase,
+                                              const InteractionResult& interaction) const {
+    TestResult result(testName);
+    result.input = testCase.input;
+    result.executionTime = interaction.program.executionTime;
+    result.cpuTime = interaction.program.cpuTime;
+    result.peakMemoryKb = interaction.program.peakMemoryKb;
+    result.exitCode = interaction.program.exitCode;
+    
+    switch (interaction.verdict) {
+        case InteractionVerdict::ACCEPTED:
+            result.status = TestStatus::PASSED;
+            break;
+        case InteractionVerdict::WRONG_ANSWER:
+            result.status = TestStatus::FAILED;
+            result.errorMessage = interaction.message.empty() ? 
+                "Wrong answer" : "Wrong answer: " + interaction.message;
+            break;
+        case InteractionVerdict::TIMEOUT:
+        case InteractionVerdict::IDLE_TIMEOUT:
+            result.status = TestStatus::TIMEOUT;
+            result.errorMessage = interaction.message;
+            break;
+        case InteractionVerdict::RUNTIME_ERROR:
+        case InteractionVerdict::JUDGE_ERROR:
+            result.status = TestStatus::ERROR;
+            result.errorMessage = interaction.message;
+            break;
+        case InteractionVerdict::CANCELLED:
+            result.status = TestStatus::CANCELLED;
+            result.errorMessage = "Cancelled";
+            return result;
+    }
+    
+    // What the program said is the useful part of a rejected conversation
+    if (result.status != TestStatus::PASSED) {
+        recordActualOutput(result, interaction.programTranscript);
+    }
+    return result;
+}
+
+TestSuite TestRunner::runSanitizedTests(const std::string& sourceCode, 
+                                        const std::vector<TestCase>& testCases,
+                                        const std::string& suiteName,
+                                        const CancellationToken& cancel) {
+    TestSuite suite(suiteName);
+    auto startTime = std::chrono::steady_clock::now();
+    
+    std::vector<size_t> indices(testCases.size());
+    for (size_t i = 0; i < testCases.size(); ++i) {
+        indices[i] = i;
+        suite.results.emplace_back(testCases[i].description.empty() ? 
+            ("Test " + std::to_string(i + 1)) : testCases[i].description);
+    }
+    if (compiler) {
+        runSanitizerTier(sourceCode, testCases, suite, indices, true, true, cancel);
+    }
+    
+    auto endTime = std::chrono::steady_clock::now();
+    updateSuiteStatistics(suite, std::chrono::duration<double>(endTime - startTime).count());
+    if (suite.cancelledCount > 0) {
+        cancelledSuites.fetch_add(1);
+        cancelledTests.fetch_add(suite.cancelledCount);
+    }
+    return suite;
+}
+
+std::future<TestSuite> TestRunner::runSanitizedTestsAsync(const std::string& sourceCode, 
+                                                          const std::vector<TestCase>& testCases,
+                                                          const std::string& suiteName,
+                                                          const CancellationToken& cancel) {
+    // The token is copied: it shares its state with the caller's
+    return std::async(std::launch::async, [this, sourceCode, testCases, suiteName, cancel]() {
+        return runSanitizedTests(sourceCode, testCases, suiteName, cancel);
+    });
+}
+
+void TestRunner::runSanitizerTier(const std::string& sourceCode, const std::vector<TestCase>& testCases,
+                                  TestSuite& suite, const std::vector<size_t>& indices,
+                                  bool failOnFindings, bool standalone,
+                                  const CancellationToken& cancel) {
+    auto markCancelled = [&](TestResult& result, const TestCase& testCase) {
+        result.status = TestStatus::CANCELLED;
+        result.input = testCase.input;
+        result.expectedOutput = testCase.expectedOutput;
+        result.errorMessage = "Cancelled";
+    };
+    
+    CodeCompiler& sanitized = getSanitizedCompiler();
+    CompilationResult build = sanitized.compileScratch(sourceCode, "suite_sanitized", cancel);
+    
+    if (build.cancelled) {
+        for (size_t i : indices) {
+            markCancelled(suite.results[i], testCases[i]);
+        }
+        return;
+    }
+    if (!build.success) {
+        if (standalone) {
+            for (size_t i : indices) {
+                suite.results[i].status = TestStatus::ERROR;
+                suite.results[i].errorMessage = "Sanitizer build failed";
+            }
+            suite.compiled = false;
+        }
+        return;
+    }
+    
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t k = next.fetch_add(1); k < indices.size(); k = next.fetch_add(1)) {
+            size_t i = indices[k];
+            if (cancel.isCancelled()) {
+                markCancelled(suite.results[i], testCases[i]);
+                continue;
+            }
+            // Instrumented code is several times slower than calibrated limits assume
+            ExecutionResult execResult = sanitized.executeWithInput(build.executablePath, testCases[i].input,
+                                                               cancel, timeoutSeconds);
+            if (execResult.aborted && cancel.isCancelled()) {
+                markCancelled(suite.results[i], testCases[i]);
+                continue;
+            }
+            if (standalone) {
+                suite.results[i] = buildTestResult(suite.results[i].testName, testCases[i], execResult,
+                                                   timeoutSeconds);
+            }
+            
+            TestResult& result = suite.results[i];
+            result.sanitizerFindings = SanitizerReportParser::parse(execResult.diagnostics);
+            // A standalone run has no plain result to keep, so the findings explain the outcome
+            if (failOnFindings && !result.sanitizerFindings.empty() && 
+                (result.status == TestStatus::PASSED || standalone)) {
+                result.status = TestStatus::ERROR;
+                result.errorMessage = "Sanitizer reported " + 
+                    std::to_string(result.sanitizerFindings.size()) + " problem(s)";
+            }
+        }
+    };
+    
+    unsigned int workerCount = workerCountFor(indices.size());
+    std::vector<std::thread> workers;
+    for (unsigned int w = 1; w < workerCount; ++w) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    
+    suite.sanitized = true;
+    std::error_code ec;
+    std::filesystem::remove(build.executablePath, ec);
+}
+
+PerformanceReport TestRunner::runPerformanceTests(const std::string& sourceCode, 
+                                                  const Exercise& exercise,
+                                                  const CancellationToken& cancel) {
+    PerformanceReport report("Exercise: " + exercise.getTitle());
+    const PerformanceSpec& spec = exercise.getPerformanceSpec();
+    
+    if (!spec.enabled || spec.inputs.empty()) {
+        report.errorMessage = "Exercise has no performance inputs";
+        return report;
+    }
+    if (exercise.getSolutionCode().empty()) {
+        report.errorMessage = "Exercise has no reference solution";
+        return report;
+    }
     if (!compiler) {
-        return false;
+        report.errorMessage = "No compiler available";
+        return report;
     }
     
-    CompilationResult result = compiler->compileCode(sourceCode, "syntax_check.cpp");
-    return result.success;
+    CompilationResult submissionBuild, referenceBuild;
+    ExecutableCleanup submissionCleanup{submissionBuild};
+    ExecutableCleanup referenceCleanup{referenceBuild};
+    submissionBuild = compiler->compileScratch(sourceCode, "perf_submission", cancel);
+    if (!submissionBuild.success) {
+        report.errorMessage = submissionBuild.cancelled ? "Cancelled" : "Compilation failed";
+        return report;
+    }
+    referenceBuild = compiler->compileScratch(exercise.getSolutionCode(), "perf_reference", cancel);
+    if (!referenceBuild.success) {
+        report.errorMessage = referenceBuild.cancelled ? "Cancelled" : 
+                              "Reference solution failed to compile";
+        return report;
+    }
+    
+    const double referenceLimit = killLimitFor(timeoutSeconds);
+    // A submission this much slower than the reference's slowest run has
+    // failed anyway (wall time, so multithreaded submissions get slack too)
+    const double slowdownMargin = 2.0;
+    const double limitFloor = 0.5;
+    
+    report.passed = true;
+    for (size_t i = 0; i < spec.inputs.size() && !cancel.isCancelled(); ++i) {
+        PerformanceResult result("Performance input " + std::to_string(i + 1));
+        std::vector<ExecutionResult> submissionRuns;
+        std::vector<ExecutionResult> referenceRuns;
+        double slowestReference = 0.0;
+        
+        // Runs are interleaved, alternating which program goes first, so
+        // drift in host load or CPU frequency hits both sides equally
+        int totalRuns = std::max(0, spec.warmupRuns) + std::max(1, spec.measuredRuns);
+        for (int run = 0; run < totalRuns && result.errorMessage.empty(); ++run) {
+            auto runSubmission = [&]() {
+                double limit = referenceLimit;
+                if (slowestReference > 0.0) {
+                    limit = std::min(limit, std::max(limitFloor, 
+                        slowestReference * std::max(spec.maxSlowdown, 1.0) * slowdownMargin));
+                }
+                return compiler->executeWithInput(submissionBuild.executablePath, spec.inputs[i], 
+                                                  cancel, limit);
+            };
+            auto runReference = [&]() {
+                ExecutionResult timed = compiler->executeWithInput(referenceBuild.executablePath, 
+                                                                   spec.inputs[i], cancel, referenceLimit);
+                if (timed.success) {
+                    slowestReference = std::max(slowestReference, timed.executionTime);
+                }
+                return timed;
+            };
+            ExecutionResult submissionRun;
+            ExecutionResult referenceRun;
+            if (run % 2 == 0) {
+                submissionRun = runSubmission();
+                referenceRun = runReference();
+            } else {
+                referenceRun = runReference();
+                submissionRun = runSubmission();
+            }
+            
+            if (submissionRun.aborted || referenceRun.aborted) {
+                result.errorMessage = "Cancelled";
+            } else if (!submissionRun.success) {
+                result.errorMessage = "Submission failed: " + submissionRun.errorOutput;
+            } else if (!referenceRun.success) {
+                result.errorMessage = "Reference solution failed: " + referenceRun.errorOutput;
+            } else if (run >= spec.warmupRuns) {
+                submissionRuns.push_back(std::move(submissionRun));
+                referenceRuns.push_back(std::move(referenceRun));
+            }
+        }
+        
+        if (result.errorMessage.empty()) {
+            result.submission = summarizeRuns(submissionRuns);
+            result.reference = summarizeRuns(referenceRuns);
+            
+            // Below a millisecond, rusage granularity dominates; clamp so
+            // trivial inputs can't flip the verdict on noise
+            const double timingFloor = 0.001;
+            result.slowdown = std::max(result.submission.medianCpuTime, timingFloor) / 
+                              std::max(result.reference.medianCpuTime, timingFloor);
+            result.memoryRatio = result.reference.peakMemoryKb > 0 ? 
+                static_cast<double>(result.submission.peakMemoryKb) / result.reference.peakMemoryKb : 0.0;
+            if (result.submission.medianInstructions >= 0 && result.reference.medianInstructions > 0) {
+                result.instructionRatio = static_cast<double>(result.submission.medianInstructions) / 
+                                          result.reference.medianInstructions;
+            }
+            
+            result.passed = result.slowdown <= spec.maxSlowdown &&
+                (spec.maxMemoryRatio <= 0.0 || result.memoryRatio <= spec.maxMemoryRatio);
+        }
+        
+        report.passed = report.passed && result.passed;
+        report.results.push_back(result);
+    }
+    if (cancel.isCancelled()) {
+        report.passed = false;
+        report.errorMessage = "Cancelled";
+    }
+    
+    if (verboseOutput) {
+        std::cout << generatePerformanceReport(report);
+    }
+    
+    return report;
 }
 
-std::vector<std::string> TestRunner::checkCommonMistakes(const std::string& sourceCode) {
-    std::vector<std::string> mistakes;
+RandomTestReport TestRunner::runRandomTests(const std::string& sourceCode, const Exercise& exercise,
+                                            const CancellationToken& cancel) {
+    RandomTestReport report("Exercise: " + exercise.getTitle());
+    const RandomTestSpec& spec = exercise.getRandomTestSpec();
     
-    // Check for common C++ mistakes
-    if (sourceCode.find("#include <iostream>") == std::string::npos && 
-        sourceCode.find("cout") != std::string::npos) {
-        mistakes.push_back("Missing #include <iostream> for cout usage");
+    if (!spec.enabled || (!spec.generator && spec.generatorCode.empty())) {
+        report.errorMessage = "Exercise has no input generator";
+        return report;
+    }
+    if (exercise.getSolutionCode().empty()) {
+        report.errorMessage = "Exercise has no reference solution";
+        return report;
+    }
+    if (!compiler) {
+        report.errorMessage = "No compiler available";
+        return report;
     }
     
-    if (sourceCode.find("using namespace std;") == std::string::npos && 
-        sourceCode.find("std::") == std::string::npos &&
-        (sourceCode.find("cout") != std::string::npos || sourceCode.find("cin") != std::string::npos)) {
-        mistakes.push_back("Missing 'std::' prefix or 'using namespace std;'");
+    RandomHarness harness{*compiler, spec, "", "", "", timeoutSeconds, killLimitFor(timeoutSeconds)};
+    CompilationResult submissionBuild, referenceBuild, generatorBuild;
+    ExecutableCleanup submissionCleanup{submissionBuild};
+    ExecutableCleanup referenceCleanup{referenceBuild};
+    ExecutableCleanup generatorCleanup{generatorBuild};
+    submissionBuild = compiler->compileScratch(sourceCode, "random_submission", cancel);
+    if (!submissionBuild.success) {
+        report.errorMessage = submissionBuild.cancelled ? "Cancelled" : "Compilation failed";
+        return report;
+    }
+    referenceBuild = compiler->compileScratch(exercise.getSolutionCode(), "random_reference", cancel);
+    if (!referenceBuild.success) {
+        report.errorMessage = referenceBuild.cancelled ? "Cancelled" : 
+                              "Reference solution failed to compile";
+        return report;
+    }
+    if (!spec.generator) {
+        generatorBuild = compiler->compileScratch(spec.generatorCode, "random_generator", cancel);
+        if (generatorBuild.cancelled) {
+            report.errorMessage = "Cancelled";
+            return report;
+        }
+        if (!generatorBuild.success) {
+            report.errorMessage = "Input generator failed to compile";
+            return report;
+        }
+        harness.generatorPath = generatorBuild.executablePath;
     }
+    harness.submissionPath = submissionBuild.executablePath;
+    harness.referencePath = referenceBuild.executablePath;
     
-    if (sourceCode.find("int main") == std::string::npos) {
-        mistakes.push_back("Missing main function");
+    auto startTime = std::chrono::steady_clock::now();
+    
+    // Sizes grow over the run so small counterexamples tend to be found first
+    auto sizeFor = [&spec](size_t iteration) {
+        size_t steps = std::max<size_t>(spec.iterations, 2) - 1;
+        return 1 + (std::max<size_t>(spec.maxSize, 1) - 1) * iteration / steps;
+    };
+    
+    CancellationToken stopped = cancel.child();
+    std::atomic<size_t> nextIteration{0};
+    std::atomic<size_t> testsRun{0};
+    std::mutex failureMutex;
+    size_t failedIteration = spec.iterations;
+    RandomTrial failure;
+    
+    auto worker = [&]() {
+        for (size_t i = nextIteration.fetch_add(1); i < spec.iterations && !stopped.isCancelled(); 
+             i = nextIteration.fetch_add(1)) {
+            RandomTrial trial = harness.run(mixSeed(spec.seed, i), sizeFor(i), stopped);
+            if (trial.outcome == TrialOutcome::ABORTED) {
+                continue;
+            }
+            if (trial.outcome == TrialOutcome::AGREED) {
+                testsRun.fetch_add(1);
+                continue;
+            }
+            if (trial.outcome == TrialOutcome::DIFFERED) {
+                testsRun.fetch_add(1);
+            }
+            
+            // First disagreement (or infrastructure failure) stops every worker
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (i < failedIteration) {
+                failedIteration = i;
+                failure = std::move(trial);
+            }
+            stopped.cancel();
+        }
+    };
+    
+    unsigned int workerCount = parallelism != 0 ? parallelism : 
+        std::max(1u, std::thread::hardware_concurrency());
+    // Each worker keeps two programs busy
+    workerCount = std::max(1u, workerCount / 2);
+    std::vector<std::thread> workers;
+    for (unsigned int w = 1; w < workerCount; ++w) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
     }
     
-    // Check for missing semicolons (basic check)
-    std::istringstream iss(sourceCode);
-    std::string line;
-    int lineNumber = 0;
-    while (std::getline(iss, line)) {
-        lineNumber++;
-        // Skip comments and preprocessor directives
-        if (line.find("//") == 0 || line.find("#") == 0 || line.empty()) {
-            continue;
+    auto searchEndTime = std::chrono::steady_clock::now();
+    double searchTime = std::chrono::duration<double>(searchEndTime - startTime).count();
+    report.testsRun = testsRun.load();
+    report.testsPerSecond = searchTime > 0.0 ? report.testsRun / searchTime : 0.0;
+    
+    if (failedIteration == spec.iterations && cancel.isCancelled()) {
+        report.errorMessage = "Cancelled";
+    } else if (failedIteration == spec.iterations) {
+        report.passed = true;
+    } else if (failure.outcome != TrialOutcome::DIFFERED) {
+        report.errorMessage = failure.errorMessage;
+    } else {
+        report.counterexampleFound = true;
+        report.seed = mixSeed(spec.seed, failedIteration);
+        report.size = report.originalSize = sizeFor(failedIteration);
+        
+        // Shrink: the smallest size at which some seed still fails. Inputs
+        // stay generator-made, so a shrunk counterexample is always valid.
+        const size_t seedsPerSize = 8;
+        // Cancelling keeps the counterexample found so far
+        for (size_t size = 1; size < report.originalSize && report.shrinkRuns < spec.shrinkAttempts &&
+             !cancel.isCancelled(); size = std::max(size + 1, size * 5 / 4)) {
+            bool smaller = false;
+            for (size_t k = 0; k < seedsPerSize && report.shrinkRuns < spec.shrinkAttempts; ++k) {
+                uint64_t seed = mixSeed(report.seed, size * seedsPerSize + k);
+                RandomTrial trial = harness.run(seed, size, cancel);
+                if (trial.outcome == TrialOutcome::ABORTED) {
+                    break;
+                }
+                report.shrinkRuns++;
+                if (trial.outcome == TrialOutcome::DIFFERED) {
+                    failure = std::move(trial);
+                    report.seed = seed;
+                    report.size = size;
+                    smaller = true;
+                    break;
+                }
+            }
+            if (smaller) {
+                break;
+            }
         }
         
-        // Check for statements that should end with semicolon
-        if ((line.find("cout") != std::string::npos || 
-             line.find("cin") != std::string::npos ||
-             line.find("=") != std::string::npos) &&
-            line.find(";") == std::string::npos &&
-            line.find("{") == std::string::npos &&
-            line.find("}") == std::string::npos) {
-            mistakes.push_back("Line " + std::to_string(lineNumber) + 
-                             " might be missing a semicolon");
+        report.input = std::move(failure.input);
+        report.expectedOutput = std::move(failure.expected.output);
+        report.actualOutput.assign(failure.actual.output, 0, 
+                                   std::min(failure.actual.output.size(), outputExcerptLimit));
+        if (!failure.actual.success) {
+            report.errorMessage = failure.actual.errorOutput;
+        } else if (failure.actual.executionTime > timeoutSeconds) {
+            report.errorMessage = "Timed out";
+        }
+    }
+    
+    auto endTime = std::chrono::steady_clock::now();
+    report.wallTime = std::chrono::duration<double>(endTime - startTime).count();
+    
+    if (verboseOutput) {
+        std::cout << generateRandomTestReport(report);
+    }
+    
+    return report;
+}
+
+bool TestRunner::validateSyntax(const std::string& sourceCode) {
+    if (!compiler) {
+        return false;
+    }
+    
+    CompilationResult result = compiler->compileCode(sourceCode, "syntax_check.cpp");
+    return result.success;
+}
+
+std::vector<std::string> TestRunner::checkCommonMistakes(const std::string& sourceCode) {
+    std::vector<std::string> mistakes;
+    
+    // One lexer pass feeds every rule; comments and literals never match
+    for (const LintFinding& finding : LintEngine::defaultEngine().lint(sourceCode)) {
+        if (finding.line > 0) {
+            mistakes.push_back("Line " + std::to_string(finding.line) + ", column " + 
+                             std::to_string(finding.column) + ": " + finding.message);
+        } else {
+            mistakes.push_back(finding.message);
         }
     }
     
@@ -161,12 +1301,18 @@ std::vector<std::string> TestRunner::checkCommonMistakes(const std::string& sour
 
 bool TestRunner::checkRequiredFeatures(const std::string& sourceCode, 
                                        const std::vector<std::string>& requiredFeatures) {
-    for (const std::string& feature : requiredFeatures) {
-        if (sourceCode.find(feature) == std::string::npos) {
-            return false;
-        }
-    }
-    return true;
+    FeatureMatcher matcher(requiredFeatures);
+    return checkFeatures(sourceCode, matcher).allRequiredPresent();
+}
+
+FeatureReport TestRunner::checkFeatures(const std::string& sourceCode, 
+                                        const FeatureMatcher& matcher) const {
+    return matcher.match(sourceCode);
+}
+
+FeatureReport TestRunner::checkExerciseFeatures(const std::string& sourceCode, 
+                                                const Exercise& exercise) const {
+    return checkFeatures(sourceCode, exercise.getFeatureMatcher());
 }
 
 void TestRunner::printTestResult(const TestResult& result) const {
@@ -185,23 +1331,52 @@ void TestRunner::printTestResult(const TestResult& result) const {
         case TestStatus::TIMEOUT:
             std::cout << "⏱ TIMEOUT";
             break;
+        case TestStatus::SKIPPED:
+            std::cout << "- SKIPPED";
+            break;
+        case TestStatus::CANCELLED:
+            std::cout << "- CANCELLED";
+            break;
     }
     
     std::cout << " (" << std::fixed << std::setprecision(3) 
               << result.executionTime << "s)" << std::endl;
     
     if (!result.input.empty()) {
-        std::cout << "Input: " << result.input << std::endl;
+        // Capped like the actual output: fixtures can be megabytes
+        std::string_view input = result.input.view();
+        std::cout << "Input: " << input.substr(0, outputExcerptLimit);
+        if (input.size() > outputExcerptLimit) {
+            std::cout << "... (" << input.size() << " bytes)";
+        }
+        std::cout << std::endl;
     }
     
-    if (result.status == TestStatus::FAILED) {
-        std::cout << "Expected: " << result.expectedOutput << std::endl;
-        std::cout << "Actual:   " << result.actualOutput << std::endl;
+    // Interactive failures carry the interactor's explanation instead
+    if (result.status == TestStatus::FAILED && result.errorMessage.empty()) {
+        std::cout << describeMismatch(result, "");
     }
     
     if (!result.errorMessage.empty()) {
         std::cout << "Error: " << result.errorMessage << std::endl;
     }
+    
+    for (const SanitizerFinding& finding : result.sanitizerFindings) {
+        std::cout << "Sanitizer: " << SanitizerReportParser::format(finding) << std::endl;
+    }
+    
+    if (result.counters.available()) {
+        std::cout << "Counters: " << formatCounters(result.counters) << std::endl;
+    }
+    
+    if (result.heap.available) {
+        std::cout << "Heap: " << formatHeap(result.heap) << std::endl;
+    }
+    
+    if (result.checkerScore >= 0.0) {
+        std::cout << "Checker: score " << std::setprecision(2) << result.checkerScore 
+                  << " (" << std::setprecision(3) << result.checkerTime << "s)" << std::endl;
+    }
 }
 
 void TestRunner::printTestSuite(const TestSuite& suite) const {
@@ -212,9 +1387,19 @@ void TestRunner::printTestSuite(const TestSuite& suite) const {
     std::cout << "Passed: " << suite.passedCount << std::endl;
     std::cout << "Failed: " << suite.failedCount << std::endl;
     std::cout << "Errors: " << suite.errorCount << std::endl;
+    if (suite.skippedCount > 0) {
+        std::cout << "Skipped: " << suite.skippedCount << std::endl;
+    }
+    if (suite.cancelledCount > 0) {
+        std::cout << "Cancelled: " << suite.cancelledCount << std::endl;
+    }
     std::cout << "Total:  " << suite.results.size() << std::endl;
     std::cout << "Time:   " << std::fixed << std::setprecision(3) 
               << suite.totalTime << "s" << std::endl;
+    std::cout << "Wall:   " << std::fixed << std::setprecision(3) 
+              << suite.wallTime << "s" << std::endl;
+    std::cout << "CPU:    " << std::fixed << std::setprecision(3) 
+              << suite.cpuTime << "s" << std::endl;
     
     double successRate = suite.results.empty() ? 0.0 : 
         (static_cast<double>(suite.passedCount) / suite.results.size()) * 100.0;
@@ -227,9 +1412,31 @@ std::string TestRunner::generateReport(const TestSuite& suite) const {
     
     report << "Test Suite: " << suite.suiteName << "\n";
     report << "Results: " << suite.passedCount << " passed, " 
-           << suite.failedCount << " failed, " << suite.errorCount << " errors\n";
+           << suite.failedCount << " failed, " << suite.errorCount << " errors";
+    if (suite.skippedCount > 0) {
+        report << ", " << suite.skippedCount << " skipped";
+    }
+    if (suite.cancelledCount > 0) {
+        report << ", " << suite.cancelledCount << " cancelled";
+    }
+    report << "\n";
+    if (suite.reusedCount > 0) {
+        report << "Reused: " << suite.reusedCount << " of " << suite.results.size() 
+               << " results from an earlier grading (executions avoided)\n";
+    }
     report << "Total Time: " << std::fixed << std::setprecision(3) 
            << suite.totalTime << "s\n";
+    report << "Wall Time: " << std::fixed << std::setprecision(3) 
+           << suite.wallTime << "s\n";
+    report << "CPU Time: " << std::fixed << std::setprecision(3) 
+           << suite.cpuTime << "s\n";
+    size_t checked = std::count_if(suite.results.begin(), suite.results.end(),
+        [](const TestResult& result) { return result.checkerTime > 0.0; });
+    if (checked > 0) {
+        report << "Checker Time: " << std::fixed << std::setprecision(3) << suite.checkerTime 
+               << "s (" << std::setprecision(2) << suite.checkerTime * 1000.0 / checked 
+               << " ms per checked output)\n";
+    }
     
     double successRate = suite.results.empty() ? 0.0 : 
         (static_cast<double>(suite.passedCount) / suite.results.size()) * 100.0;
@@ -253,29 +1460,111 @@ std::string TestRunner::generateDetailedReport(const TestSuite& suite) const {
             case TestStatus::FAILED: report << "FAILED"; break;
             case TestStatus::ERROR: report << "ERROR"; break;
             case TestStatus::TIMEOUT: report << "TIMEOUT"; break;
+            case TestStatus::SKIPPED: report << "SKIPPED"; break;
+            case TestStatus::CANCELLED: report << "CANCELLED"; break;
         }
         
         report << " (" << std::fixed << std::setprecision(3) 
                << result.executionTime << "s)\n";
         
-        if (result.status == TestStatus::FAILED) {
-            report << "  Expected: " << result.expectedOutput << "\n";
-            report << "  Actual:   " << result.actualOutput << "\n";
+        if (result.status == TestStatus::FAILED && result.errorMessage.empty()) {
+            report << describeMismatch(result, "  ");
         }
         
         if (!result.errorMessage.empty()) {
             report << "  Error: " << result.errorMessage << "\n";
         }
+        
+        for (const SanitizerFinding& finding : result.sanitizerFindings) {
+            report << "  Sanitizer: " << SanitizerReportParser::format(finding) << "\n";
+        }
+        
+        if (result.counters.available()) {
+            report << "  Counters: " << formatCounters(result.counters) << "\n";
+        }
+        
+        if (result.heap.available) {
+            report << "  Heap: " << formatHeap(result.heap) << "\n";
+        }
+        
+        if (result.checkerScore >= 0.0) {
+            report << "  Checker: score " << std::setprecision(2) << result.checkerScore 
+                   << " (" << std::setprecision(3) << result.checkerTime << "s)\n";
+        }
     }
     
     return report.str();
 }
 
-bool TestRunner::isOutputMatch(const std::string& expected, const std::string& actual) const {
-    std::string normalizedExpected = normalizeOutput(expected);
-    std::string normalizedActual = normalizeOutput(actual);
+std::string TestRunner::generatePerformanceReport(const PerformanceReport& report) const {
+    std::ostringstream out;
     
-    return normalizedExpected == normalizedActual;
+    out << "Performance Suite: " << report.suiteName << "\n";
+    out << "Verdict: " << (report.passed ? "PASSED" : "FAILED") << "\n";
+    if (!report.errorMessage.empty()) {
+        out << "Error: " << report.errorMessage << "\n";
+    }
+    
+    for (const PerformanceResult& result : report.results) {
+        out << "- " << result.inputName << ": " << (result.passed ? "PASSED" : "FAILED") << "\n";
+        
+        if (!result.errorMessage.empty()) {
+            out << "  Error: " << result.errorMessage << "\n";
+            continue;
+        }
+        
+        out << std::fixed << std::setprecision(4);
+        out << "  Submission: median " << result.submission.medianCpuTime << "s, p95 " 
+            << result.submission.p95CpuTime << "s CPU (wall median " 
+            << result.submission.medianWallTime << "s), peak " 
+            << result.submission.peakMemoryKb << " KB\n";
+        out << "  Reference:  median " << result.reference.medianCpuTime << "s, p95 " 
+            << result.reference.p95CpuTime << "s CPU (wall median " 
+            << result.reference.medianWallTime << "s), peak " 
+            << result.reference.peakMemoryKb << " KB\n";
+        out << std::setprecision(2);
+        out << "  Slowdown: " << result.slowdown << "x, memory ratio: " 
+            << result.memoryRatio << "x (" << result.submission.runs << " measured runs)\n";
+        if (result.instructionRatio > 0.0) {
+            out << "  Instructions: " << result.submission.medianInstructions << " vs " 
+                << result.reference.medianInstructions << " median (" 
+                << result.instructionRatio << "x)\n";
+        }
+    }
+    
+    return out.str();
+}
+
+std::string TestRunner::generateRandomTestReport(const RandomTestReport& report) const {
+    std::ostringstream out;
+    
+    out << "Random Testing: " << report.suiteName << "\n";
+    out << "Verdict: " << (report.passed ? "PASSED" : "FAILED") << "\n";
+    out << "Inputs Checked: " << report.testsRun << " (" << std::fixed << std::setprecision(1)
+        << report.testsPerSecond << " tests/s)\n";
+    out << "Wall Time: " << std::fixed << std::setprecision(3) << report.wallTime << "s\n";
+    
+    if (report.counterexampleFound) {
+        out << "Counterexample (seed " << report.seed << ", size " << report.size;
+        if (report.size < report.originalSize) {
+            out << ", shrunk from size " << report.originalSize << " in " 
+                << report.shrinkRuns << " runs";
+        }
+        out << "):\n";
+        out << "  Input:    " << report.input << "\n";
+        out << "  Expected: " << report.expectedOutput << "\n";
+        out << "  Actual:   " << report.actualOutput << "\n";
+    }
+    if (!report.errorMessage.empty()) {
+        out << "Error: " << report.errorMessage << "\n";
+    }
+    
+    return out.str();
+}
+
+bool TestRunner::isOutputMatch(std::string_view expected, std::string_view actual,
+                               const ComparisonOptions& comparison) const {
+    return OutputComparator::matches(expected, actual, comparison);
 }
 
 std::string TestRunner::normalizeOutput(const std::string& output) const {
@@ -290,25 +1579,268 @@ std::string TestRunner::normalizeOutput(const std::string& output) const {
     return normalized;
 }
 
+TestResult TestRunner::runCompiledTest(const std::string& executablePath,
+                                       const std::string& testName,
+                                       const TestCase& testCase,
+                                       const CancellationToken& cancel) {
+    return runCompiledTest(executablePath, testName, testCase, CheckerSpec(), std::string(),
+                           AllocationLimits(), cancel);
+}
+
+TestResult TestRunner::runCompiledTest(const std::string& executablePath,
+                                       const std::string& testName,
+                                       const TestCase& testCase,
+                                       const CheckerSpec& checker,
+                                       const std::string& checkerPath,
+                                       const AllocationLimits& allocationLimits,
+                                       const CancellationToken& cancel) {
+    // A copy that preloads the shim, as in runSuite; cheap next to the run
+    std::unique_ptr<CodeCompiler> allocationTracker;
+    if (allocationLimits.enabled) {
+        allocationTracker = std::make_unique<CodeCompiler>(*compiler);
+        allocationTracker->setTrackAllocations(true);
+    }
+    CodeCompiler& executor = allocationTracker ? *allocationTracker : *compiler;
+    
+    ExecutionResult execResult = executor.executeWithInput(executablePath, testCase.input, cancel,
+                                                           killLimitFor(timeLimitFor(testCase)));
+    TestResult result = buildTestResult(testName, testCase, execResult);
+    if (execResult.aborted) {
+        result.status = TestStatus::CANCELLED;
+        result.errorMessage = "Cancelled";
+        cancelledTests.fetch_add(1);
+        return result;
+    }
+    if (checker.enabled) {
+        applyChecker(result, testCase, execResult.output, checkerPath, checker);
+    }
+    if (allocationLimits.enabled) {
+        applyAllocationLimits(result, allocationLimits);
+    }
+    return result;
+}
+
+CompilationResult TestRunner::getCheckerBuild(const CheckerSpec& checker) {
+    return getSupportBuild(checker.checkerCode, "checker");
+}
+
+TestResult TestRunner::buildTestResult(const std::string& testName, const TestCase& testCase,
+                                       const ExecutionResult& execResult, double timeLimit) const {
+    TestResult result(testName);
+    result.input = testCase.input;
+    result.expectedOutput = testCase.expectedOutput;
+    result.comparison = testCase.comparison.mode;
+    result.executionTime = execResult.executionTime;
+    result.cpuTime = execResult.cpuTime;
+    result.peakMemoryKb = execResult.peakMemoryKb;
+    result.exitCode = execResult.exitCode;
+    result.counters = execResult.counters;
+    result.heap = execResult.heap;
+    
+    if (execResult.aborted) {
+        result.status = TestStatus::SKIPPED;
+        result.errorMessage = "Cancelled after an earlier failure";
+        return result;
+    }
+    
+    if (execResult.instructionLimitExceeded || execResult.timeLimitExceeded) {
+        result.status = TestStatus::TIMEOUT;
+        result.errorMessage = execResult.errorOutput;
+    } else if (!execResult.success) {
+        result.status = TestStatus::ERROR;
+        result.errorMessage = execResult.errorOutput;
+    } else {
+        result.status = determineTestStatus(execResult, testCase.expectedOutput, testCase.comparison,
+                                            timeLimit > 0.0 ? timeLimit : timeLimitFor(testCase));
+    }
+    
+    if (result.status != TestStatus::PASSED) {
+        recordActualOutput(result, execResult.output);
+    }
+    return result;
+}
+
+void TestRunner::recordActualOutput(TestResult& result, const std::string& output) const {
+    result.actualOutputSize = output.size();
+    result.actualOutputHash = contentHash(output);
+    result.actualOutput.assign(output, 0, std::min(output.size(), outputExcerptLimit));
+}
+
+std::string TestRunner::describeMismatch(const TestResult& result, const std::string& indent) const {
+    std::string_view expected = result.expectedOutput.view();
+    std::ostringstream out;
+    auto isSingleLine = [](std::string_view text) {
+        size_t newline = text.find('\n');
+        return newline == std::string::npos || newline + 1 == text.size();
+    };
+    
+    if (isSingleLine(expected) && isSingleLine(result.actualOutput) && !result.isActualOutputTruncated()) {
+        auto chomp = [](std::string_view text) {
+            return text.empty() || text.back() != '\n' ? text : text.substr(0, text.size() - 1);
+        };
+        out << indent << "Expected: " << chomp(expected) << "\n";
+        out << indent << "Actual:   " << chomp(result.actualOutput) << "\n";
+        return out.str();
+    }
+    
+    // Only an excerpt of the actual output is kept: diff both sides up to
+    // its last full line, so the missing rest doesn't show up as deletions
+    std::string_view actual = result.actualOutput;
+    bool truncated = result.isActualOutputTruncated();
+    if (truncated) {
+        size_t cut = actual.rfind('\n');
+        cut = cut == std::string_view::npos ? actual.size() : cut + 1;
+        actual = actual.substr(0, cut);
+        expected = expected.substr(0, std::min(cut, expected.size()));
+    }
+    
+    std::string diff = OutputDiff::unified(expected, actual, diffOptions);
+    if (diff.empty()) {
+        // The diff ignores trailing whitespace, like every rule but EXACT
+        if (truncated) {
+            diff = "(no line differs in the first " + std::to_string(actual.size()) + " bytes)\n";
+        } else if (result.comparison == ComparisonMode::EXACT) {
+            diff = "(outputs differ only in trailing whitespace)\n";
+        } else {
+            diff = "(no line differs, ignoring trailing whitespace)\n";
+        }
+    } else if (const char* rule = describeComparison(result.comparison)) {
+        // The diff is by line; say what the test actually tolerates
+        diff = "(" + std::string(rule) + "; not every line shown here is a mismatch)\n" + diff;
+    }
+    std::istringstream lines(diff);
+    for (std::string line; std::getline(lines, line);) {
+        out << indent << line << "\n";
+    }
+    if (result.isActualOutputTruncated()) {
+        out << indent << "(diff stops where the actual output was cut, at " << actual.size() 
+            << " of " << result.actualOutputSize << " bytes)\n";
+    }
+    return out.str();
+}
+
+void TestRunner::applyChecker(TestResult& result, const TestCase& testCase, const std::string& output,
+                              const std::string& checkerPath, const CheckerSpec& checker) const {
+    // Crashes and timeouts stand; exact matches need no second opinion
+    if (result.status == TestStatus::PASSED) {
+        result.checkerScore = 1.0;
+        return;
+    }
+    if (result.status != TestStatus::FAILED) {
+        return;
+    }
+    
+    CheckResult check = compiler->runChecker(checkerPath, testCase.input, testCase.expectedOutput, 
+                                             output, checker.timeoutSeconds);
+    result.checkerTime = check.overheadSeconds;
+    if (check.judgeError) {
+        result.status = TestStatus::ERROR;
+        result.errorMessage = check.message;
+        return;
+    }
+    result.checkerScore = check.score;
+    if (check.accepted) {
+        result.status = TestStatus::PASSED;
+    } else {
+        result.errorMessage = check.message.empty() ? 
+            "Rejected by checker" : "Rejected by checker: " + check.message;
+    }
+}
+
+void TestRunner::applyAllocationLimits(TestResult& result, const AllocationLimits& limits) const {
+    // Without a report (no shim on this platform) there is nothing to judge
+    if (result.status != TestStatus::PASSED || !result.heap.available) {
+        return;
+    }
+    
+    const AllocationStats& heap = result.heap;
+    std::string violation;
+    if (limits.maxAllocations >= 0 && heap.allocations > static_cast<uint64_t>(limits.maxAllocations)) {
+        violation = "Made " + std::to_string(heap.allocations) + " heap allocations (limit " + 
+                    std::to_string(limits.maxAllocations) + ")";
+    } else if (limits.maxPeakBytes >= 0 && heap.peakLiveBytes > static_cast<uint64_t>(limits.maxPeakBytes)) {
+        violation = "Peak heap usage " + std::to_string(heap.peakLiveBytes) + " bytes (limit " + 
+                    std::to_string(limits.maxPeakBytes) + ")";
+    } else if (limits.forbidLeaks && heap.leakedAllocations > 0) {
+        violation = "Leaked " + std::to_string(heap.leakedAllocations) + " allocation(s), " + 
+                    std::to_string(heap.leakedBytes) + " bytes";
+    }
+    
+    if (!violation.empty()) {
+        result.status = TestStatus::ERROR;
+        result.errorMessage = violation;
+    }
+}
+
 TestStatus TestRunner::determineTestStatus(const ExecutionResult& result, 
-                                          const std::string& expectedOutput) const {
+                                          std::string_view expectedOutput,
+                                          const ComparisonOptions& comparison,
+                                          double timeLimit) const {
     if (!result.success) {
         return TestStatus::ERROR;
     }
     
-    if (result.executionTime > timeoutSeconds) {
+    // An instruction limit replaces the wall-time limit whenever it was measured
+    bool instructionLimited = compiler && compiler->getInstructionLimit() != 0 && 
+                              result.counters.available();
+    if (!instructionLimited && result.executionTime > timeLimit) {
         return TestStatus::TIMEOUT;
     }
     
-    return isOutputMatch(expectedOutput, result.output) ? 
+    return isOutputMatch(expectedOutput, result.output, comparison) ? 
         TestStatus::PASSED : TestStatus::FAILED;
 }
 
-void TestRunner::updateSuiteStatistics(TestSuite& suite) const {
+TimingStats TestRunner::summarizeRuns(const std::vector<ExecutionResult>& runs) const {
+    TimingStats stats;
+    if (runs.empty()) {
+        return stats;
+    }
+    
+    std::vector<double> cpuTimes;
+    std::vector<double> wallTimes;
+    std::vector<int64_t> instructions;
+    for (const ExecutionResult& run : runs) {
+        cpuTimes.push_back(run.cpuTime);
+        wallTimes.push_back(run.executionTime);
+        stats.peakMemoryKb = std::max(stats.peakMemoryKb, run.peakMemoryKb);
+        if (run.counters.available()) {
+            instructions.push_back(run.counters.instructions);
+        }
+    }
+    std::sort(cpuTimes.begin(), cpuTimes.end());
+    std::sort(wallTimes.begin(), wallTimes.end());
+    
+    // Only meaningful when every run was counted
+    if (instructions.size() == runs.size()) {
+        std::sort(instructions.begin(), instructions.end());
+        stats.medianInstructions = instructions[(instructions.size() - 1) / 2];
+    }
+    
+    // Nearest-rank percentiles
+    auto percentile = [](const std::vector<double>& sorted, double fraction) {
+        size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+    };
+    
+    stats.medianCpuTime = percentile(cpuTimes, 0.50);
+    stats.p95CpuTime = percentile(cpuTimes, 0.95);
+    stats.medianWallTime = percentile(wallTimes, 0.50);
+    stats.p95WallTime = percentile(wallTimes, 0.95);
+    stats.runs = static_cast<int>(runs.size());
+    return stats;
+}
+
+void TestRunner::updateSuiteStatistics(TestSuite& suite, double wallTime) const {
     suite.passedCount = 0;
     suite.failedCount = 0;
     suite.errorCount = 0;
+    suite.skippedCount = 0;
+    suite.cancelledCount = 0;
     suite.totalTime = 0.0;
+    suite.cpuTime = 0.0;
+    suite.checkerTime = 0.0;
+    suite.wallTime = wallTime;
     
     for (const TestResult& result : suite.results) {
         switch (result.status) {
@@ -322,9 +1854,17 @@ void TestRunner::updateSuiteStatistics(TestSuite& suite) const {
             case TestStatus::TIMEOUT:
                 suite.errorCount++;
                 break;
+            case TestStatus::SKIPPED:
+                suite.skippedCount++;
+                break;
+            case TestStatus::CANCELLED:
+                suite.cancelledCount++;
+                break;
         }
         
         suite.totalTime += result.executionTime;
+        suite.cpuTime += result.cpuTime;
+        suite.checkerTime += result.checkerTime;
     }
 }
 
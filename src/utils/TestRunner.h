@@ -1,48 +1,186 @@
 #pragma once
 #include "CodeCompiler.h"
+#include "SanitizerReport.h"
+#include "OutputDiff.h"
 #include "../core/Exercise.h"
 #include <string>
 #include <vector>
 #include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
 
 enum class TestStatus {
     PASSED,
     FAILED,
     ERROR,
-    TIMEOUT
+    TIMEOUT,
+    SKIPPED,    // not run (or cut short) because fail-fast stopped the suite
+    CANCELLED   // the caller's cancellation token fired, e.g. a newer resubmission
+};
+
+// When the sanitized tier 2 (ASan + UBSan build) runs after the fast tier 1
+enum class SanitizerPolicy {
+    NEVER,
+    ON_FAILURE,  // rerun the failing tests sanitized to explain the failure
+    ALWAYS       // rerun every test; findings fail otherwise passing tests
 };
 
 struct TestResult {
     std::string testName;
     TestStatus status;
-    std::string input;
-    std::string expectedOutput;
-    std::string actualOutput;
+    SharedText input;           // shared with the TestCase, never copied
+    SharedText expectedOutput;
+    std::string actualOutput;   // only kept when it differs; at most the excerpt limit
+    size_t actualOutputSize;    // full size of the program output
+    uint64_t actualOutputHash;  // contentHash of the full output, 0 when not kept
     std::string errorMessage;
     double executionTime;
+    double cpuTime;
+    long peakMemoryKb;
+    int exitCode;
+    std::vector<SanitizerFinding> sanitizerFindings; // from the tier-2 run, if any
+    HardwareCounters counters;  // when the compiler collects counters
+    AllocationStats heap;       // when allocations are tracked
+    double checkerScore;        // in [0, 1]; -1 when no checker judged the output
+    double checkerTime;         // wall time spent in the checker
+    ComparisonMode comparison;  // the test's rule, for explaining mismatches
     
     TestResult(const std::string& name) 
-        : testName(name), status(TestStatus::ERROR), executionTime(0.0) {}
+        : testName(name), status(TestStatus::ERROR), actualOutputSize(0), actualOutputHash(0),
+          executionTime(0.0), cpuTime(0.0), peakMemoryKb(0), exitCode(-1), checkerScore(-1.0),
+          checkerTime(0.0), comparison(ComparisonOptions().mode) {}
+    
+    bool isActualOutputTruncated() const { return actualOutputSize > actualOutput.size(); }
 };
 
 struct TestSuite {
     std::string suiteName;
     std::vector<TestResult> results;
-    double totalTime;
+    double totalTime;   // summed per-test execution time
+    double wallTime;    // elapsed time for the whole suite
+    double cpuTime;     // summed per-test CPU time
+    double checkerTime; // summed checker overhead
     int passedCount;
     int failedCount;
     int errorCount;
+    int skippedCount;
+    int cancelledCount;
+    int reusedCount;    // results carried over from an earlier grading, not run again
+    bool compiled;      // false when the submission did not build
+    bool sanitized;     // true when a sanitizer tier ran on (some of) the tests
     
     TestSuite(const std::string& name) 
-        : suiteName(name), totalTime(0.0), passedCount(0), 
-          failedCount(0), errorCount(0) {}
+        : suiteName(name), totalTime(0.0), wallTime(0.0), cpuTime(0.0), checkerTime(0.0),
+          passedCount(0), failedCount(0), errorCount(0), skippedCount(0), cancelledCount(0), reusedCount(0), 
+          compiled(true),
+          sanitized(false) {}
 };
 
+struct TimingStats {
+    double medianCpuTime;
+    double p95CpuTime;
+    double medianWallTime;
+    double p95WallTime;
+    long peakMemoryKb;
+    int64_t medianInstructions; // -1 without hardware counters
+    int runs;
+    
+    TimingStats() 
+        : medianCpuTime(0.0), p95CpuTime(0.0), medianWallTime(0.0), p95WallTime(0.0), 
+          peakMemoryKb(0), medianInstructions(-1), runs(0) {}
+};
+
+struct PerformanceResult {
+    std::string inputName;
+    TimingStats submission;
+    TimingStats reference;
+    double slowdown;     // submission / reference median CPU time
+    double memoryRatio;  // submission / reference peak memory
+    double instructionRatio; // submission / reference median instructions, 0 without counters
+    bool passed;
+    std::string errorMessage;
+    
+    PerformanceResult(const std::string& name) 
+        : inputName(name), slowdown(0.0), memoryRatio(0.0), instructionRatio(0.0), passed(false) {}
+};
+
+struct PerformanceReport {
+    std::string suiteName;
+    std::vector<PerformanceResult> results;
+    bool passed;
+    std::string errorMessage;
+    
+    PerformanceReport(const std::string& name) : suiteName(name), passed(false) {}
+};
+
+struct RandomTestReport {
+    std::string suiteName;
+    bool passed;
+    size_t testsRun;            // generated inputs checked before stopping
+    double wallTime;
+    double testsPerSecond;
+    bool counterexampleFound;
+    uint64_t seed;              // generator seed and size of the (shrunk) counterexample
+    size_t size;
+    size_t originalSize;        // size at which the failure was first seen
+    size_t shrinkRuns;
+    SharedText input;
+    SharedText expectedOutput;
+    std::string actualOutput;
+    std::string errorMessage;
+    
+    RandomTestReport(const std::string& name) 
+        : suiteName(name), passed(false), testsRun(0), wallTime(0.0), testsPerSecond(0.0),
+          counterexampleFound(false), seed(0), size(0), originalSize(0), shrinkRuns(0) {}
+};
+
+// Receives grading events as they happen, e.g. to stream feedback to a UI
+// while later tests are still running. Test events arrive on worker threads;
+// a runner never calls its observer from two threads at once, so observers
+// need no locking of their own. Every method defaults to doing nothing.
+class TestObserver {
+public:
+    virtual ~TestObserver() = default;
+    
+    virtual void onCompileStarted(const std::string& /*suiteName*/) {}
+    virtual void onCompileFinished(const std::string& /*suiteName*/, 
+                                   const CompilationResult& /*result*/) {}
+    // index is the test's position in the suite's test cases
+    virtual void onTestStarted(const std::string& /*suiteName*/, size_t /*index*/, 
+                               const std::string& /*testName*/) {}
+    virtual void onTestFinished(const std::string& /*suiteName*/, size_t /*index*/, 
+                                const TestResult& /*result*/) {}
+    virtual void onSuiteFinished(const TestSuite& /*suite*/) {}
+};
+
+class ReferenceOutputCache;
+class FailureHistory;
+class GradingMemo;
+
 class TestRunner {
 private:
     std::unique_ptr<CodeCompiler> compiler;
+    std::unique_ptr<CodeCompiler> sanitizedCompiler; // built from compiler on first use
+    std::mutex sanitizedCompilerMutex;
+    std::map<uint64_t, CompilationResult> supportBuilds; // interactors and checkers, by source hash
+    std::mutex supportBuildMutex;
+    std::shared_ptr<ReferenceOutputCache> referenceCache;
+    std::shared_ptr<FailureHistory> failureHistory;
+    std::shared_ptr<GradingMemo> gradingMemo;
+    std::shared_ptr<TestObserver> observer;
+    std::mutex observerMutex;
     double timeoutSeconds;
     bool verboseOutput;
+    unsigned int parallelism;
+    size_t outputExcerptLimit;
+    bool failFast;
+    SanitizerPolicy sanitizerPolicy;
+    DiffOptions diffOptions;
+    std::atomic<size_t> cancelledSuites;
+    std::atomic<size_t> cancelledTests;
 
 public:
     TestRunner();
@@ -50,42 +188,186 @@ public:
     
     // Configuration
     void setCompiler(std::unique_ptr<CodeCompiler> compiler);
+    // Wall-time limit for tests without one of their own; programs still
+    // running at their limit are killed. Calibrated per-test limits come
+    // from the reference cache (ReferenceOutputCache::setTimeLimitCalibration).
     void setTimeout(double seconds);
+    // Judge running time by instructions retired instead of wall time, which
+    // is stable under host load. Falls back to the timeout when the host has
+    // no hardware counters. 0 = wall-time limit only. Programs that retire
+    // nothing (sleeping, blocked on input) are still killed at a multiple of
+    // the wall-time limit.
+    void setInstructionLimit(uint64_t instructions);
+    void setCollectCounters(bool collect); // report hardware counters per test
+    // Report heap statistics per test; exercises with AllocationLimits are
+    // always tracked
+    void setTrackAllocations(bool track);
     void setVerboseOutput(bool verbose);
+    void setParallelism(unsigned int workers); // 0 = one worker per hardware thread
+    unsigned int getParallelism() const { return parallelism; }
+    CodeCompiler* getCompiler() const { return compiler.get(); }
+    void setOutputExcerptLimit(size_t bytes);
+    void setDiffOptions(const DiffOptions& options); // failure diffs in reports
+    // Supplies expected outputs for TestCase::fromReference cases; may be
+    // shared between runners. A private in-memory cache is used otherwise.
+    void setReferenceCache(std::shared_ptr<ReferenceOutputCache> cache);
+    ReferenceOutputCache& getReferenceCache();
+    // Stop at the first failing test, cancel tests still running and mark
+    // the rest SKIPPED
+    void setFailFast(bool enabled);
+    // When set, suites with a history key run the tests that failed most
+    // often first and record their outcomes
+    void setFailureHistory(std::shared_ptr<FailureHistory> history);
+    FailureHistory* getFailureHistory() const { return failureHistory.get(); }
+    // Suites for token-identical sources are answered from the memo, and
+    // after test-set edits only new or changed tests are run again
+    void setGradingMemo(std::shared_ptr<GradingMemo> memo);
+    GradingMemo* getGradingMemo() const { return gradingMemo.get(); }
+    void setObserver(std::shared_ptr<TestObserver> observer); // nullptr to remove
+    // Exercises that require sanitizers always use SanitizerPolicy::ALWAYS
+    void setSanitizerPolicy(SanitizerPolicy policy);
+    // Everything besides source and tests that affects a suite's outcome
+    std::string getGradingProfile() const;
+    // ... of an exercise judged by these rules, as runExerciseTests keys it
+    std::string getGradingProfile(const AllocationLimits& allocationLimits,
+                                  const CheckerSpec& checker) const;
     
-    // Test execution
+    // Test execution. Cancelling the token kills the compiler or the running
+    // tests within milliseconds; unfinished tests are reported CANCELLED and
+    // nothing of the suite is remembered.
     TestResult runSingleTest(const std::string& sourceCode, 
                             const std::string& testName,
                             const std::string& input, 
-                            const std::string& expectedOutput);
+                            const std::string& expectedOutput,
+                            const CancellationToken& cancel = CancellationToken::none());
     
     TestSuite runTestSuite(const std::string& sourceCode, 
                           const std::vector<TestCase>& testCases,
-                          const std::string& suiteName = "Test Suite");
+                          const std::string& suiteName = "Test Suite",
+                          const std::string& historyKey = "",
+                          const CancellationToken& cancel = CancellationToken::none());
     
+    // Interactive exercises are routed to runInteractiveTests
     TestSuite runExerciseTests(const std::string& sourceCode, 
-                              const Exercise& exercise);
+                              const Exercise& exercise,
+                              const CancellationToken& cancel = CancellationToken::none());
+    
+    // Each test converses with the exercise's interactor, which judges the
+    // exchange; expected outputs are not used
+    TestSuite runInteractiveTests(const std::string& sourceCode, const Exercise& exercise,
+                                  const CancellationToken& cancel = CancellationToken::none());
+    
+    // Suites that had tests cancelled, and those tests, since construction
+    size_t getCancelledSuiteCount() const { return cancelledSuites.load(); }
+    size_t getCancelledTestCount() const { return cancelledTests.load(); }
+    
+    // Tier 2 on its own: every test on the sanitized build, findings fail
+    // the test. The async variant lets a student see the tier-1 result first;
+    // the runner must outlive the future. Cancelling works as for runTestSuite.
+    TestSuite runSanitizedTests(const std::string& sourceCode, 
+                                const std::vector<TestCase>& testCases,
+                                const std::string& suiteName = "Sanitized Test Suite",
+                                const CancellationToken& cancel = CancellationToken::none());
+    std::future<TestSuite> runSanitizedTestsAsync(const std::string& sourceCode, 
+                                                  const std::vector<TestCase>& testCases,
+                                                  const std::string& suiteName = "Sanitized Test Suite",
+                                                  const CancellationToken& cancel = CancellationToken::none());
+    
+    // Benchmarks the submission against the exercise's reference solution.
+    // Every run is killed at the timeout; once the reference has been timed
+    // on an input, submissions far beyond the allowed slowdown are killed
+    // sooner.
+    PerformanceReport runPerformanceTests(const std::string& sourceCode, 
+                                          const Exercise& exercise,
+                                          const CancellationToken& cancel = CancellationToken::none());
+    
+    // Checks the submission against the reference solution on generated
+    // inputs until the first disagreement, which is then shrunk. Cancelling
+    // stops the search and the shrinking; the report is then not passed.
+    RandomTestReport runRandomTests(const std::string& sourceCode, const Exercise& exercise,
+                                    const CancellationToken& cancel = CancellationToken::none());
+    
+    // Building blocks for external schedulers (e.g. BatchGrader);
+    // runCompiledTest is safe to call from several threads at once
+    TestResult runCompiledTest(const std::string& executablePath,
+                               const std::string& testName,
+                               const TestCase& testCase,
+                               const CancellationToken& cancel = CancellationToken::none());
+    // Judged like runExerciseTests judges an exercise with these rules;
+    // checkerPath is getCheckerBuild's executable when the checker is enabled
+    TestResult runCompiledTest(const std::string& executablePath,
+                               const std::string& testName,
+                               const TestCase& testCase,
+                               const CheckerSpec& checker,
+                               const std::string& checkerPath,
+                               const AllocationLimits& allocationLimits,
+                               const CancellationToken& cancel = CancellationToken::none());
+    // Compiled once per distinct checker source
+    CompilationResult getCheckerBuild(const CheckerSpec& checker);
+    // timeLimit 0 judges by the test's own limit
+    TestResult buildTestResult(const std::string& testName, const TestCase& testCase,
+                               const ExecutionResult& execResult, double timeLimit = 0.0) const;
+    void updateSuiteStatistics(TestSuite& suite, double wallTime) const;
     
     // Validation methods
     bool validateSyntax(const std::string& sourceCode);
     std::vector<std::string> checkCommonMistakes(const std::string& sourceCode);
     bool checkRequiredFeatures(const std::string& sourceCode, 
                               const std::vector<std::string>& requiredFeatures);
+    FeatureReport checkFeatures(const std::string& sourceCode, 
+                                const FeatureMatcher& matcher) const;
+    FeatureReport checkExerciseFeatures(const std::string& sourceCode, 
+                                        const Exercise& exercise) const;
     
     // Reporting
     void printTestResult(const TestResult& result) const;
     void printTestSuite(const TestSuite& suite) const;
     std::string generateReport(const TestSuite& suite) const;
     std::string generateDetailedReport(const TestSuite& suite) const;
+    std::string generatePerformanceReport(const PerformanceReport& report) const;
+    std::string generateRandomTestReport(const RandomTestReport& report) const;
     
     // Utility methods
-    bool isOutputMatch(const std::string& expected, const std::string& actual) const;
+    bool isOutputMatch(std::string_view expected, std::string_view actual,
+                       const ComparisonOptions& comparison = ComparisonOptions()) const;
     std::string normalizeOutput(const std::string& output) const;
     
 private:
+    TestSuite runSuite(const std::string& sourceCode, const std::vector<TestCase>& testCases,
+                       const std::string& suiteName, const std::string& historyKey,
+                       SanitizerPolicy policy, const AllocationLimits& allocationLimits,
+                       const CheckerSpec& checker, const CancellationToken& cancel);
+    // Rebuilds with sanitizers and reruns testCases[indices], attaching findings.
+    // standalone: statuses come from the sanitized run itself. Tests the
+    // tier could not finish because of cancel are marked CANCELLED.
+    void runSanitizerTier(const std::string& sourceCode, const std::vector<TestCase>& testCases,
+                          TestSuite& suite, const std::vector<size_t>& indices,
+                          bool failOnFindings, bool standalone, const CancellationToken& cancel);
+    CodeCompiler& getSanitizedCompiler();
+    // Interactors and checkers are compiled once per distinct source
+    CompilationResult getSupportBuild(const std::string& sourceCode, const std::string& role);
+    TestResult buildInteractiveResult(const std::string& testName, const TestCase& testCase,
+                                      const InteractionResult& interaction) const;
+    std::string gradingProfile(SanitizerPolicy policy) const;
+    std::string gradingProfile(SanitizerPolicy policy, const AllocationLimits& allocationLimits,
+                               const CheckerSpec& checker) const;
+    unsigned int workerCountFor(size_t tasks) const;
+    double timeLimitFor(const TestCase& testCase) const;
+    // Where a run is killed: its time limit, or a generous multiple of it
+    // when the instruction limit is in charge
+    double killLimitFor(double timeLimit) const;
     TestStatus determineTestStatus(const ExecutionResult& result, 
-                                  const std::string& expectedOutput) const;
-    void updateSuiteStatistics(TestSuite& suite) const;
+                                  std::string_view expectedOutput,
+                                  const ComparisonOptions& comparison,
+                                  double timeLimit) const;
+    void recordActualOutput(TestResult& result, const std::string& output) const;
+    // Expected/actual side by side for one-line outputs, a unified diff otherwise
+    std::string describeMismatch(const TestResult& result, const std::string& indent) const;
+    void applyAllocationLimits(TestResult& result, const AllocationLimits& limits) const;
+    // Lets the checker judge an output that is not identical to the expected one
+    void applyChecker(TestResult& result, const TestCase& testCase, const std::string& output,
+                      const std::string& checkerPath, const CheckerSpec& checker) const;
+    TimingStats summarizeRuns(const std::vector<ExecutionResult>& runs) const;
     std::vector<std::string> splitLines(const std::string& text) const;
     std::string trim(const std::string& str) const;
 };
@@ -0,0 +1,110 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+    thread_local const WorkStealingPool* currentPool = nullptr;
+    thread_local unsigned int currentWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int workers)
+    : queuedTasks(0), pendingTasks(0), nextQueue(0), steals(0), stopping(false) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < workers; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned int i = 0; i < workers; ++i) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping = true;
+    }
+    idleCondition.notify_all();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    unsigned int index = (currentPool == this) ? currentWorker :
+        static_cast<unsigned int>(nextQueue.fetch_add(1) % queues.size());
+
+    // Counted before the push so a worker can never observe the task
+    // without its count (the counter must not wrap below zero)
+    pendingTasks.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        queuedTasks.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    idleCondition.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    doneCondition.wait(lock, [this]() { return pendingTasks.load() == 0; });
+}
+
+void WorkStealingPool::workerLoop(unsigned int index) {
+    currentPool = this;
+    currentWorker = index;
+
+    for (;;) {
+        Task task;
+        if (popLocal(index, task) || stealFrom(index, task)) {
+            queuedTasks.fetch_sub(1);
+            task();
+            finishTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+        idleCondition.wait(lock, [this]() { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(unsigned int index, Task& task) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::stealFrom(unsigned int thief, Task& task) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(thief + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::finishTask() {
+    if (pendingTasks.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        doneCondition.notify_all();
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker. Workers pop their
+// own deque LIFO (tasks spawned by a task stay hot on the same core) and
+// steal FIFO from other workers when they run dry, so a few long-running
+// tasks never leave the remaining cores idle.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+    std::condition_variable doneCondition;
+    std::atomic<size_t> queuedTasks;
+    std::atomic<size_t> pendingTasks;
+    std::atomic<size_t> nextQueue;
+    std::atomic<uint64_t> steals;
+    bool stopping;
+
+public:
+    explicit WorkStealingPool(unsigned int workers = 0); // 0 = one per hardware thread
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Tasks submitted from a worker go to that worker's own deque;
+    // tasks from outside the pool are spread round-robin.
+    void submit(Task task);
+
+    // Blocks until every submitted task (including tasks they spawn) finished
+    void wait();
+
+    unsigned int size() const { return static_cast<unsigned int>(queues.size()); }
+    uint64_t getStealCount() const { return steals.load(); }
+
+private:
+    void workerLoop(unsigned int index);
+    bool popLocal(unsigned int index, Task& task);
+    bool stealFrom(unsigned int thief, Task& task);
+    void finishTask();
+};
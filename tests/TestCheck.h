@@ -0,0 +1,38 @@
+#pragma once
+#include <iostream>
+
+// Minimal checks for the test programs: a failed check is reported with its
+// location and counted, and testExitCode() turns the count into the
+// program's exit status for ctest.
+namespace testcheck {
+    inline int failures = 0;
+}
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" \
+                      << std::endl;                                                   \
+            testcheck::failures++;                                                    \
+        }                                                                             \
+    } while (false)
+
+#define CHECK_EQ(actual, expected)                                                    \
+    do {                                                                              \
+        const auto& actualValue = (actual);                                           \
+        const auto& expectedValue = (expected);                                       \
+        if (!(actualValue == expectedValue)) {                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " #expected \
+                      << ") failed: got " << actualValue << ", expected "            \
+                      << expectedValue << std::endl;                                  \
+            testcheck::failures++;                                                    \
+        }                                                                             \
+    } while (false)
+
+inline int testExitCode() {
+    if (testcheck::failures > 0) {
+        std::cerr << testcheck::failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+// CancellationToken: sharing, child propagation and none(); TestRunner
+// stopping plain and sanitized suites when their token is cancelled (needs
+// g++ with AddressSanitizer).
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/CancellationToken.h"
+#include "utils/TestRunner.h"
+
+namespace {
+    const std::string sleeper =
+        "#include <chrono>\n#include <thread>\n"
+        "int main() { std::this_thread::sleep_for(std::chrono::seconds(60)); }\n";
+
+    void testCopiesShareTheSwitch() {
+        CancellationToken token;
+        CancellationToken copy = token;
+        CHECK(token.canBeCancelled());
+        CHECK(!copy.isCancelled());
+        copy.cancel();
+        CHECK(token.isCancelled());
+        token.cancel(); // sticky, and cancelling twice is harmless
+        CHECK(copy.isCancelled());
+    }
+
+    void testChildren() {
+        CancellationToken parent;
+        CancellationToken child = parent.child();
+        CancellationToken grandchild = child.child();
+
+        // A child alone does not reach its parent or siblings
+        CancellationToken sibling = parent.child();
+        sibling.cancel();
+        CHECK(sibling.isCancelled());
+        CHECK(!parent.isCancelled());
+        CHECK(!child.isCancelled());
+
+        parent.cancel();
+        CHECK(child.isCancelled());
+        CHECK(grandchild.isCancelled());
+    }
+
+    void testNone() {
+        const CancellationToken& none = CancellationToken::none();
+        CHECK(!none.canBeCancelled());
+        none.cancel();
+        CHECK(!none.isCancelled());
+        CHECK(!CancellationToken::none().isCancelled());
+
+        // Its children can still be cancelled on their own
+        CancellationToken child = none.child();
+        CHECK(child.canBeCancelled());
+        child.cancel();
+        CHECK(child.isCancelled());
+        CHECK(!none.isCancelled());
+    }
+
+    // Runs body, cancels token after delayMs and returns the seconds body took
+    template <typename Body>
+    double cancelAfterDelay(const CancellationToken& token, int delayMs, Body body) {
+        auto start = std::chrono::steady_clock::now();
+        std::thread canceller([token, delayMs]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            token.cancel();
+        });
+        body();
+        canceller.join();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void testRunnerStopsSuite() {
+        TestRunner runner;
+        runner.setTimeout(30.0);
+        std::vector<TestCase> tests = {TestCase("", "done"), TestCase("", "done")};
+
+        CancellationToken token;
+        TestSuite suite("Sleeper");
+        double seconds = cancelAfterDelay(token, 300, [&]() {
+            suite = runner.runTestSuite(sleeper, tests, "Sleeper", "", token);
+        });
+        CHECK(seconds < 10.0);
+        CHECK_EQ(suite.cancelledCount, 2);
+        CHECK_EQ(runner.getCancelledSuiteCount(), 1u);
+
+        // Already cancelled: nothing is compiled or run
+        TestSuite skipped = runner.runTestSuite(sleeper, tests, "Sleeper", "", token);
+        CHECK_EQ(skipped.cancelledCount, 2);
+        CHECK(skipped.compiled);
+    }
+
+    void testRunnerStopsSanitizedSuite() {
+        TestRunner runner;
+        runner.setTimeout(30.0);
+        std::vector<TestCase> tests = {TestCase("", "done")};
+
+        CancellationToken token;
+        std::future<TestSuite> pending;
+        // Late enough that the instrumented build is done and running
+        double seconds = cancelAfterDelay(token, 2000, [&]() {
+            pending = runner.runSanitizedTestsAsync(sleeper, tests, "Sanitized", token);
+            pending.wait();
+        });
+        TestSuite suite = pending.get();
+        CHECK(seconds < 20.0);
+        CHECK_EQ(suite.cancelledCount, 1);
+        CHECK(suite.results[0].status == TestStatus::CANCELLED);
+
+        TestSuite skipped = runner.runSanitizedTests(sleeper, tests, "Sanitized", token);
+        CHECK_EQ(skipped.cancelledCount, 1);
+        CHECK_EQ(runner.getCancelledSuiteCount(), 2u);
+    }
+}
+
+int main() {
+    testCopiesShareTheSwitch();
+    testChildren();
+    testNone();
+    testRunnerStopsSuite();
+    testRunnerStopsSanitizedSuite();
+    return testExitCode();
+}
@@ -0,0 +1,155 @@
+// ExerciseManager: id lookup, the per-value bitmaps behind filtered
+// queries (checked against a plain scan, across several 64-bit words), and
+// completion counts that follow the exercises' progress.
+#include <memory>
+#include <string>
+#include <vector>
+#include "TestCheck.h"
+#include "core/Exercise.h"
+
+namespace {
+    const size_t exerciseCount = 150; // three bitmap words, the last partial
+
+    DifficultyLevel difficultyOf(size_t i) { return static_cast<DifficultyLevel>(i % 3); }
+    ExerciseType typeOf(size_t i) { return static_cast<ExerciseType>(i % 4); }
+
+    void fill(ExerciseManager& manager) {
+        for (size_t i = 0; i < exerciseCount; ++i) {
+            auto exercise = std::make_unique<Exercise>("ex" + std::to_string(i), "Exercise " + std::to_string(i),
+                                                       "", typeOf(i), difficultyOf(i));
+            // Answered without compiling anything
+            exercise->addTestCase(TestCase("", "b"));
+            manager.addExercise(std::move(exercise));
+        }
+    }
+
+    std::vector<std::string> ids(const std::vector<Exercise*>& exercises) {
+        std::vector<std::string> result;
+        for (const Exercise* exercise : exercises) {
+            result.push_back(exercise->getId());
+        }
+        return result;
+    }
+
+    // What find should return, by scanning every exercise
+    std::vector<std::string> scan(ExerciseManager& manager, const ExerciseFilter& filter) {
+        std::vector<std::string> result;
+        for (size_t i = 0; i < manager.getExerciseCount(); ++i) {
+            Exercise* exercise = manager.getExercise("ex" + std::to_string(i));
+            if ((!filter.byDifficulty || exercise->getDifficulty() == filter.difficulty) &&
+                (!filter.byType || exercise->getType() == filter.type) &&
+                (!filter.byCompletion || exercise->isCompleted() == filter.completed)) {
+                result.push_back(exercise->getId());
+            }
+        }
+        return result;
+    }
+
+    void checkAllFilters(ExerciseManager& manager) {
+        std::vector<ExerciseFilter> filters = {ExerciseFilter()};
+        for (int d = 0; d < 3; ++d) {
+            filters.push_back(ExerciseFilter().withDifficulty(static_cast<DifficultyLevel>(d)));
+            for (int t = 0; t < 4; ++t) {
+                filters.push_back(ExerciseFilter().withType(static_cast<ExerciseType>(t)));
+                filters.push_back(ExerciseFilter().withDifficulty(static_cast<DifficultyLevel>(d))
+                                                  .withType(static_cast<ExerciseType>(t)));
+                for (bool done : {false, true}) {
+                    filters.push_back(ExerciseFilter().withDifficulty(static_cast<DifficultyLevel>(d))
+                                                      .withType(static_cast<ExerciseType>(t))
+                                                      .withCompleted(done));
+                }
+            }
+        }
+        filters.push_back(ExerciseFilter().withCompleted(true));
+        filters.push_back(ExerciseFilter().withCompleted(false));
+
+        for (const ExerciseFilter& filter : filters) {
+            std::vector<std::string> expected = scan(manager, filter);
+            CHECK(ids(manager.find(filter)) == expected);
+            CHECK_EQ(manager.count(filter), expected.size());
+
+            std::vector<std::string> visited;
+            manager.forEach(filter, [&visited](Exercise& exercise) { visited.push_back(exercise.getId()); });
+            CHECK(visited == expected);
+        }
+    }
+
+    void testLookup() {
+        ExerciseManager manager;
+        fill(manager);
+        CHECK_EQ(manager.getExerciseCount(), exerciseCount);
+        CHECK_EQ(manager.getExercise("ex0")->getTitle(), "Exercise 0");
+        CHECK_EQ(manager.getExercise("ex149")->getTitle(), "Exercise 149");
+        CHECK(manager.getExercise("ex150") == nullptr);
+
+        // The first exercise with an id keeps it
+        manager.addExercise(std::make_unique<Exercise>("ex7", "Duplicate", "", ExerciseType::CODING,
+                                                       DifficultyLevel::BEGINNER));
+        CHECK_EQ(manager.getExercise("ex7")->getTitle(), "Exercise 7");
+        CHECK_EQ(manager.getExerciseCount(), exerciseCount + 1);
+
+        CHECK(manager.startExercise("ex3"));
+        CHECK(manager.getCurrentExercise() == manager.getExercise("ex3"));
+        CHECK(!manager.startExercise("missing"));
+    }
+
+    void testFilters() {
+        ExerciseManager manager;
+        fill(manager);
+        checkAllFilters(manager);
+        CHECK(ids(manager.getExercisesByType(ExerciseType::DEBUG_CODE)) ==
+              scan(manager, ExerciseFilter().withType(ExerciseType::DEBUG_CODE)));
+        CHECK(ids(manager.getExercisesByDifficulty(DifficultyLevel::ADVANCED)) ==
+              scan(manager, ExerciseFilter().withDifficulty(DifficultyLevel::ADVANCED)));
+
+        ExerciseManager empty;
+        CHECK_EQ(empty.count(ExerciseFilter().withCompleted(false)), 0u);
+        CHECK(empty.find(ExerciseFilter()).empty());
+    }
+
+    void testCompletionFollowsProgress() {
+        ExerciseManager manager;
+        fill(manager);
+        // Multiple choice sits at positions 1, 5, 9, ...; one per bitmap word here
+        for (const char* id : {"ex1", "ex65", "ex129"}) {
+            CHECK(manager.getExercise(id)->submitSolution("b"));
+        }
+        CHECK_EQ(manager.getCompletedCount(), 3);
+        CHECK_EQ(manager.getAverageScore(), 100.0);
+        CHECK(manager.getCompletedExerciseIds() == (std::vector<std::string>{"ex1", "ex65", "ex129"}));
+        checkAllFilters(manager);
+
+        // A wrong answer costs an attempt; the next right one scores 90
+        Exercise* late = manager.getExercise("ex5");
+        CHECK(!late->submitSolution("a"));
+        CHECK_EQ(manager.getCompletedCount(), 3);
+        CHECK(late->submitSolution("b"));
+        CHECK_EQ(manager.getCompletedCount(), 4);
+        CHECK_EQ(manager.getAverageScore(), (100.0 * 3 + 90.0) / 4);
+
+        manager.getExercise("ex65")->reset();
+        CHECK_EQ(manager.getCompletedCount(), 3);
+        CHECK(manager.getCompletedExerciseIds() == (std::vector<std::string>{"ex1", "ex5", "ex129"}));
+        checkAllFilters(manager);
+
+        // A copy is not in the catalog: its progress is its own
+        Exercise copy = *manager.getExercise("ex9");
+        CHECK(copy.submitSolution("b"));
+        CHECK(!manager.getExercise("ex9")->isCompleted());
+        CHECK_EQ(manager.getCompletedCount(), 3);
+
+        for (const char* id : {"ex1", "ex5", "ex129"}) {
+            manager.getExercise(id)->reset();
+        }
+        CHECK_EQ(manager.getCompletedCount(), 0);
+        CHECK_EQ(manager.getAverageScore(), 0.0);
+        CHECK_EQ(manager.count(ExerciseFilter().withCompleted(true)), 0u);
+    }
+}
+
+int main() {
+    testLookup();
+    testFilters();
+    testCompletionFollowsProgress();
+    return testExitCode();
+}
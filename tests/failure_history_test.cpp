@@ -0,0 +1,119 @@
+// FailureHistory: tests that failed most often are ordered first, skipped
+// and cancelled runs don't count, and the history survives save/load.
+// Also fail-fast grading driven by it (needs g++).
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/FailureHistory.h"
+#include "utils/TestRunner.h"
+
+namespace {
+    std::vector<TestResult> resultsWith(const std::vector<TestStatus>& statuses) {
+        std::vector<TestResult> results;
+        for (TestStatus status : statuses) {
+            TestResult result("");
+            result.status = status;
+            results.push_back(result);
+        }
+        return results;
+    }
+
+    void testOrderFollowsFailures() {
+        FailureHistory history;
+        std::vector<TestCase> tests = {TestCase("1", "a"), TestCase("2", "b"), TestCase("3", "c"),
+                                       TestCase("4", "d")};
+        CHECK(history.order("ex", tests) == (std::vector<size_t>{0, 1, 2, 3}));
+
+        // c fails twice, b once; a and d always pass
+        history.record("ex", tests, resultsWith({TestStatus::PASSED, TestStatus::FAILED,
+                                                 TestStatus::ERROR, TestStatus::PASSED}));
+        history.record("ex", tests, resultsWith({TestStatus::PASSED, TestStatus::PASSED,
+                                                 TestStatus::TIMEOUT, TestStatus::PASSED}));
+        CHECK(history.order("ex", tests) == (std::vector<size_t>{2, 1, 0, 3}));
+        CHECK_EQ(history.getFailureRate("ex", tests[2]), 1.0);
+        CHECK_EQ(history.getFailureRate("ex", tests[1]), 0.5);
+
+        // A new, unseen test outranks ones that have only ever passed
+        std::vector<TestCase> extended = tests;
+        extended.push_back(TestCase("5", "e"));
+        CHECK(history.order("ex", extended) == (std::vector<size_t>{2, 1, 4, 0, 3}));
+
+        // Tests are known by their contents, not their position
+        std::vector<TestCase> reordered = {tests[3], tests[2], tests[0], tests[1]};
+        CHECK(history.order("ex", reordered) == (std::vector<size_t>{1, 3, 0, 2}));
+
+        // Other exercises have their own history
+        CHECK(history.order("other", tests) == (std::vector<size_t>{0, 1, 2, 3}));
+    }
+
+    void testSkippedRunsDontCount() {
+        FailureHistory history;
+        std::vector<TestCase> tests = {TestCase("1", "a"), TestCase("2", "b")};
+        history.record("ex", tests, resultsWith({TestStatus::PASSED, TestStatus::SKIPPED}));
+        history.record("ex", tests, resultsWith({TestStatus::PASSED, TestStatus::CANCELLED}));
+        CHECK_EQ(history.getFailureRate("ex", tests[1]), 0.0);
+        // Still unseen, so above the test that passed twice
+        CHECK(history.order("ex", tests) == (std::vector<size_t>{1, 0}));
+    }
+
+    void testSaveAndLoad() {
+        namespace fs = std::filesystem;
+        fs::path file = fs::temp_directory_path() / ("failure_history_test_" +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tsv");
+        std::vector<TestCase> tests = {TestCase("1", "a"), TestCase("2", "b")};
+
+        FailureHistory history;
+        history.record("ex one", tests, resultsWith({TestStatus::PASSED, TestStatus::FAILED}));
+        CHECK(history.save(file.string()));
+
+        FailureHistory restored;
+        CHECK(restored.load(file.string()));
+        CHECK_EQ(restored.getFailureRate("ex one", tests[1]), 1.0);
+        CHECK(restored.order("ex one", tests) == (std::vector<size_t>{1, 0}));
+        CHECK(!restored.load((file.string() + ".missing")));
+
+        std::error_code ec;
+        fs::remove(file, ec);
+    }
+
+    void testFailFastRunsLikelyFailuresFirst() {
+        // Echoes its input; the test expecting "x" fails
+        const std::string echo =
+            "#include <iostream>\n#include <string>\n"
+            "int main() { std::string s; std::cin >> s; std::cout << s << std::endl; }\n";
+        std::vector<TestCase> tests;
+        for (int i = 0; i < 6; ++i) {
+            tests.push_back(TestCase(std::to_string(i) + "\n", std::to_string(i) + "\n"));
+        }
+        tests[4].expectedOutput = "x\n";
+
+        TestRunner runner;
+        runner.setParallelism(1);
+        runner.setFailFast(true);
+        auto history = std::make_shared<FailureHistory>();
+        runner.setFailureHistory(history);
+
+        TestSuite first = runner.runTestSuite(echo, tests, "Echo", "echo");
+        CHECK_EQ(first.passedCount, 4);
+        CHECK_EQ(first.failedCount, 1);
+        CHECK_EQ(first.skippedCount, 1);
+        CHECK(first.results[5].status == TestStatus::SKIPPED);
+
+        // Next time the failing test runs first and everything else is skipped
+        TestSuite second = runner.runTestSuite(echo, tests, "Echo", "echo");
+        CHECK_EQ(second.failedCount, 1);
+        CHECK_EQ(second.skippedCount, 5);
+        CHECK(second.results[4].status == TestStatus::FAILED);
+    }
+}
+
+int main() {
+    testOrderFollowsFailures();
+    testSkippedRunsDontCount();
+    testSaveAndLoad();
+    testFailFastRunsLikelyFailuresFirst();
+    return testExitCode();
+}
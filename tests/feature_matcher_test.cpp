@@ -0,0 +1,100 @@
+// FeatureMatcher: the Aho-Corasick automaton over tokens, including matches
+// found through failure links and features that lex to nothing.
+#include <string>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/FeatureMatcher.h"
+
+namespace {
+    const FeatureMatch* find(const FeatureReport& report, const std::string& feature) {
+        for (const FeatureMatch& match : report.features) {
+            if (match.feature == feature) {
+                return &match;
+            }
+        }
+        return nullptr;
+    }
+
+    void testRequiredAndForbidden() {
+        FeatureMatcher matcher({"for", "std::vector"}, {"goto"});
+        CHECK_EQ(matcher.getFeatureCount(), 3u);
+
+        FeatureReport report = matcher.match(
+            "#include <vector>\n"
+            "int main() {\n"
+            "    std :: vector<int> v;\n"
+            "    for (int x : v) {}\n"
+            "}\n");
+        CHECK(report.allRequiredPresent());
+        CHECK(!report.anyForbiddenPresent());
+        CHECK(report.isSatisfied());
+
+        const FeatureMatch* vector = find(report, "std::vector");
+        CHECK(vector && vector->found && vector->line == 3 && vector->column == 5);
+        const FeatureMatch* loop = find(report, "for");
+        CHECK(loop && loop->line == 4 && loop->column == 5);
+
+        report = matcher.match("int main() { goto end; end: return 0; }");
+        CHECK(!report.allRequiredPresent());
+        CHECK(report.anyForbiddenPresent());
+    }
+
+    void testCommentsAndLiteralsDontCount() {
+        FeatureMatcher matcher({"for"}, {"goto"});
+        FeatureReport report = matcher.match(
+            "// for each item\n"
+            "/* goto */ const char* s = \"for goto\";\n");
+        CHECK(!report.allRequiredPresent());
+        CHECK(!report.anyForbiddenPresent());
+
+        // A literal in the middle breaks a multi-token match
+        FeatureMatcher call({"print ( )"});
+        CHECK(!call.match("print(\"x\")").allRequiredPresent());
+        CHECK(call.match("print()").allRequiredPresent());
+    }
+
+    void testWholeTokensOnly() {
+        FeatureMatcher matcher({"for"});
+        CHECK(!matcher.match("int format = forward;").allRequiredPresent());
+    }
+
+    void testOverlappingPatterns() {
+        // Matches found through failure links: the suffix of one feature is
+        // the prefix of another, and one feature is inside another
+        FeatureMatcher matcher({"a b c", "b c d", "c"});
+        FeatureReport report = matcher.match("x a b c d");
+        CHECK(report.allRequiredPresent());
+        const FeatureMatch* inner = find(report, "c");
+        CHECK(inner && inner->column == 7);
+        const FeatureMatch* suffix = find(report, "b c d");
+        CHECK(suffix && suffix->column == 5);
+
+        FeatureMatcher partial({"a b c", "b d"});
+        report = partial.match("a b d");
+        CHECK(!find(report, "a b c")->found);
+        CHECK(find(report, "b d")->found);
+    }
+
+    void testDirectiveSpacing() {
+        FeatureMatcher matcher({"#include <map>"});
+        CHECK(matcher.match("#  include<map>\nint main() {}").allRequiredPresent());
+        CHECK(!matcher.match("#include <set>\n").allRequiredPresent());
+    }
+
+    void testFeaturesWithoutTokens() {
+        FeatureMatcher matcher({"", "// just a comment", "while"}, {"  "});
+        FeatureReport report = matcher.match("int main() { while (true) {} }");
+        CHECK(report.isSatisfied());
+        CHECK(!matcher.match("int main() {}").allRequiredPresent());
+    }
+}
+
+int main() {
+    testRequiredAndForbidden();
+    testCommentsAndLiteralsDontCount();
+    testWholeTokensOnly();
+    testOverlappingPatterns();
+    testDirectiveSpacing();
+    testFeaturesWithoutTokens();
+    return testExitCode();
+}
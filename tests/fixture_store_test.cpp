@@ -0,0 +1,121 @@
+// FixtureStore: stored and imported fixtures are mapped, repeated loads
+// share a mapping, and mappings keep their contents when the file is
+// replaced. A mapped input also reaches a graded program (needs g++).
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include "TestCheck.h"
+#include "utils/FixtureStore.h"
+#include "utils/TestRunner.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    fs::path scratchDirectory() {
+        fs::path path = fs::temp_directory_path() / ("fixture_store_test_" +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(path);
+        return path;
+    }
+
+    void writeFile(const fs::path& path, const std::string& contents) {
+        std::ofstream(path.string(), std::ios::binary) << contents;
+    }
+
+    void testStoreAndLoad(const FixtureStore& store) {
+        std::string contents(100000, 'x');
+        contents += "\nend\n";
+
+        SharedText stored;
+        CHECK(store.store(contents, stored));
+        CHECK(stored.view() == contents);
+        CHECK_EQ(stored.filePath(), store.getDirectory() + "/" + FixtureStore::nameFor(contents));
+        CHECK(FixtureStore::nameFor(contents) != FixtureStore::nameFor("other"));
+
+        // Same contents: same file, same mapping
+        SharedText again;
+        CHECK(store.store(contents, again));
+        CHECK(again.sharesBufferWith(stored));
+        SharedText loaded;
+        CHECK(store.load(FixtureStore::nameFor(contents), loaded));
+        CHECK(loaded.sharesBufferWith(stored));
+        CHECK_EQ(loaded.str(), contents);
+
+        SharedText empty;
+        CHECK(store.store("", empty));
+        CHECK(empty.empty());
+        CHECK(!store.load("missing.fixture", loaded));
+    }
+
+    void testMappingsSurviveReplacement(const fs::path& directory) {
+        fs::path path = directory / "replaced.txt";
+        writeFile(path, "first version");
+        SharedText first;
+        CHECK(FixtureStore::mapFile(path.string(), first));
+
+        // Replaced by rename, as the store does
+        writeFile(directory / "replacement.tmp", "second, longer version");
+        fs::rename(directory / "replacement.tmp", path);
+        SharedText second;
+        CHECK(FixtureStore::mapFile(path.string(), second));
+        CHECK(!second.sharesBufferWith(first));
+        CHECK(first.view() == "first version");
+        CHECK(second.view() == "second, longer version");
+    }
+
+    void testImport(const FixtureStore& store, const fs::path& directory) {
+        fs::path original = directory / "exercise_input.txt";
+        writeFile(original, "1 2 3\n");
+        SharedText imported;
+        CHECK(store.import(original.string(), imported));
+        CHECK(imported.view() == "1 2 3\n");
+        CHECK(imported.filePath() != original.string());
+
+        // The original may change in place; the mapped copy does not
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writeFile(original, "4 5 6 7\n");
+        CHECK(imported.view() == "1 2 3\n");
+        SharedText reimported;
+        CHECK(store.import(original.string(), reimported));
+        CHECK(reimported.view() == "4 5 6 7\n");
+
+        CHECK(!store.import((directory / "missing.txt").string(), reimported));
+    }
+
+    void testMappedInputIsGraded(const FixtureStore& store) {
+        const std::string sum =
+            "#include <iostream>\n"
+            "int main() { long long x, total = 0; while (std::cin >> x) total += x;"
+            " std::cout << total << std::endl; }\n";
+        std::string input;
+        long long total = 0;
+        for (int i = 1; i <= 20000; ++i) {
+            input += std::to_string(i) + "\n";
+            total += i;
+        }
+
+        SharedText mappedInput;
+        SharedText mappedExpected;
+        CHECK(store.store(input, mappedInput));
+        CHECK(store.store(std::to_string(total) + "\n", mappedExpected));
+        TestRunner runner;
+        TestSuite suite = runner.runTestSuite(sum, {TestCase(mappedInput, mappedExpected)});
+        CHECK_EQ(suite.passedCount, 1);
+    }
+}
+
+int main() {
+    fs::path directory = scratchDirectory();
+    {
+        FixtureStore store((directory / "store").string());
+        testStoreAndLoad(store);
+        testMappingsSurviveReplacement(directory);
+        testImport(store, directory);
+        testMappedInputIsGraded(store);
+    }
+    std::error_code ec;
+    fs::remove_all(directory, ec);
+    return testExitCode();
+}
@@ -0,0 +1,226 @@
+// GradingMemo: what its keys are (and aren't) sensitive to, whole-suite
+// replay, per-test reuse after test edits, persistence to disk, the memory
+// cap, and that only genuine compile errors are remembered (needs g++).
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/GradingMemo.h"
+#include "utils/TestRunner.h"
+
+namespace {
+    TestCase makeCase(const std::string& id, const std::string& input, const std::string& expected) {
+        TestCase testCase(input, expected, "Case " + id);
+        testCase.id = id;
+        return testCase;
+    }
+
+    TestSuite gradedSuite(const std::vector<TestCase>& testCases, TestStatus status) {
+        TestSuite suite("Exercise: Sum");
+        for (const TestCase& testCase : testCases) {
+            TestResult result(testCase.description);
+            result.status = status;
+            result.input = testCase.input;
+            result.expectedOutput = testCase.expectedOutput;
+            suite.results.push_back(result);
+        }
+        return suite;
+    }
+
+    void testSourceHashIgnoresLayoutOnly() {
+        uint64_t base = GradingMemo::normalizedSourceHash("int main() { return a+b; }");
+        CHECK_EQ(GradingMemo::normalizedSourceHash(
+                     "// sums\nint main()\n{\n    return a + b; /* done */\n}\n"), base);
+        CHECK(GradingMemo::normalizedSourceHash("int main() { return a-b; }") != base);
+        CHECK(GradingMemo::normalizedSourceHash("int main() { return \"a+b\"; }") != base);
+        // Token boundaries count: "+ +" is not "++"
+        CHECK(GradingMemo::normalizedSourceHash("a + +b") != GradingMemo::normalizedSourceHash("a ++b"));
+        CHECK_EQ(GradingMemo::normalizedSourceHash("#include <vector>\nint x;"),
+                 GradingMemo::normalizedSourceHash("#  include<vector> // lists\nint x;"));
+    }
+
+    void testTestSetVersion() {
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3"), makeCase("b", "2 2", "4")};
+        uint64_t version = GradingMemo::testSetVersion(tests);
+
+        std::vector<TestCase> edited = tests;
+        edited[1].expectedOutput = "5";
+        CHECK(GradingMemo::testSetVersion(edited) != version);
+
+        edited = tests;
+        edited[0].comparison = ComparisonOptions(ComparisonMode::TOKENS);
+        CHECK(GradingMemo::testSetVersion(edited) != version);
+
+        edited = tests;
+        edited.pop_back();
+        CHECK(GradingMemo::testSetVersion(edited) != version);
+
+        CHECK_EQ(GradingMemo::testSetVersion(tests), version);
+    }
+
+    void testKeys() {
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3")};
+        std::string key = GradingMemo::makeKey("int main(){}", tests, "gcc -O2");
+        CHECK_EQ(GradingMemo::makeKey("int main() { }", tests, "gcc -O2"), key);
+        CHECK(GradingMemo::makeKey("int main(){}", tests, "gcc -O0") != key);
+        CHECK(GradingMemo::makeSubmissionKey("int main(){}", "gcc -O2") !=
+              GradingMemo::makeSubmissionKey("int main(){}", "gcc -O0"));
+
+        CHECK_EQ(GradingMemo::testKey(tests[0]), "a");
+        TestCase anonymous("1 2", "3");
+        CHECK(GradingMemo::testKey(anonymous) != GradingMemo::testKey(TestCase("1 2", "4")));
+    }
+
+    void testLookupReplaysStoredSuite() {
+        GradingMemo memo;
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3"), makeCase("b", "2 2", "4")};
+        std::string key = GradingMemo::makeKey("src", tests, "profile");
+
+        TestSuite suite("Exercise: Sum");
+        CHECK(!memo.lookup(key, tests, suite));
+
+        memo.store(key, gradedSuite(tests, TestStatus::PASSED));
+        TestSuite replayed("Renamed");
+        CHECK(memo.lookup(key, tests, replayed));
+        CHECK_EQ(replayed.suiteName, "Renamed");
+        CHECK_EQ(replayed.results.size(), 2u);
+        if (replayed.results.size() == 2) {
+            CHECK(replayed.results[1].status == TestStatus::PASSED);
+            // Fixtures are re-attached, not stored
+            CHECK(replayed.results[1].expectedOutput.sharesBufferWith(tests[1].expectedOutput));
+        }
+        CHECK_EQ(memo.getHitCount(), 1u);
+        CHECK_EQ(memo.getMissCount(), 1u);
+        CHECK_EQ(memo.size(), 1u);
+    }
+
+    void testReuseAfterTestEdits() {
+        GradingMemo memo;
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3"), makeCase("b", "2 2", "4"),
+                                       makeCase("c", "5 5", "10")};
+        std::string submissionKey = GradingMemo::makeSubmissionKey("src", "profile");
+        TestSuite graded = gradedSuite(tests, TestStatus::PASSED);
+        graded.results[2].status = TestStatus::TIMEOUT; // inconclusive: not kept
+        memo.storeTests(submissionKey, tests, graded);
+
+        // b's expected output edited, d added
+        std::vector<TestCase> edited = tests;
+        edited[1].expectedOutput = "five";
+        edited.push_back(makeCase("d", "0 0", "0"));
+        TestSuite suite = gradedSuite(edited, TestStatus::SKIPPED);
+        std::vector<bool> reused = memo.reuseTests(submissionKey, edited, suite);
+        CHECK(reused == (std::vector<bool>{true, false, false, false}));
+        CHECK(suite.results[0].status == TestStatus::PASSED);
+        CHECK(suite.results[1].status == TestStatus::SKIPPED);
+        CHECK_EQ(memo.getReusedTestCount(), 1u);
+
+        // Reordering keeps reuse, keyed by id
+        std::vector<TestCase> reordered = {tests[1], tests[0]};
+        suite = gradedSuite(reordered, TestStatus::SKIPPED);
+        CHECK(memo.reuseTests(submissionKey, reordered, suite) == (std::vector<bool>{true, true}));
+
+        // Nothing stored for an uncompiled suite
+        TestSuite failedBuild = gradedSuite(tests, TestStatus::ERROR);
+        failedBuild.compiled = false;
+        std::string otherKey = GradingMemo::makeSubmissionKey("other", "profile");
+        memo.storeTests(otherKey, tests, failedBuild);
+        suite = gradedSuite(tests, TestStatus::SKIPPED);
+        CHECK(memo.reuseTests(otherKey, tests, suite) == (std::vector<bool>(3, false)));
+    }
+
+    void testPersistence() {
+        namespace fs = std::filesystem;
+        fs::path directory = fs::temp_directory_path() / ("grading_memo_test_" +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3")};
+        std::string key = GradingMemo::makeKey("src", tests, "profile");
+        std::string submissionKey = GradingMemo::makeSubmissionKey("src", "profile");
+        {
+            GradingMemo memo(directory.string());
+            TestSuite graded = gradedSuite(tests, TestStatus::FAILED);
+            graded.results[0].errorMessage = "Wrong answer\non line 1";
+            memo.store(key, graded);
+            memo.storeTests(submissionKey, tests, graded);
+        }
+
+        GradingMemo restarted(directory.string());
+        TestSuite suite("Exercise: Sum");
+        CHECK(restarted.lookup(key, tests, suite));
+        if (suite.results.size() == 1) {
+            CHECK(suite.results[0].status == TestStatus::FAILED);
+            CHECK_EQ(suite.results[0].errorMessage, "Wrong answer\non line 1");
+        }
+        suite = gradedSuite(tests, TestStatus::SKIPPED);
+        CHECK(restarted.reuseTests(submissionKey, tests, suite) == (std::vector<bool>{true}));
+
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    void testCapacity() {
+        GradingMemo memo("", 2);
+        CHECK_EQ(memo.getCapacity(), 2u);
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3")};
+        std::string first = GradingMemo::makeKey("first", tests, "profile");
+        std::string second = GradingMemo::makeKey("second", tests, "profile");
+        std::string third = GradingMemo::makeKey("third", tests, "profile");
+        memo.store(first, gradedSuite(tests, TestStatus::PASSED));
+        memo.store(second, gradedSuite(tests, TestStatus::PASSED));
+
+        // Using the first makes the second the oldest, which the third evicts
+        TestSuite suite("Exercise: Sum");
+        CHECK(memo.lookup(first, tests, suite));
+        memo.store(third, gradedSuite(tests, TestStatus::PASSED));
+        CHECK_EQ(memo.size(), 2u);
+        CHECK(memo.lookup(first, tests, suite));
+        CHECK(memo.lookup(third, tests, suite));
+        CHECK(!memo.lookup(second, tests, suite));
+
+        for (int i = 0; i < 3; ++i) {
+            std::string key = GradingMemo::makeSubmissionKey("source " + std::to_string(i), "profile");
+            memo.storeTests(key, tests, gradedSuite(tests, TestStatus::PASSED));
+        }
+        suite = gradedSuite(tests, TestStatus::SKIPPED);
+        CHECK(memo.reuseTests(GradingMemo::makeSubmissionKey("source 0", "profile"), tests, suite) ==
+              (std::vector<bool>{false}));
+        CHECK(memo.reuseTests(GradingMemo::makeSubmissionKey("source 2", "profile"), tests, suite) ==
+              (std::vector<bool>{true}));
+    }
+
+    void testOnlyRejectionsAreRemembered() {
+        std::vector<TestCase> tests = {makeCase("a", "1 2", "3")};
+        const std::string broken = "int main() { return }";
+
+        TestRunner runner;
+        auto memo = std::make_shared<GradingMemo>();
+        runner.setGradingMemo(memo);
+        TestSuite rejected = runner.runTestSuite(broken, tests);
+        CHECK(!rejected.compiled);
+        CHECK_EQ(rejected.results[0].errorMessage, "Syntax validation failed");
+        CHECK_EQ(memo->size(), 1u);
+
+        // A compiler that can't be started says nothing about the code
+        TestRunner unavailable;
+        auto missing = std::make_unique<CodeCompiler>();
+        missing->setCompilerPath("/nonexistent/g++");
+        unavailable.setCompiler(std::move(missing));
+        auto otherMemo = std::make_shared<GradingMemo>();
+        unavailable.setGradingMemo(otherMemo);
+        TestSuite failed = unavailable.runTestSuite(broken, tests);
+        CHECK(failed.results[0].errorMessage != "Syntax validation failed");
+        CHECK_EQ(otherMemo->size(), 0u);
+    }
+}
+
+int main() {
+    testSourceHashIgnoresLayoutOnly();
+    testTestSetVersion();
+    testKeys();
+    testLookupReplaysStoredSuite();
+    testReuseAfterTestEdits();
+    testPersistence();
+    testCapacity();
+    testOnlyRejectionsAreRemembered();
+    return testExitCode();
+}
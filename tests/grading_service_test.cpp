@@ -0,0 +1,109 @@
+// GradingService: a newer submission under a key cancels the older one,
+// other keys are left alone, and copies of an exercise (one per student)
+// are graded independently. Needs g++.
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include "TestCheck.h"
+#include "core/Exercise.h"
+#include "utils/GradingService.h"
+
+namespace {
+    const std::string sum =
+        "#include <iostream>\n"
+        "int main() { long long a, b; std::cin >> a >> b; std::cout << a + b << std::endl; }\n";
+    const std::string sleeper =
+        "#include <chrono>\n#include <thread>\n"
+        "int main() { std::this_thread::sleep_for(std::chrono::seconds(60)); }\n";
+
+    Exercise sumExercise() {
+        Exercise exercise("sum", "Sum", "Add two numbers", ExerciseType::CODING, DifficultyLevel::BEGINNER);
+        exercise.addTestCase(TestCase("1 2\n", "3\n"));
+        exercise.addTestCase(TestCase("20 22\n", "42\n"));
+        return exercise;
+    }
+
+    // Waits for the exercise's pending grading to be applied
+    bool awaitGrading(Exercise& exercise) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (!exercise.pollGrading()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    void testNewerSubmissionSupersedes() {
+        GradingService service(2);
+        service.getRunner().setTimeout(30.0);
+        Exercise exercise = sumExercise();
+
+        auto start = std::chrono::steady_clock::now();
+        std::future<TestSuite> first = service.submit("student-1/sum", sleeper, exercise);
+        // Let the first one start running before it is superseded
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        std::future<TestSuite> second = service.submit("student-1/sum", sum, exercise);
+        std::future<TestSuite> other = service.submit("student-2/sum", sum, exercise);
+
+        TestSuite cancelled = first.get();
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(20));
+        CHECK_EQ(cancelled.cancelledCount, 2);
+        CHECK_EQ(second.get().passedCount, 2);
+        CHECK_EQ(other.get().passedCount, 2);
+        CHECK_EQ(service.getSubmittedCount(), 3u);
+        CHECK_EQ(service.getSupersededCount(), 1u);
+    }
+
+    void testCancel() {
+        GradingService service(1);
+        service.getRunner().setTimeout(30.0);
+        Exercise exercise = sumExercise();
+
+        std::future<TestSuite> running = service.submit("a", sleeper, exercise);
+        std::future<TestSuite> queued = service.submit("b", sum, exercise);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        service.cancel("a");
+        service.cancel("missing"); // nothing under that key: no effect
+        CHECK_EQ(running.get().cancelledCount, 2);
+        CHECK_EQ(queued.get().passedCount, 2);
+        CHECK_EQ(service.getSupersededCount(), 0u);
+    }
+
+    void testCopiesAreGradedIndependently() {
+        GradingService service(2);
+        Exercise original = sumExercise();
+        original.setGradingService(&service);
+
+        // Two students working on the same exercise at once
+        Exercise first = original;
+        Exercise second = original;
+        CHECK(first.submitSolutionAsync(sum));
+        CHECK(second.submitSolutionAsync(sum));
+        CHECK(awaitGrading(first));
+        CHECK(awaitGrading(second));
+        CHECK(first.isCompleted());
+        CHECK(second.isCompleted());
+        CHECK_EQ(first.getRemainingAttempts(), 2);
+        CHECK_EQ(second.getRemainingAttempts(), 2);
+        CHECK_EQ(service.getSupersededCount(), 0u);
+
+        // The same student resubmitting still supersedes, and the
+        // superseded attempt is free
+        CHECK(original.submitSolutionAsync(sleeper));
+        CHECK(original.submitSolutionAsync(sum));
+        CHECK(awaitGrading(original));
+        CHECK_EQ(service.getSupersededCount(), 1u);
+        CHECK(original.isCompleted());
+        CHECK_EQ(original.getRemainingAttempts(), 2);
+    }
+}
+
+int main() {
+    testNewerSubmissionSupersedes();
+    testCancel();
+    testCopiesAreGradedIndependently();
+    return testExitCode();
+}
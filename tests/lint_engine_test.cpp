@@ -0,0 +1,92 @@
+// LintEngine: the default rules on the lexed token stream, and finding order.
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/LintEngine.h"
+
+namespace {
+    bool hasRule(const std::vector<LintFinding>& findings, const std::string& ruleId) {
+        return std::any_of(findings.begin(), findings.end(),
+                           [&](const LintFinding& finding) { return finding.ruleId == ruleId; });
+    }
+
+    void testDefaultRules() {
+        const LintEngine& engine = LintEngine::defaultEngine();
+        CHECK(engine.getRuleCount() > 0);
+
+        std::vector<LintFinding> findings = engine.lint("int main() { cout << 1; }");
+        CHECK(hasRule(findings, "missing-include"));
+        CHECK(hasRule(findings, "std-qualification"));
+        CHECK(!hasRule(findings, "missing-main"));
+
+        findings = engine.lint("#include <iostream>\nvoid helper() {}\n");
+        CHECK(hasRule(findings, "missing-main"));
+    }
+
+    void testCommentsAndLiteralsDontTrigger() {
+        std::vector<LintFinding> findings = LintEngine::defaultEngine().lint(
+            "#include <iostream>\n"
+            "int main() {\n"
+            "    std::cout << \"cout without std\" << std::endl; // cout too\n"
+            "    return 0;\n"
+            "}\n");
+        CHECK(findings.empty());
+    }
+
+    void testUsingDeclarationsSatisfyQualification() {
+        std::vector<LintFinding> findings = LintEngine::defaultEngine().lint(
+            "#include <iostream>\nusing namespace std;\nint main() { cout << 1; }\n");
+        CHECK(!hasRule(findings, "std-qualification"));
+
+        findings = LintEngine::defaultEngine().lint(
+            "#include <iostream>\nusing std::cout;\nint main() { cout << 1; }\n");
+        CHECK(!hasRule(findings, "std-qualification"));
+    }
+
+    void testFindingsAreSorted() {
+        std::vector<LintFinding> findings = LintEngine::defaultEngine().lint(
+            "int main() {\n    cout << 1;\n    cin >> x;\n}\n");
+        CHECK(findings.size() >= 2u);
+        for (size_t i = 1; i < findings.size(); ++i) {
+            CHECK(findings[i - 1].line < findings[i].line ||
+                  (findings[i - 1].line == findings[i].line &&
+                   findings[i - 1].column <= findings[i].column));
+        }
+    }
+
+    // A rule registered by the caller sees every token and its end call
+    class TokenCountRule : public LintRule {
+    private:
+        int tokens = 0;
+
+    public:
+        void onToken(const Token&, std::vector<LintFinding>&) override { tokens++; }
+        void onEnd(std::vector<LintFinding>& findings) override {
+            findings.emplace_back("token-count", std::to_string(tokens));
+        }
+    };
+
+    void testCustomRules() {
+        LintEngine engine;
+        engine.registerRule([]() { return std::make_unique<TokenCountRule>(); });
+        CHECK_EQ(engine.getRuleCount(), 1u);
+        for (int run = 0; run < 2; ++run) {
+            std::vector<LintFinding> findings = engine.lint("int x = 1; // not counted");
+            CHECK_EQ(findings.size(), 1u);
+            if (findings.size() == 1) {
+                // A fresh rule per run: the count does not carry over
+                CHECK_EQ(findings[0].message, "5");
+            }
+        }
+    }
+}
+
+int main() {
+    testDefaultRules();
+    testCommentsAndLiteralsDontTrigger();
+    testUsingDeclarationsSatisfyQualification();
+    testFindingsAreSorted();
+    testCustomRules();
+    return testExitCode();
+}
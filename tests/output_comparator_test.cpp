@@ -0,0 +1,120 @@
+// OutputComparator: the vectorized mismatch search against a byte-by-byte
+// reference, and the rules of every comparison mode.
+#include <string>
+#include "TestCheck.h"
+#include "utils/OutputComparator.h"
+
+namespace {
+    size_t scalarMismatch(const std::string& a, const std::string& b, bool foldCase) {
+        auto fold = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; };
+        size_t pos = 0;
+        while (pos < a.size() && (foldCase ? fold(a[pos]) == fold(b[pos]) : a[pos] == b[pos])) {
+            pos++;
+        }
+        return pos;
+    }
+
+    bool matches(const std::string& expected, const std::string& actual, ComparisonMode mode) {
+        return OutputComparator::matches(expected, actual, ComparisonOptions(mode));
+    }
+
+    void testFirstMismatchAgreesWithScalar() {
+        // Differences before, at and after 16-byte block boundaries
+        for (size_t length : {0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 100u, 4099u}) {
+            std::string a(length, 'x');
+            for (size_t i = 0; i < length; ++i) {
+                a[i] = static_cast<char>('a' + i % 26);
+            }
+            CHECK_EQ(OutputComparator::firstMismatch(a.data(), a.data(), length), length);
+            for (size_t at = 0; at < length; at += (length > 40 ? 13 : 1)) {
+                std::string b = a;
+                b[at] = '#';
+                CHECK_EQ(OutputComparator::firstMismatch(a.data(), b.data(), length), at);
+                CHECK_EQ(OutputComparator::firstMismatch(a.data(), b.data(), length),
+                         scalarMismatch(a, b, false));
+            }
+        }
+    }
+
+    void testFirstMismatchFoldsLettersOnly() {
+        std::string lower = "hello world, this line is longer than one block!";
+        std::string upper = "HELLO WORLD, THIS LINE IS LONGER THAN ONE BLOCK!";
+        CHECK_EQ(OutputComparator::firstMismatch(lower.data(), upper.data(), lower.size(), true),
+                 lower.size());
+        CHECK_EQ(OutputComparator::firstMismatch(lower.data(), upper.data(), lower.size(), false), 0u);
+
+        // Bytes 0x20 apart that are not letters must not be folded together
+        std::string punctuation = "@[\\]^_ 0123456789abcdef";
+        std::string shifted     = "`{|}~\x7f 0123456789abcdef";
+        for (size_t i = 0; i < 6; ++i) {
+            CHECK_EQ(OutputComparator::firstMismatch(punctuation.data() + i, shifted.data() + i,
+                                                     punctuation.size() - i, true), 0u);
+        }
+    }
+
+    void testExact() {
+        CHECK(matches("1 2\n", "1 2\n", ComparisonMode::EXACT));
+        CHECK(!matches("1 2\n", "1 2", ComparisonMode::EXACT));
+        CHECK(!matches("1 2\n", "1 2 \n", ComparisonMode::EXACT));
+    }
+
+    void testIgnoreTrailingWhitespace() {
+        ComparisonMode mode = ComparisonMode::IGNORE_TRAILING_WHITESPACE;
+        CHECK(matches("hello\nworld\n", "hello  \nworld\t\n\n\n", mode));
+        CHECK(matches("hello\nworld", "hello\nworld\n", mode));
+        CHECK(matches("a\r\nb\r\n", "a\nb\n", mode));
+        CHECK(!matches("hello\nworld\n", " hello\nworld\n", mode));
+        CHECK(!matches("hello\nworld\n", "hello world\n", mode));
+        CHECK(!matches("a\n\nb\n", "a\nb\n", mode));
+        CHECK(!matches("Hello\n", "hello\n", mode));
+    }
+
+    void testIgnoreAllWhitespace() {
+        ComparisonMode mode = ComparisonMode::IGNORE_ALL_WHITESPACE;
+        CHECK(matches("1 2 3\n", "123", mode));
+        CHECK(matches("a b\nc", " a\tbc \n", mode));
+        CHECK(!matches("1 2 3", "1 2 4", mode));
+    }
+
+    void testTokens() {
+        ComparisonMode mode = ComparisonMode::TOKENS;
+        CHECK(matches("1  2\n3\n", "1 2 3", mode));
+        CHECK(matches("", " \n\t", mode));
+        CHECK(!matches("12 3", "1 23", mode));
+        CHECK(!matches("1 2 3", "1 2", mode));
+    }
+
+    void testCaseInsensitive() {
+        ComparisonMode mode = ComparisonMode::CASE_INSENSITIVE;
+        CHECK(matches("Yes\nNO\n", "YES  \nno", mode));
+        CHECK(!matches("Yes\n", "Yet\n", mode));
+        CHECK(!matches("@\n", "`\n", mode));
+    }
+
+    void testNumericTolerance() {
+        ComparisonOptions loose(ComparisonMode::NUMERIC_TOLERANCE, 1e-3, 0.0);
+        CHECK(OutputComparator::matches("3.14159 answer\n", "3.1416   answer", loose));
+        CHECK(!OutputComparator::matches("3.14159\n", "3.15\n", loose));
+        CHECK(!OutputComparator::matches("3.14159 answer\n", "3.1416 Answer", loose));
+        CHECK(!OutputComparator::matches("1 2", "1 2 3", loose));
+
+        ComparisonOptions relative(ComparisonMode::NUMERIC_TOLERANCE, 0.0, 1e-6);
+        CHECK(OutputComparator::matches("1000000", "1000000.5", relative));
+        CHECK(!OutputComparator::matches("1", "1.5", relative));
+
+        ComparisonOptions strict(ComparisonMode::NUMERIC_TOLERANCE);
+        CHECK(!OutputComparator::matches("3.14159", "3.1416", strict));
+    }
+}
+
+int main() {
+    testFirstMismatchAgreesWithScalar();
+    testFirstMismatchFoldsLettersOnly();
+    testExact();
+    testIgnoreTrailingWhitespace();
+    testIgnoreAllWhitespace();
+    testTokens();
+    testCaseInsensitive();
+    testNumericTolerance();
+    return testExitCode();
+}
@@ -0,0 +1,130 @@
+// OutputDiff: unified-diff text, minimal (Myers) edit scripts, hunk grouping
+// and the bounds that keep pathological outputs cheap.
+#include <string>
+#include "TestCheck.h"
+#include "utils/OutputDiff.h"
+
+namespace {
+    std::string lines(int first, int last) {
+        std::string text;
+        for (int i = first; i <= last; ++i) {
+            text += std::to_string(i) + "\n";
+        }
+        return text;
+    }
+
+    size_t countLines(const std::string& diff, char marker) {
+        size_t count = 0;
+        size_t start = 0;
+        while (start < diff.size()) {
+            size_t end = diff.find('\n', start);
+            if (end == std::string::npos) {
+                end = diff.size();
+            }
+            std::string_view line(diff.data() + start, end - start);
+            if (!line.empty() && line[0] == marker && line.substr(0, 3) != "---" &&
+                line.substr(0, 3) != "+++") {
+                count++;
+            }
+            start = end + 1;
+        }
+        return count;
+    }
+
+    size_t countOccurrences(const std::string& text, const std::string& needle) {
+        size_t count = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+            count++;
+        }
+        return count;
+    }
+
+    void testSameLinesGiveNoDiff() {
+        CHECK_EQ(OutputDiff::unified("a\nb\n", "a\nb\n"), "");
+        CHECK_EQ(OutputDiff::unified("a\nb\n", "a  \nb\n\n\n"), "");
+        CHECK_EQ(OutputDiff::unified("", ""), "");
+    }
+
+    void testSingleChange() {
+        CHECK_EQ(OutputDiff::unified("a\nb\nc\n", "a\nx\nc\n"),
+                 "--- expected\n+++ actual\n@@ -1,3 +1,3 @@\n a\n-b\n+x\n c\n");
+    }
+
+    void testInsertionAndDeletion() {
+        std::string diff = OutputDiff::unified("1\n2\n3\n", "1\n2\n2.5\n3\n");
+        CHECK_EQ(countLines(diff, '+'), 1u);
+        CHECK_EQ(countLines(diff, '-'), 0u);
+        CHECK(diff.find("+2.5\n") != std::string::npos);
+
+        diff = OutputDiff::unified("1\n2\n3\n", "1\n3\n");
+        CHECK_EQ(countLines(diff, '+'), 0u);
+        CHECK_EQ(countLines(diff, '-'), 1u);
+        CHECK(diff.find("-2\n") != std::string::npos);
+
+        // Everything missing: an empty actual range names line 0
+        diff = OutputDiff::unified("only\n", "");
+        CHECK(diff.find("@@ -1 +0,0 @@\n-only\n") != std::string::npos);
+    }
+
+    void testEditScriptIsMinimal() {
+        // The example from Myers' paper: edit distance 5
+        std::string diff = OutputDiff::unified("a\nb\nc\na\nb\nb\na\n", "c\nb\na\nb\na\nc\n");
+        CHECK_EQ(countLines(diff, '+') + countLines(diff, '-'), 5u);
+        CHECK_EQ(countLines(diff, ' '), 4u);
+    }
+
+    void testDistantChangesGetSeparateHunks() {
+        std::string expected = lines(1, 30);
+        std::string actual = expected;
+        actual.replace(actual.find("2\n"), 2, "two\n");
+        actual.replace(actual.find("\n28\n") + 1, 3, "twenty-eight\n");
+
+        DiffOptions options;
+        options.contextLines = 1;
+        std::string diff = OutputDiff::unified(expected, actual, options);
+        CHECK_EQ(countOccurrences(diff, "@@ -"), 2u);
+        CHECK(diff.find("@@ -1,3 +1,3 @@\n 1\n-2\n+two\n 3\n") != std::string::npos);
+        CHECK(diff.find("@@ -27,3 +27,3 @@\n 27\n-28\n+twenty-eight\n 29\n") != std::string::npos);
+
+        // Close enough that the context would overlap: one hunk
+        options.contextLines = 20;
+        CHECK_EQ(countOccurrences(OutputDiff::unified(expected, actual, options), "@@ -"), 1u);
+    }
+
+    void testSearchDepthIsBounded() {
+        DiffOptions options;
+        options.maxEditDistance = 4;
+        std::string diff = OutputDiff::unified("x\n" + lines(1, 50), "x\n" + lines(101, 150), options);
+        CHECK(diff.find("@@ first difference at line 2;") != std::string::npos);
+        CHECK(diff.find("-1\n+101\n") != std::string::npos);
+
+        options = DiffOptions();
+        options.maxDiffLines = 10;
+        diff = OutputDiff::unified(lines(1, 20), lines(21, 40), options);
+        CHECK(diff.find("@@ first difference at line 1;") != std::string::npos);
+    }
+
+    void testOutputIsBounded() {
+        DiffOptions options;
+        options.maxOutputLines = 10;
+        std::string diff = OutputDiff::unified(lines(1, 40), lines(41, 80), options);
+        CHECK(diff.find("more diff lines") != std::string::npos);
+        CHECK(countLines(diff, '-') + countLines(diff, '+') <= 10u);
+
+        options = DiffOptions();
+        options.maxLineLength = 8;
+        diff = OutputDiff::unified("short\n", std::string(100, 'y') + "\n", options);
+        CHECK(diff.find("+yyyyyyyy...\n") != std::string::npos);
+    }
+}
+
+int main() {
+    testSameLinesGiveNoDiff();
+    testSingleChange();
+    testInsertionAndDeletion();
+    testEditScriptIsMinimal();
+    testDistantChangesGetSeparateHunks();
+    testSearchDepthIsBounded();
+    testOutputIsBounded();
+    return testExitCode();
+}
@@ -0,0 +1,95 @@
+// ReferenceOutputCache: outputs come from running the reference solution,
+// are computed once per key, persist to disk, and failures are not cached.
+// Needs a working g++.
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/ReferenceOutputCache.h"
+
+namespace {
+    const std::string doubler =
+        "#include <iostream>\n"
+        "int main() { long long x; std::cin >> x; std::cout << 2 * x << std::endl; }\n";
+
+    std::filesystem::path scratchDirectory(const std::string& name) {
+        std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                     (name + "_" + std::to_string(std::hash<std::thread::id>()(
+                                                                      std::this_thread::get_id())));
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        return path;
+    }
+
+    void testComputedOnce() {
+        ReferenceOutputCache cache;
+        std::vector<std::thread> threads;
+        std::vector<ReferenceOutput> results(4);
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&, i]() { results[i] = cache.getOutput(doubler, "21\n"); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (const ReferenceOutput& result : results) {
+            CHECK(result.success);
+            CHECK_EQ(result.output.str(), std::string("42\n"));
+        }
+        CHECK_EQ(cache.getMissCount(), 1u);
+        CHECK_EQ(cache.getHitCount(), 3u);
+
+        CHECK_EQ(cache.getOutput(doubler, "5\n").output.str(), std::string("10\n"));
+        CHECK_EQ(cache.getMissCount(), 2u);
+    }
+
+    void testPersistedAcrossInstances() {
+        std::filesystem::path directory = scratchDirectory("reference_cache_test");
+        {
+            ReferenceOutputCache cache(nullptr, directory.string());
+            CHECK_EQ(cache.getOutput(doubler, "7\n").output.str(), std::string("14\n"));
+        }
+        // A fresh cache maps the stored entry instead of running anything
+        ReferenceOutputCache restarted(nullptr, directory.string());
+        ReferenceOutput reloaded = restarted.getOutput(doubler, "7\n");
+        CHECK(!reloaded.output.filePath().empty());
+        std::filesystem::remove_all(directory);
+        CHECK(reloaded.success);
+        CHECK_EQ(reloaded.output.str(), std::string("14\n"));
+    }
+
+    void testFailuresAreRetried() {
+        std::filesystem::path directory = scratchDirectory("reference_retry_test");
+        std::filesystem::path marker = directory / "fail";
+        // Crashes while the marker file exists
+        std::string flaky =
+            "#include <cstdlib>\n#include <fstream>\n#include <iostream>\n"
+            "int main() { if (std::ifstream(\"" + marker.string() + "\")) std::abort();"
+            " std::cout << \"ok\\n\"; }\n";
+
+        ReferenceOutputCache cache;
+        std::ofstream(marker.string()) << "x";
+        CHECK(!cache.getOutput(flaky, "").success);
+        CHECK(!cache.getReferenceTime(flaky, "").success);
+
+        std::filesystem::remove(marker);
+        ReferenceOutput output = cache.getOutput(flaky, "");
+        CHECK(output.success);
+        CHECK_EQ(output.output.str(), std::string("ok\n"));
+        CHECK(cache.getReferenceTime(flaky, "").success);
+        std::filesystem::remove_all(directory);
+
+        // A solution that did not build is rebuilt on the next request
+        std::string broken = "int main() { return }\n";
+        CHECK(!cache.getOutput(broken, "").success);
+        CHECK_EQ(cache.getOutput(broken, "").errorMessage, std::string("Reference solution failed to compile"));
+    }
+}
+
+int main() {
+    testComputedOnce();
+    testPersistedAcrossInstances();
+    testFailuresAreRetried();
+    return testExitCode();
+}
@@ -0,0 +1,107 @@
+// ReportWriter: JSON and XML escaping, U+FFFD for invalid UTF-8, the
+// per-field output cap, and well-formed JUnit framing.
+#include <sstream>
+#include <string>
+#include "TestCheck.h"
+#include "utils/ReportWriter.h"
+
+namespace {
+    bool contains(const std::string& text, const std::string& part) {
+        return text.find(part) != std::string::npos;
+    }
+
+    TestSuite failingSuite(const std::string& errorMessage, const std::string& actual) {
+        TestSuite suite("suite <1>");
+        TestResult result("case \"a\"");
+        result.status = TestStatus::FAILED;
+        result.input = "1 2\n";
+        result.expectedOutput = "3\n";
+        result.actualOutput = actual;
+        result.actualOutputSize = actual.size();
+        result.errorMessage = errorMessage;
+        suite.results.push_back(result);
+        suite.failedCount = 1;
+        return suite;
+    }
+
+    void testJsonEscaping() {
+        std::ostringstream out;
+        {
+            JsonLinesReportWriter writer(out);
+            writer.writeSuite(failingSuite("bad\tline", "a\"b\\c\x01\xff"), "ex1");
+            writer.finish();
+        }
+        std::string text = out.str();
+        CHECK(contains(text, "\"name\":\"case \\\"a\\\"\""));
+        CHECK(contains(text, "\"group\":\"ex1\""));
+        CHECK(contains(text, "\"actual\":\"a\\\"b\\\\c\\u0001\xEF\xBF\xBD\""));
+        CHECK(contains(text, "\"error\":\"bad\\tline\""));
+        CHECK(contains(text, "{\"type\":\"suite\""));
+    }
+
+    void testXmlEscaping() {
+        std::ostringstream out;
+        {
+            JUnitReportWriter writer(out);
+            writer.writeSuite(failingSuite("x < y & 'z'", "<b>\x02"));
+        }
+        std::string text = out.str();
+        CHECK(contains(text, "<testsuite name=\"suite &lt;1&gt;\""));
+        CHECK(contains(text, "<testcase name=\"case &quot;a&quot;\""));
+        CHECK(contains(text, "<failure message=\"x &lt; y &amp; &apos;z&apos;\""));
+        CHECK(contains(text, "Actual:\n&lt;b&gt;\xEF\xBF\xBD</failure>"));
+    }
+
+    void testFieldsAreCapped() {
+        std::string longMessage(100, 'm');
+        std::string longOutput(100, 'o');
+
+        std::ostringstream xml;
+        {
+            JUnitReportWriter writer(xml, 64 * 1024, 10);
+            writer.writeSuite(failingSuite(longMessage, longOutput));
+        }
+        CHECK(contains(xml.str(), "<failure message=\"mmmmmmmmmm [truncated 90 bytes]\""));
+        CHECK(contains(xml.str(), "Actual:\noooooooooo [truncated 90 bytes]</failure>"));
+        CHECK(!contains(xml.str(), std::string(11, 'm')));
+
+        std::ostringstream json;
+        {
+            JsonLinesReportWriter writer(json, 64 * 1024, 10);
+            writer.writeSuite(failingSuite(longMessage, longOutput));
+            writer.finish();
+        }
+        CHECK(contains(json.str(), "\"error\":\"mmmmmmmmmm [truncated 90 bytes]\""));
+        CHECK(contains(json.str(), "\"actual\":\"oooooooooo [truncated 90 bytes]\""));
+    }
+
+    void testJUnitFraming() {
+        std::ostringstream out;
+        {
+            JUnitReportWriter writer(out, 16); // tiny buffer: flushed many times
+            writer.writeSuite(failingSuite("m", "o"));
+            writer.writeSuite(failingSuite("m", "o"));
+            writer.finish();
+            writer.finish(); // closing twice writes nothing more
+        }
+        std::string text = out.str();
+        CHECK_EQ(text.find("<?xml"), 0u);
+        CHECK_EQ(text.find("<testsuites>"), text.rfind("<testsuites>"));
+        CHECK_EQ(text.find("</testsuites>"), text.rfind("</testsuites>"));
+        CHECK_EQ(text.rfind("</testsuites>\n") + 14, text.size());
+
+        std::ostringstream empty;
+        {
+            JUnitReportWriter writer(empty);
+        }
+        CHECK_EQ(empty.str(), std::string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n</testsuites>\n"));
+    }
+}
+
+int main() {
+    testJsonEscaping();
+    testXmlEscaping();
+    testFieldsAreCapped();
+    testJUnitFraming();
+    return testExitCode();
+}
@@ -0,0 +1,131 @@
+// SourceLexer: token kinds and positions, and that comments and literals
+// never leak tokens.
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/SourceLexer.h"
+
+namespace {
+    std::vector<Token> lex(std::string_view source) {
+        std::vector<Token> tokens;
+        SourceLexer lexer(source);
+        Token token;
+        while (lexer.next(token)) {
+            tokens.push_back(token);
+        }
+        CHECK(token.kind == TokenKind::END);
+        return tokens;
+    }
+
+    std::vector<std::string> texts(std::string_view source) {
+        std::vector<std::string> result;
+        for (const Token& token : lex(source)) {
+            result.emplace_back(token.text);
+        }
+        return result;
+    }
+
+    void testBasicTokens() {
+        std::vector<Token> tokens = lex("int x = 42;");
+        CHECK_EQ(tokens.size(), 5u);
+        if (tokens.size() == 5) {
+            CHECK(tokens[0].kind == TokenKind::IDENTIFIER && tokens[0].text == "int");
+            CHECK(tokens[1].kind == TokenKind::IDENTIFIER && tokens[1].text == "x");
+            CHECK(tokens[2].kind == TokenKind::PUNCTUATOR && tokens[2].text == "=");
+            CHECK(tokens[3].kind == TokenKind::NUMBER && tokens[3].text == "42");
+            CHECK(tokens[4].kind == TokenKind::PUNCTUATOR && tokens[4].text == ";");
+        }
+    }
+
+    void testPositions() {
+        std::vector<Token> tokens = lex("int main() {\n    return 0;\n}\n");
+        CHECK_EQ(tokens.size(), 9u);
+        if (tokens.size() == 9) {
+            CHECK_EQ(tokens[0].line, 1);
+            CHECK_EQ(tokens[0].column, 1);
+            CHECK_EQ(tokens[5].text, "return");
+            CHECK_EQ(tokens[5].line, 2);
+            CHECK_EQ(tokens[5].column, 5);
+            CHECK_EQ(tokens[8].line, 3);
+            CHECK_EQ(tokens[8].column, 1);
+        }
+    }
+
+    void testCommentsAreSkipped() {
+        CHECK(texts("a // for (;;)\nb /* goto\n while */ c") ==
+              (std::vector<std::string>{"a", "b", "c"}));
+        std::vector<Token> tokens = lex("/* one\ntwo */ x");
+        CHECK_EQ(tokens.size(), 1u);
+        if (!tokens.empty()) {
+            CHECK_EQ(tokens[0].line, 2);
+        }
+    }
+
+    void testLiteralsStayWhole() {
+        std::vector<Token> tokens = lex("s = \"a // not \\\" a comment\"; c = '\\'';");
+        CHECK_EQ(tokens.size(), 8u);
+        if (tokens.size() == 8) {
+            CHECK(tokens[2].kind == TokenKind::STRING_LITERAL);
+            CHECK_EQ(tokens[2].text, "\"a // not \\\" a comment\"");
+            CHECK(tokens[6].kind == TokenKind::CHAR_LITERAL);
+            CHECK_EQ(tokens[6].text, "'\\''");
+        }
+
+        tokens = lex("auto r = R\"x(raw )\" still raw)x\"; u8\"utf\" L'w'");
+        CHECK_EQ(tokens.size(), 7u);
+        if (tokens.size() == 7) {
+            CHECK(tokens[3].kind == TokenKind::STRING_LITERAL);
+            CHECK_EQ(tokens[3].text, "R\"x(raw )\" still raw)x\"");
+            CHECK(tokens[5].kind == TokenKind::STRING_LITERAL && tokens[5].text == "u8\"utf\"");
+            CHECK(tokens[6].kind == TokenKind::CHAR_LITERAL && tokens[6].text == "L'w'");
+        }
+    }
+
+    void testNumbers() {
+        CHECK(texts("1e-5 0x1F .5 3.14f 1'000") ==
+              (std::vector<std::string>{"1e-5", "0x1F", ".5", "3.14f", "1'000"}));
+    }
+
+    void testPunctuatorsAreMaximal() {
+        CHECK(texts("a->b::c <<= d ++e") ==
+              (std::vector<std::string>{"a", "->", "b", "::", "c", "<<=", "d", "++", "e"}));
+    }
+
+    void testPreprocessorDirectives() {
+        std::vector<Token> tokens = lex("#include <map>\n  #define N 10\nint a = N; // #x\n");
+        CHECK_EQ(tokens.size(), 7u);
+        if (tokens.size() == 7) {
+            CHECK(tokens[0].kind == TokenKind::PREPROCESSOR);
+            CHECK_EQ(tokens[0].text, "#include <map>");
+            CHECK(tokens[1].kind == TokenKind::PREPROCESSOR);
+            CHECK_EQ(tokens[1].line, 2);
+            CHECK_EQ(tokens[1].column, 3);
+            CHECK(tokens[2].kind == TokenKind::IDENTIFIER);
+        }
+        // A '#' that doesn't start a line is just punctuation
+        std::vector<Token> inline_ = lex("a # b");
+        CHECK_EQ(inline_.size(), 3u);
+        if (inline_.size() == 3) {
+            CHECK(inline_[1].kind == TokenKind::PUNCTUATOR);
+        }
+    }
+
+    void testUnterminatedInputEnds() {
+        CHECK_EQ(lex("\"never closed").size(), 1u);
+        CHECK_EQ(lex("/* never closed").size(), 0u);
+        CHECK_EQ(lex("").size(), 0u);
+    }
+}
+
+int main() {
+    testBasicTokens();
+    testPositions();
+    testCommentsAreSkipped();
+    testLiteralsStayWhole();
+    testNumbers();
+    testPunctuatorsAreMaximal();
+    testPreprocessorDirectives();
+    testUnterminatedInputEnds();
+    return testExitCode();
+}
@@ -0,0 +1,88 @@
+// WorkStealingPool: every task runs exactly once, tasks spawned by tasks are
+// waited for, idle workers steal, and the pool is reusable after wait().
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "TestCheck.h"
+#include "utils/WorkStealingPool.h"
+
+namespace {
+    void testEveryTaskRunsOnce() {
+        WorkStealingPool pool(4);
+        CHECK_EQ(pool.size(), 4u);
+
+        std::vector<std::atomic<int>> runs(1000);
+        for (size_t i = 0; i < runs.size(); ++i) {
+            pool.submit([&runs, i]() { runs[i].fetch_add(1); });
+        }
+        pool.wait();
+        for (const std::atomic<int>& count : runs) {
+            CHECK_EQ(count.load(), 1);
+        }
+    }
+
+    void testWaitCoversSpawnedTasks() {
+        WorkStealingPool pool(3);
+        std::atomic<int> leaves{0};
+        // Three levels of fan-out, all submitted from inside the pool
+        for (int i = 0; i < 4; ++i) {
+            pool.submit([&]() {
+                for (int j = 0; j < 8; ++j) {
+                    pool.submit([&]() {
+                        for (int k = 0; k < 8; ++k) {
+                            pool.submit([&]() { leaves.fetch_add(1); });
+                        }
+                    });
+                }
+            });
+        }
+        pool.wait();
+        CHECK_EQ(leaves.load(), 4 * 8 * 8);
+    }
+
+    void testIdleWorkersSteal() {
+        WorkStealingPool pool(4);
+        std::atomic<int> done{0};
+        // One task spawns slow children onto its own deque; the others can
+        // only get them by stealing
+        pool.submit([&]() {
+            for (int i = 0; i < 16; ++i) {
+                pool.submit([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    done.fetch_add(1);
+                });
+            }
+        });
+        pool.wait();
+        CHECK_EQ(done.load(), 16);
+        CHECK(pool.getStealCount() > 0);
+    }
+
+    void testReusableAfterWait() {
+        WorkStealingPool pool(2);
+        std::atomic<int> total{0};
+        for (int round = 1; round <= 3; ++round) {
+            for (int i = 0; i < 10; ++i) {
+                pool.submit([&]() { total.fetch_add(1); });
+            }
+            pool.wait();
+            CHECK_EQ(total.load(), round * 10);
+        }
+        pool.wait(); // nothing pending: returns at once
+    }
+
+    void testDefaultSize() {
+        WorkStealingPool pool;
+        CHECK(pool.size() >= 1u);
+    }
+}
+
+int main() {
+    testEveryTaskRunsOnce();
+    testWaitCoversSpawnedTasks();
+    testIdleWorkersSteal();
+    testReusableAfterWait();
+    testDefaultSize();
+    return testExitCode();
+}